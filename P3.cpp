@@ -1,18 +1,248 @@
 #include <iostream>
 #include <cstdlib>
 #include <cstring>
+#include <fstream>
+#include <algorithm>
+#include <vector>
 
 #include "lilc_compiler.hpp"
+#include "lilc_lsp.hpp"
+#include "lilc_diff.hpp"
+#include "lilc_check.hpp"
+#include "lilc_profile.hpp"
+#include "lilc_selfprofile.hpp"
+#include "lilc_bench.hpp"
+#include "lilc_generate.hpp"
+#include "lilc_stress.hpp"
+#include "lilc_tokens.hpp"
+#include "lilc_lazy.hpp"
+#include "lilc_shard.hpp"
+#include "lilc_startup.hpp"
+#include "lilc_engine.hpp"
+#include "lilc_superopt.hpp"
+
+static void
+usage()
+{
+	std::cout << "Usage: P3 [options] <infile> <outfile>\n"
+	<< "       P3 [options] --shards=N <infile> <outfile>...\n"
+	<< "       P3 --lsp\n"
+	<< "       P3 --lsp-bench <infile>\n"
+	<< "       P3 --diff <oldfile> <newfile>\n"
+	<< "       P3 --roundtrip <infile>...\n"
+	<< "       P3 --unparse-bench <infile>\n"
+	<< "       P3 --token-bench <infile>\n"
+	<< "       P3 --lazy-bench <infile>\n"
+	<< "       P3 [--shards=N] --shard-bench <infile>...\n"
+	<< "       P3 --startup-bench [program...]\n"
+	<< "       P3 [options] --run <infile>\n"
+	<< "       P3 --run-bench\n"
+	<< "       P3 [--superopt-cost=N] --superopt-search=<table>\n"
+	<< "       P3 --superopt-report=<table> <infile>...\n"
+	<< "       P3 --superopt-check=<table>\n"
+	<< "       P3 [bench options] --bench|--bench-update <baseline.json>\n"
+	<< "       P3 [bench options] --generate <outfile>\n"
+	<< "       P3 [--stress-scale=PCT] --stress [shape]\n"
+	<< "Options:\n"
+	<< "  --diagnostics=text|json  format of warnings and errors\n"
+	<< "  --max-diagnostics=N      cap on reported diagnostics\n"
+	<< "  --export=jsonl|binary    write the AST instead of unparsing it\n"
+	<< "  --token-array            lex the whole input before parsing it\n"
+	<< "  --minify                 unparse in as few bytes as possible\n"
+	<< "  --rename-locals          with --minify, shorten local names\n"
+	<< "  --mem-report             write the AST's memory use by node kind\n"
+	<< "  --profile=FILE           count scanner rules, reductions and token\n"
+	<< "                           sizes, written to FILE at exit\n"
+	<< "  --self-profile=FILE      sample P3's own call stacks, written to\n"
+	<< "                           FILE and FILE.input as folded stacks\n"
+	<< "  --self-profile-rate=HZ   samples per second of CPU time (1000)\n"
+	<< "  --shards=N               unparse each <infile> <outfile> pair in N\n"
+	<< "                           worker processes (0: one per core)\n"
+	<< "  --superopt=TABLE         rewrite expressions to the cheaper ones\n"
+	<< "                           of TABLE as they are parsed\n"
+	<< "  --superopt-cost=N        operations of the expressions searched\n"
+	<< "                           (default 2)\n"
+	<< "Bench options:\n"
+	<< "  --bench-seed=N           seed of the generated input\n"
+	<< "  --bench-scale=N          functions in the generated input\n"
+	<< "  --bench-runs=N           timed runs per metric\n"
+	<< "  --bench-threshold=PCT    allowed slowdown before failing\n"
+	<< "Stress shapes: long-line, nested-if, assign-chain, long-formals,\n"
+	<< "illegal-chars; --stress-scale sets their size as a percentage of\n"
+	<< "the full 100 MB line, 10^6 levels, 10^6 formals and 1 GB.\n"
+	<< "gzip and zstd compressed input is detected and decompressed;\n"
+	<< "an outfile named *.gz or *.zst is written compressed."
+	<< std::endl;
+}
 
 int 
 main( const int argc, const char **argv )
 {
-   if (argc != 3){
-	std::cout << "Usage: P3 <infile> <outfile>" << std::endl;
+   LILC::LilC_Compiler compiler;
+   bool exporting = false;
+   bool minifying = false;
+   bool renameLocals = false;
+   bool memReport = false;
+   LILC::ASTExporter::Format exportFormat = LILC::ASTExporter::JSON_LINES;
+   LILC::BenchSettings bench;
+   LILC::StressSettings stress;
+   LILC::ShardSettings shard;
+   LILC::SuperoptSettings superopt;
+   LILC::RewriteTable rewrites;
+   bool sharding = false;
+   int arg = 1;
+   for (; arg < argc && strncmp(argv[arg], "--", 2) == 0; arg++){
+	const char * opt = argv[arg];
+	if (strcmp(opt, "--lsp") == 0){
+		LILC::LanguageServer server;
+		return server.run(std::cin, std::cout);
+	} else if (strcmp(opt, "--lsp-bench") == 0 && arg + 1 < argc){
+		return LILC::lspBenchmark(argv[arg + 1], std::cout);
+	} else if (strcmp(opt, "--roundtrip") == 0 && arg + 1 < argc){
+		return LILC::roundTripCheck(argv + arg + 1, argc - arg - 1,
+			std::cout) == 0 ? 0 : 1;
+	} else if (strcmp(opt, "--unparse-bench") == 0 && arg + 1 < argc){
+		return LILC::unparseBenchmark(argv[arg + 1], std::cout);
+	} else if (strcmp(opt, "--token-bench") == 0 && arg + 1 < argc){
+		return LILC::tokenArrayBenchmark(argv[arg + 1], std::cout);
+	} else if (strcmp(opt, "--lazy-bench") == 0 && arg + 1 < argc){
+		return LILC::lazyBenchmark(argv[arg + 1], std::cout);
+	} else if (strcmp(opt, "--shard-bench") == 0 && arg + 1 < argc){
+		return LILC::shardBenchmark(argv + arg + 1, argc - arg - 1,
+			shard, std::cout);
+	} else if (strcmp(opt, "--startup-bench") == 0){
+		return LILC::startupBenchmark(argv + arg + 1, argc - arg - 1,
+			std::cout);
+	} else if (strcmp(opt, "--run") == 0 && arg + 2 == argc){
+		return LILC::runProgram(compiler, argv[arg + 1], std::cin,
+			std::cout);
+	} else if (strcmp(opt, "--run-bench") == 0){
+		return LILC::engineBenchmark(std::cout);
+	} else if (strncmp(opt, "--superopt=", 11) == 0){
+		if (!rewrites.load(opt + 11, std::cerr)){
+			return 1;
+		}
+		compiler.setRewriteTable(&rewrites);
+	} else if (strncmp(opt, "--superopt-cost=", 16) == 0){
+		superopt.maxOperations = atoi(opt + 16);
+	} else if (strncmp(opt, "--superopt-search=", 18) == 0){
+		return LILC::superoptimizerSearch(superopt, opt + 18, std::cout);
+	} else if (strncmp(opt, "--superopt-check=", 17) == 0){
+		return LILC::superoptimizerCheck(opt + 17, std::cout);
+	} else if (strncmp(opt, "--superopt-report=", 18) == 0){
+		return LILC::superoptimizerReport(opt + 18, argv + arg + 1,
+			argc - arg - 1, std::cout);
+	} else if (strncmp(opt, "--shards=", 9) == 0){
+		sharding = true;
+		shard.workers = atoi(opt + 9);
+	} else if ((strcmp(opt, "--bench") == 0
+		|| strcmp(opt, "--bench-update") == 0) && arg + 1 < argc){
+		return LILC::benchGate(argv[arg + 1],
+			strcmp(opt, "--bench-update") == 0, bench, std::cout);
+	} else if (strcmp(opt, "--generate") == 0 && arg + 1 < argc){
+		// The bench input, or another with --bench-seed and --bench-scale
+		std::ofstream out(argv[arg + 1]);
+		out << LILC::generateProgram(bench.seed, bench.scale);
+		return out.good() ? 0 : 1;
+	} else if (strncmp(opt, "--bench-seed=", 13) == 0){
+		bench.seed = strtoull(opt + 13, nullptr, 10);
+	} else if (strncmp(opt, "--bench-scale=", 14) == 0){
+		bench.scale = strtoul(opt + 14, nullptr, 10);
+	} else if (strncmp(opt, "--bench-runs=", 13) == 0){
+		bench.runs = std::max(1, atoi(opt + 13));
+	} else if (strncmp(opt, "--bench-threshold=", 18) == 0){
+		bench.threshold = atof(opt + 18) / 100;
+	} else if (strcmp(opt, "--stress") == 0 && arg + 2 >= argc){
+		stress.only = arg + 1 < argc ? argv[arg + 1] : nullptr;
+		return LILC::stressHarness(stress, std::cout) == 0 ? 0 : 1;
+	} else if (strncmp(opt, "--stress-scale=", 15) == 0){
+		stress.scale = atof(opt + 15) / 100;
+	} else if (strcmp(opt, "--diff") == 0 && arg + 2 < argc){
+		// Exit status as diff(1): 0 same, 1 different, 2 trouble
+		LILC::LilC_Compiler other;
+		if (!compiler.buildAST(argv[arg + 1])
+			|| !other.buildAST(argv[arg + 2])){
+			return 2;
+		}
+		std::vector<LILC::ASTChange> changes = LILC::diffPrograms(
+			compiler.getASTRoot(), other.getASTRoot());
+		LILC::printChanges(changes, std::cout);
+		return changes.empty() ? 0 : 1;
+	} else if (strcmp(opt, "--diagnostics=json") == 0){
+		compiler.diagnostics().setFormat(LILC::Diagnostics::JSON);
+		shard.format = LILC::Diagnostics::JSON;
+	} else if (strcmp(opt, "--diagnostics=text") == 0){
+		compiler.diagnostics().setFormat(LILC::Diagnostics::TEXT);
+		shard.format = LILC::Diagnostics::TEXT;
+	} else if (strcmp(opt, "--export=jsonl") == 0){
+		exporting = true;
+		exportFormat = LILC::ASTExporter::JSON_LINES;
+	} else if (strcmp(opt, "--export=binary") == 0){
+		exporting = true;
+		exportFormat = LILC::ASTExporter::BINARY;
+	} else if (strcmp(opt, "--token-array") == 0){
+		compiler.setTokenArrayMode(true);
+		shard.tokenArray = true;
+	} else if (strcmp(opt, "--minify") == 0){
+		minifying = true;
+	} else if (strcmp(opt, "--rename-locals") == 0){
+		renameLocals = true;
+	} else if (strcmp(opt, "--mem-report") == 0){
+		memReport = true;
+	} else if (strncmp(opt, "--profile=", 10) == 0 && opt[10] != '\0'){
+		LILC::Profile::enable(opt + 10);
+	} else if (strncmp(opt, "--self-profile=", 15) == 0
+		&& opt[15] != '\0'){
+		LILC::SelfProfiler::enable(opt + 15);
+	} else if (strncmp(opt, "--self-profile-rate=", 20) == 0){
+		LILC::SelfProfiler::setRate(atoi(opt + 20));
+	} else if (strncmp(opt, "--max-diagnostics=", 18) == 0){
+		compiler.diagnostics().setMaxEntries(strtoul(opt + 18, nullptr, 10));
+		shard.maxDiagnostics = strtoul(opt + 18, nullptr, 10);
+	} else {
+		usage();
+		return 1;
+	}
+   }
+
+   if (renameLocals && !minifying){
+	usage();
 	return 1;
    }
 
-   LILC::LilC_Compiler compiler;
-   compiler.parse( argv[1], argv[2] );
+   if (sharding){
+	int files = (argc - arg) / 2;
+	if (files == 0 || (argc - arg) % 2 != 0
+		|| exporting || minifying || memReport){
+		usage();
+		return 1;
+	}
+	std::vector<const char *> inputs, outputs;
+	for (int i = 0; i < files; i++){
+		inputs.push_back(argv[arg + 2 * i]);
+		outputs.push_back(argv[arg + 2 * i + 1]);
+	}
+	return LILC::shardedCompile(inputs.data(), outputs.data(), files,
+		shard, std::cerr) == 0 ? 0 : 1;
+   }
+
+   if (argc - arg != 2){
+	usage();
+	return 1;
+   }
+
+   if (exporting){
+	compiler.exportAST( argv[arg], argv[arg + 1], exportFormat );
+	return 0;
+   }
+   if (memReport){
+	compiler.memReport( argv[arg], argv[arg + 1] );
+	return 0;
+   }
+   if (minifying){
+	compiler.minify( argv[arg], argv[arg + 1], renameLocals );
+	return 0;
+   }
+   compiler.parse( argv[arg], argv[arg + 1] );
    return 0;
 }
@@ -1,2 +1,98 @@
 // Use this file if you'd like to implement any auxilary functions in your 
 // AST nodes
+
+#include "ast.hpp"
+
+namespace LILC{
+
+const char * nodeKindName(NodeKind kind){
+	static const char * const names[] = {
+		"ProgramNode", "DeclListNode", "ExpListNode", "FormalsListNode",
+		"StmtListNode", "FnBodyNode",
+		"VarDeclNode", "FnDeclNode", "FormalDeclNode", "StructDeclNode",
+		"IntNode", "BoolNode", "VoidNode", "StructNode",
+		"AssignStmtNode", "PostIncStmtNode", "PostDecStmtNode",
+		"ReadStmtNode", "WriteStmtNode", "IfStmtNode", "IfElseStmtNode",
+		"WhileStmtNode", "CallStmtNode", "ReturnStmtNode",
+		"IntLitNode", "StrLitNode", "TrueNode", "FalseNode", "IdNode",
+		"DotAccessNode", "AssignNode", "CallExpNode",
+		"UnaryMinusNode", "NotNode",
+		"PlusNode", "MinusNode", "TimesNode", "DivideNode", "AndNode", "OrNode",
+		"EqualsNode", "NotEqualsNode", "LessNode", "GreaterNode", "LessEqNode",
+		"GreaterEqNode"
+	};
+	static_assert(sizeof(names) / sizeof(names[0]) == NODE_KIND_COUNT,
+		"nodeKindName out of sync with NodeKind");
+	return names[kind];
+}
+
+void ASTNode::modified(){
+	for (ASTNode * node = this; node != nullptr; node = node->myParent){
+		node->rehash();
+		if (node->kind() == FN_DECL_NODE){
+			static_cast<FnDeclNode *>(node)->forgetRendered();
+		} else if (node->kind() == STRUCT_DECL_NODE){
+			static_cast<StructDeclNode *>(node)->forgetRendered();
+		}
+	}
+}
+
+int precedence(NodeKind kind){
+	switch (kind){
+		case ASSIGN_NODE: return PREC_ASSIGN;
+		case OR_NODE: return PREC_OR;
+		case AND_NODE: return PREC_AND;
+		case EQUALS_NODE: case NOT_EQUALS_NODE: case LESS_NODE:
+		case GREATER_NODE: case LESS_EQ_NODE: case GREATER_EQ_NODE:
+			return PREC_COMPARE;
+		case PLUS_NODE: case MINUS_NODE: return PREC_ADD;
+		case TIMES_NODE: case DIVIDE_NODE: return PREC_MUL;
+		case NOT_NODE: return PREC_NOT;
+		case UNARY_MINUS_NODE: return PREC_NEGATE;
+		default: return PREC_TERM;
+	}
+}
+
+const char * operatorText(NodeKind kind){
+	switch (kind){
+		case ASSIGN_NODE: return "=";
+		case OR_NODE: return "||";
+		case AND_NODE: return "&&";
+		case EQUALS_NODE: return "==";
+		case NOT_EQUALS_NODE: return "!=";
+		case LESS_NODE: return "<";
+		case GREATER_NODE: return ">";
+		case LESS_EQ_NODE: return "<=";
+		case GREATER_EQ_NODE: return ">=";
+		case PLUS_NODE: return "+";
+		case MINUS_NODE: return "-";
+		case TIMES_NODE: return "*";
+		case DIVIDE_NODE: return "/";
+		case NOT_NODE: return "!";
+		case UNARY_MINUS_NODE: return "-";
+		default: return "";
+	}
+}
+
+bool needsParens(NodeKind parent, NodeKind child, bool rightOperand){
+	int outer = precedence(parent);
+	int inner = precedence(child);
+	switch (parent){
+		case UNARY_MINUS_NODE:
+			return inner < PREC_TERM;
+		case NOT_NODE:
+			return inner < PREC_NOT;
+		case ASSIGN_NODE:
+			// right associative, and the left side is always a location
+			return false;
+		default:
+			break;
+	}
+	if (outer == PREC_COMPARE || rightOperand){
+		// comparisons do not associate; the others associate left
+		return inner <= outer;
+	}
+	return inner < outer;
+}
+
+} //End namespace LIL' C
@@ -3,6 +3,10 @@
 
 #include <ostream>
 #include <list>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <initializer_list>
 #include "symbols.hpp"
 
 //Here is a suggestion for all the different kinds of AST nodes
@@ -103,6 +107,15 @@
 namespace LILC{
 
 class SymSymbol;
+class ASTExporter;
+class Minifier;
+class ASTArena;
+class MemoryReport;
+class ClosureCompiler;
+struct ValueType;
+struct Typed;
+struct Place;
+struct StmtCode;
 class DeclListNode;
 class DeclNode;
 class TypeNode;
@@ -115,148 +128,404 @@ class AssignNode;
 class ExpNode;
 class CallExpNode;
 
-class ASTNode{
-public:
-	virtual void unparse(std::ostream& out, int indent) = 0;
-	void doIndent(std::ostream& out, int indent){
-		for (int k = 0 ; k < indent; k++){ out << " "; }
+// Concrete node kinds, used to seed the structural hashes
+enum NodeKind {
+	PROGRAM_NODE, DECL_LIST_NODE, EXP_LIST_NODE, FORMALS_LIST_NODE,
+	STMT_LIST_NODE, FN_BODY_NODE,
+	VAR_DECL_NODE, FN_DECL_NODE, FORMAL_DECL_NODE, STRUCT_DECL_NODE,
+	INT_NODE, BOOL_NODE, VOID_NODE, STRUCT_NODE,
+	ASSIGN_STMT_NODE, POST_INC_STMT_NODE, POST_DEC_STMT_NODE,
+	READ_STMT_NODE, WRITE_STMT_NODE, IF_STMT_NODE, IF_ELSE_STMT_NODE,
+	WHILE_STMT_NODE, CALL_STMT_NODE, RETURN_STMT_NODE,
+	INT_LIT_NODE, STR_LIT_NODE, TRUE_NODE, FALSE_NODE, ID_NODE,
+	DOT_ACCESS_NODE, ASSIGN_NODE, CALL_EXP_NODE,
+	UNARY_MINUS_NODE, NOT_NODE,
+	PLUS_NODE, MINUS_NODE, TIMES_NODE, DIVIDE_NODE, AND_NODE, OR_NODE,
+	EQUALS_NODE, NOT_EQUALS_NODE, LESS_NODE, GREATER_NODE, LESS_EQ_NODE,
+	GREATER_EQ_NODE
+};
+
+const int NODE_KIND_COUNT = GREATER_EQ_NODE + 1;
+
+// Class name of a node kind, e.g. "PlusNode" (defined in ast.cpp)
+const char * nodeKindName(NodeKind kind);
+
+// Binding strength of expression kinds, following the precedence
+// declarations in lilc.yy; higher binds tighter. Unary minus only takes
+// a term as its operand.
+enum Precedence {
+	PREC_ASSIGN = 1, PREC_OR, PREC_AND, PREC_COMPARE, PREC_ADD, PREC_MUL,
+	PREC_NOT, PREC_NEGATE, PREC_TERM
+};
+int precedence(NodeKind kind);
+
+// Source spelling of an operator kind, e.g. "<=" for LESS_EQ_NODE
+const char * operatorText(NodeKind kind);
+
+// Whether an operand of kind child under an operator of kind parent must
+// be parenthesized for the text to parse back into the same tree.
+bool needsParens(NodeKind parent, NodeKind child, bool rightOperand);
+
+inline uint64_t hashCombine(uint64_t seed, uint64_t value){
+	return seed ^ (value + 0x9e3779b97f4a7c15ULL + (seed << 12) + (seed >> 4));
+}
+
+inline uint64_t hashString(const std::string& str){
+	uint64_t h = 0xcbf29ce484222325ULL; // FNV-1a
+	for (unsigned char c : str){
+		h = (h ^ c) * 0x100000001b3ULL;
 	}
+	return h;
+}
+
+// The bytes of source a node was parsed from, packed into 8 bytes per
+// node; offsets and lengths past 4 GiB saturate. Lines and columns are
+// only worked out when needed, from the source's LineIndex.
+struct Span{
+	uint32_t offset = 0;
+	uint32_t length = 0;
 };
 
-class ProgramNode : public ASTNode{
+inline Span makeSpan(size_t offset, size_t length){
+	Span span;
+	span.offset = offset > UINT32_MAX ? UINT32_MAX : (uint32_t)offset;
+	span.length = length > UINT32_MAX - span.offset
+		? UINT32_MAX - span.offset : (uint32_t)length;
+	return span;
+}
+
+class ASTNode{
 public:
-	ProgramNode(DeclListNode * L) : ASTNode(){
-		myDeclList = L;
-	}
+	virtual ~ASTNode(){ }
+	// Writes the node back as source text. render does the same into
+	// any sink of lilc_unparse.hpp, dispatching on kind(); the concrete
+	// classes each define their own render (in unparse.cpp).
 	void unparse(std::ostream& out, int indent);
-private:
-	DeclListNode * myDeclList;
+	template <typename Sink> void render(Sink& out, int indent);
+	virtual void exportTo(ASTExporter& exp, size_t parent) = 0;
+	virtual void minify(Minifier& out) = 0;
+	virtual void measure(MemoryReport& report) = 0;
+	virtual NodeKind kind() const = 0;
+	// Deep copy of the subtree rooted here, every node allocated from
+	// arena in one pre-order pass. The copy keeps this subtree's hash.
+	virtual ASTNode * clone(ASTArena& arena) = 0;
+	// Deletes the subtree rooted here, which must have been allocated
+	// with new as the parser does (a clone belongs to its arena). The
+	// tokens behind literals are not the tree's and are left alone.
+	// Iterative, so it frees trees of any depth the parser accepts.
+	void deleteTree();
+	// Appends the node's children to out, in source order.
+	virtual void children(std::vector<ASTNode *>& out){ }
+	// Structural equality. Subtrees with different hashes or kinds are
+	// rejected without a walk; otherwise both are walked to rule out a
+	// hash collision, stopping at the first attribute or child that
+	// differs.
+	bool equals(ASTNode * other){
+		return other == this || (other != nullptr
+			&& other->myHash == myHash && other->kind() == kind()
+			&& sameAs(other));
+	}
+	static bool equal(ASTNode * a, ASTNode * b){
+		return a == nullptr ? b == nullptr : a->equals(b);
+	}
+	// Compares attributes and children; other has this node's kind.
+	virtual bool sameAs(ASTNode * other) = 0;
+	template <typename Sink>
+	void doIndent(Sink& out, int indent){
+		for (int k = 0 ; k < indent; k++){ out << " "; }
+	}
+	// Merkle-style hash of the subtree rooted here. Every constructor
+	// folds its kind, attributes and the hashes of its (already built)
+	// children, so equal subtrees hash equal and comparing two subtrees
+	// is a single word compare.
+	uint64_t hash() const { return myHash; }
+	// Source bytes covered by the production that built this node, from
+	// its first token to its last; set by the parser.
+	Span span() const { return mySpan; }
+	void setSpan(Span span){ mySpan = span; }
+	// The node that last took this one as a child; null for a root. An
+	// IncrementalDocument's DeclNodes have the list of its current
+	// program().
+	ASTNode * parent() const { return myParent; }
+	// Recomputes hash() from the node's attributes and its children's
+	// current hashes, making this node the parent of each child again.
+	// Leaves cannot change, so theirs does nothing.
+	virtual void rehash(){ }
+	// To be called after changing this node in place, e.g. through
+	// getStmts(): rehashes it and every node enclosing it, and drops the
+	// text cached by unparseCached() for every enclosing declaration.
+	void modified();
+protected:
+	// Both also make this node the parent of each kid.
+	uint64_t hashKids(NodeKind kind, std::initializer_list<ASTNode *> kids){
+		uint64_t h = hashCombine(0, kind);
+		for (ASTNode * kid : kids){
+			h = hashCombine(h, kid == nullptr ? 0 : adopt(kid)->hash());
+		}
+		return h;
+	}
+	template <typename T>
+	uint64_t hashList(NodeKind kind, const std::list<T *>& kids){
+		uint64_t h = hashCombine(0, kind);
+		for (T * kid : kids){ h = hashCombine(h, adopt(kid)->hash()); }
+		return hashCombine(h, kids.size());
+	}
+	template <typename T>
+	T * adopt(T * kid){
+		if (kid != nullptr){ static_cast<ASTNode *>(kid)->myParent = this; }
+		return kid;
+	}
+	uint64_t myHash = 0;
+	Span mySpan;
+	ASTNode * myParent = nullptr;
+};
 
+// Text that a declaration unparsed to at one indent, kept by
+// unparseCached(); an indent below 0 marks it dirty.
+struct RenderedText{
+	int indent = -1;
+	std::string text;
 };
 
 class ExpNode : public ASTNode {
 public:
 	ExpNode() : ASTNode() {
 	}
-	virtual void unparse(std::ostream& out, int indent) = 0;
+	virtual void exportTo(ASTExporter& exp, size_t parent) = 0;
+	virtual void minify(Minifier& out) = 0;
+	virtual void measure(MemoryReport& report) = 0;
+	// Closures for the engine, see lilc_engine.hpp (in compile.cpp).
+	// locate resolves a location (an id or a field access) to its slot.
+	virtual Typed compile(ClosureCompiler& cc) = 0;
+	virtual Place locate(ClosureCompiler& cc);
+	virtual ExpNode * clone(ASTArena& arena) = 0;
 };
 
-class ExpListNode : public ASTNode {
+class IdNode : public ExpNode{
 public:
-	ExpListNode(std::list<ExpNode *> * expList) : ASTNode() {
-		myExpList = *expList;
+	IdNode(IDToken * token) : ExpNode(){
+		myStrVal = token->value();
+		mySpan = makeSpan(token->offset, myStrVal.size());
+		myHash = hashCombine(hashKids(ID_NODE, {}), hashString(myStrVal));
 	}
-	void unparse(std::ostream& out, int indent);
+	template <typename Sink> void render(Sink& out, int indent);
+	void exportTo(ASTExporter& exp, size_t parent);
+	void minify(Minifier& out);
+	void measure(MemoryReport& report);
+	Typed compile(ClosureCompiler& cc);
+	Place locate(ClosureCompiler& cc);
+	IdNode * clone(ASTArena& arena);
+	NodeKind kind() const { return ID_NODE; }
+	bool sameAs(ASTNode * other);
+	const std::string& getName(){ return myStrVal; }
+	size_t getOffset(){ return mySpan.offset; }
 private:
-	std::list<ExpNode *> myExpList;
+	std::string myStrVal;
 };
 
-class DeclListNode : public ASTNode{
+class TypeNode : public ASTNode{
 public:
-	DeclListNode(std::list<DeclNode *> * decls) : ASTNode(){
-		myDecls = *decls;
+	TypeNode() : ASTNode(){
 	}
-	void unparse(std::ostream& out, int indent);
-private:
-	std::list<DeclNode *> myDecls;
+	virtual void exportTo(ASTExporter& exp, size_t parent) = 0;
+	virtual void minify(Minifier& out) = 0;
+	virtual void measure(MemoryReport& report) = 0;
+	virtual ValueType compile(ClosureCompiler& cc) = 0;
+	virtual TypeNode * clone(ASTArena& arena) = 0;
 };
 
-class DeclNode : public ASTNode{
+class IntNode : public TypeNode{
 public:
-	virtual void unparse(std::ostream& out, int indent) = 0;
+	IntNode(): TypeNode(){
+		myHash = hashKids(INT_NODE, {});
+	}
+	template <typename Sink> void render(Sink& out, int indent);
+	void exportTo(ASTExporter& exp, size_t parent);
+	void minify(Minifier& out);
+	void measure(MemoryReport& report);
+	ValueType compile(ClosureCompiler& cc);
+	IntNode * clone(ASTArena& arena);
+	NodeKind kind() const { return INT_NODE; }
+	bool sameAs(ASTNode * other);
 };
 
-class VarDeclNode : public DeclNode{
+class BoolNode : public TypeNode {
 public:
-	VarDeclNode(TypeNode * type, IdNode * id, int size) : DeclNode(){
-		myType = type;
-		myId = id;
-		mySize = size;
+	BoolNode() : TypeNode() {
+		myHash = hashKids(BOOL_NODE, {});
 	}
-	void unparse(std::ostream& out, int indent);
-	static const int NOT_STRUCT = -1; //Use this value for mySize
-					  // if this is not a struct type
-private:
-	TypeNode * myType;
-	IdNode * myId;
-	int mySize;
+	template <typename Sink> void render(Sink& out, int indent);
+	void exportTo(ASTExporter& exp, size_t parent);
+	void minify(Minifier& out);
+	void measure(MemoryReport& report);
+	ValueType compile(ClosureCompiler& cc);
+	BoolNode * clone(ASTArena& arena);
+	NodeKind kind() const { return BOOL_NODE; }
+	bool sameAs(ASTNode * other);
 };
 
-class TypeNode : public ASTNode{
+class VoidNode : public TypeNode {
 public:
-	TypeNode() : ASTNode(){
+	VoidNode() : TypeNode() {
+		myHash = hashKids(VOID_NODE, {});
 	}
-	virtual void unparse(std::ostream& out, int indent) = 0;
+	template <typename Sink> void render(Sink& out, int indent);
+	void exportTo(ASTExporter& exp, size_t parent);
+	void minify(Minifier& out);
+	void measure(MemoryReport& report);
+	ValueType compile(ClosureCompiler& cc);
+	VoidNode * clone(ASTArena& arena);
+	NodeKind kind() const { return VOID_NODE; }
+	bool sameAs(ASTNode * other);
 };
 
-class IdNode : public ExpNode{
+class StructNode : public TypeNode {
 public:
-	IdNode(IDToken * token) : ExpNode(){
-		myStrVal = token->value();
+	StructNode(IdNode * id) : TypeNode() {
+		myId = id;
+		rehash();
 	}
-	void unparse(std::ostream& out, int indent);
+	template <typename Sink> void render(Sink& out, int indent);
+	void exportTo(ASTExporter& exp, size_t parent);
+	void minify(Minifier& out);
+	void measure(MemoryReport& report);
+	ValueType compile(ClosureCompiler& cc);
+	StructNode * clone(ASTArena& arena);
+	NodeKind kind() const { return STRUCT_NODE; }
+	bool sameAs(ASTNode * other);
+	void children(std::vector<ASTNode *>& out);
+	void rehash(){ myHash = hashKids(STRUCT_NODE, {myId}); }
 private:
-	std::string myStrVal;
+	IdNode * myId;
 };
 
-class IntNode : public TypeNode{
+class DeclNode : public ASTNode{
 public:
-	IntNode(): TypeNode(){
-	}
-	void unparse(std::ostream& out, int indent);
+	virtual void exportTo(ASTExporter& exp, size_t parent) = 0;
+	virtual void minify(Minifier& out) = 0;
+	virtual void measure(MemoryReport& report) = 0;
+	virtual void compile(ClosureCompiler& cc) = 0;
+	virtual DeclNode * clone(ASTArena& arena) = 0;
 };
 
-class BoolNode : public TypeNode {
+class DeclListNode : public ASTNode{
 public:
-	BoolNode() : TypeNode() {
+	DeclListNode(std::list<DeclNode *> * decls) : ASTNode(){
+		myDecls = *decls;
+		rehash();
 	}
-	void unparse(std::ostream& out, int indent);
+	template <typename Sink> void render(Sink& out, int indent);
+	void exportTo(ASTExporter& exp, size_t parent);
+	void minify(Minifier& out);
+	void measure(MemoryReport& report);
+	void compile(ClosureCompiler& cc);
+	DeclListNode * clone(ASTArena& arena);
+	NodeKind kind() const { return DECL_LIST_NODE; }
+	bool sameAs(ASTNode * other);
+	void children(std::vector<ASTNode *>& out);
+	void rehash(){ myHash = hashList(DECL_LIST_NODE, myDecls); }
+	std::list<DeclNode *> * getDecls(){ return &myDecls; }
+private:
+	std::list<DeclNode *> myDecls;
 };
 
-class VoidNode : public TypeNode {
+class ProgramNode : public ASTNode{
 public:
-	VoidNode() : TypeNode() {
+	ProgramNode(DeclListNode * L) : ASTNode(){
+		myDeclList = L;
+		rehash();
 	}
-	void unparse(std::ostream& out, int indent);
+	template <typename Sink> void render(Sink& out, int indent);
+	void exportTo(ASTExporter& exp, size_t parent);
+	void minify(Minifier& out);
+	void measure(MemoryReport& report);
+	void compile(ClosureCompiler& cc);
+	ProgramNode * clone(ASTArena& arena);
+	NodeKind kind() const { return PROGRAM_NODE; }
+	bool sameAs(ASTNode * other);
+	void children(std::vector<ASTNode *>& out);
+	void rehash(){ myHash = hashKids(PROGRAM_NODE, {myDeclList}); }
+	DeclListNode * getDeclList(){ return myDeclList; }
+private:
+	DeclListNode * myDeclList;
+
 };
 
-class StructDeclNode : public DeclNode {
+class ExpListNode : public ASTNode {
 public:
-	StructDeclNode(IdNode * id, DeclListNode * declList) : DeclNode() {
-		myId = id;
-		myDeclList = declList;
+	ExpListNode(std::list<ExpNode *> * expList) : ASTNode() {
+		myExpList = *expList;
+		rehash();
 	}
-	void unparse(std::ostream& out, int indent);
+	template <typename Sink> void render(Sink& out, int indent);
+	void exportTo(ASTExporter& exp, size_t parent);
+	void minify(Minifier& out);
+	void measure(MemoryReport& report);
+	void compile(ClosureCompiler& cc, std::vector<Typed>& out);
+	ExpListNode * clone(ASTArena& arena);
+	NodeKind kind() const { return EXP_LIST_NODE; }
+	bool sameAs(ASTNode * other);
+	void children(std::vector<ASTNode *>& out);
+	void rehash(){ myHash = hashList(EXP_LIST_NODE, myExpList); }
 private:
-	IdNode * myId;
-	DeclListNode * myDeclList;
+	std::list<ExpNode *> myExpList;
 };
 
-class StructNode : public TypeNode {
+class VarDeclNode : public DeclNode{
 public:
-	StructNode(IdNode * id) : TypeNode() {
+	VarDeclNode(TypeNode * type, IdNode * id, int size) : DeclNode(){
+		myType = type;
 		myId = id;
+		mySize = size;
+		rehash();
 	}
-	void unparse(std::ostream& out, int indent);
+	template <typename Sink> void render(Sink& out, int indent);
+	void exportTo(ASTExporter& exp, size_t parent);
+	void minify(Minifier& out);
+	void measure(MemoryReport& report);
+	void compile(ClosureCompiler& cc);
+	VarDeclNode * clone(ASTArena& arena);
+	NodeKind kind() const { return VAR_DECL_NODE; }
+	bool sameAs(ASTNode * other);
+	void children(std::vector<ASTNode *>& out);
+	void rehash(){
+		myHash = hashCombine(hashKids(VAR_DECL_NODE, {myType, myId}),
+			(uint32_t)mySize);
+	}
+	IdNode * getId(){ return myId; }
+	static const int NOT_STRUCT = -1; //Use this value for mySize
+					  // if this is not a struct type
 private:
+	TypeNode * myType;
 	IdNode * myId;
+	int mySize;
 };
 
-class FnDeclNode : public DeclNode {
+class StructDeclNode : public DeclNode {
 public:
-	FnDeclNode(TypeNode * type, IdNode * id, FormalsListNode * formalsList,
-		FnBodyNode * fnBody) : DeclNode() {
-			myType = type;
-			myId = id;
-			myFormalsList = formalsList;
-			myFnBody = fnBody;
+	StructDeclNode(IdNode * id, DeclListNode * declList) : DeclNode() {
+		myId = id;
+		myDeclList = declList;
+		rehash();
 	}
-	void unparse(std::ostream& out, int indent);
+	template <typename Sink> void render(Sink& out, int indent);
+	void exportTo(ASTExporter& exp, size_t parent);
+	void minify(Minifier& out);
+	void measure(MemoryReport& report);
+	void compile(ClosureCompiler& cc);
+	StructDeclNode * clone(ASTArena& arena);
+	NodeKind kind() const { return STRUCT_DECL_NODE; }
+	bool sameAs(ASTNode * other);
+	void children(std::vector<ASTNode *>& out);
+	void rehash(){
+		myHash = hashKids(STRUCT_DECL_NODE, {myId, myDeclList});
+	}
+	IdNode * getId(){ return myId; }
+	void forgetRendered(){ myRendered = RenderedText(); }
 private:
-	TypeNode * myType;
 	IdNode * myId;
-	FormalsListNode * myFormalsList;
-	FnBodyNode * myFnBody;
+	DeclListNode * myDeclList;
+	RenderedText myRendered;
 };
 
 class FormalDeclNode : public DeclNode {
@@ -264,8 +533,18 @@ public:
 	FormalDeclNode(TypeNode * type, IdNode * id) : DeclNode() {
 		myType = type;
 		myId = id;
+		rehash();
 	}
-	void unparse(std::ostream& out, int indent);
+	template <typename Sink> void render(Sink& out, int indent);
+	void exportTo(ASTExporter& exp, size_t parent);
+	void minify(Minifier& out);
+	void measure(MemoryReport& report);
+	void compile(ClosureCompiler& cc);
+	FormalDeclNode * clone(ASTArena& arena);
+	NodeKind kind() const { return FORMAL_DECL_NODE; }
+	bool sameAs(ASTNode * other);
+	void children(std::vector<ASTNode *>& out);
+	void rehash(){ myHash = hashKids(FORMAL_DECL_NODE, {myType, myId}); }
 private:
 	TypeNode * myType;
 	IdNode * myId;
@@ -275,49 +554,111 @@ class FormalsListNode : public ASTNode {
 public:
 	FormalsListNode(std::list<FormalDeclNode *> * formalDeclList) : ASTNode() {
 		myFormalDeclList = *formalDeclList;
+		rehash();
 	}
-	void unparse(std::ostream& out, int indent);
+	template <typename Sink> void render(Sink& out, int indent);
+	void exportTo(ASTExporter& exp, size_t parent);
+	void minify(Minifier& out);
+	void measure(MemoryReport& report);
+	void compile(ClosureCompiler& cc);
+	FormalsListNode * clone(ASTArena& arena);
+	NodeKind kind() const { return FORMALS_LIST_NODE; }
+	bool sameAs(ASTNode * other);
+	void children(std::vector<ASTNode *>& out);
+	void rehash(){ myHash = hashList(FORMALS_LIST_NODE, myFormalDeclList); }
 private:
 	std::list<FormalDeclNode *> myFormalDeclList;
 };
 
-class FnBodyNode : public ASTNode {
+class StmtNode : public ASTNode {
 public:
-	FnBodyNode(DeclListNode * declList, StmtListNode * stmtList) : ASTNode() {
-		myDeclList = declList;
-		myStmtList = stmtList;
+	StmtNode() : ASTNode() {
 	}
-	void unparse(std::ostream& out, int indent);
-private:
-	DeclListNode * myDeclList;
-	StmtListNode * myStmtList;
+	virtual void exportTo(ASTExporter& exp, size_t parent) = 0;
+	virtual void minify(Minifier& out) = 0;
+	virtual void measure(MemoryReport& report) = 0;
+	virtual const StmtCode * compile(ClosureCompiler& cc) = 0;
+	virtual StmtNode * clone(ASTArena& arena) = 0;
 };
 
 class StmtListNode : public ASTNode {
 public:
 	StmtListNode(std::list<StmtNode *> * stmtList) : ASTNode() {
 		myStmtList = *stmtList;
+		rehash();
 	}
-	void unparse(std::ostream& out, int indent);
+	template <typename Sink> void render(Sink& out, int indent);
+	void exportTo(ASTExporter& exp, size_t parent);
+	void minify(Minifier& out);
+	void measure(MemoryReport& report);
+	const StmtCode * compile(ClosureCompiler& cc);
+	StmtListNode * clone(ASTArena& arena);
+	NodeKind kind() const { return STMT_LIST_NODE; }
+	bool sameAs(ASTNode * other);
+	void children(std::vector<ASTNode *>& out);
+	void rehash(){ myHash = hashList(STMT_LIST_NODE, myStmtList); }
+	std::list<StmtNode *> * getStmts(){ return &myStmtList; }
 private:
 	std::list<StmtNode *> myStmtList;
 };
 
-class StmtNode : public ASTNode {
+class FnBodyNode : public ASTNode {
 public:
-	StmtNode() : ASTNode() {
+	FnBodyNode(DeclListNode * declList, StmtListNode * stmtList) : ASTNode() {
+		myDeclList = declList;
+		myStmtList = stmtList;
+		rehash();
+	}
+	template <typename Sink> void render(Sink& out, int indent);
+	void exportTo(ASTExporter& exp, size_t parent);
+	void minify(Minifier& out);
+	void measure(MemoryReport& report);
+	const StmtCode * compile(ClosureCompiler& cc);
+	FnBodyNode * clone(ASTArena& arena);
+	NodeKind kind() const { return FN_BODY_NODE; }
+	bool sameAs(ASTNode * other);
+	void children(std::vector<ASTNode *>& out);
+	void rehash(){
+		myHash = hashKids(FN_BODY_NODE, {myDeclList, myStmtList});
 	}
-	virtual void unparse(std::ostream& out, int indent) = 0;
+	StmtListNode * getStmtList(){ return myStmtList; }
+private:
+	DeclListNode * myDeclList;
+	StmtListNode * myStmtList;
 };
 
-class AssignStmtNode : public StmtNode {
+class FnDeclNode : public DeclNode {
 public:
-	AssignStmtNode(AssignNode * assignNode) : StmtNode() {
-		myAssignNode = assignNode;
+	FnDeclNode(TypeNode * type, IdNode * id, FormalsListNode * formalsList,
+		FnBodyNode * fnBody) : DeclNode() {
+			myType = type;
+			myId = id;
+			myFormalsList = formalsList;
+			myFnBody = fnBody;
+			rehash();
 	}
-	void unparse(std::ostream& out, int indent);
+	template <typename Sink> void render(Sink& out, int indent);
+	void exportTo(ASTExporter& exp, size_t parent);
+	void minify(Minifier& out);
+	void measure(MemoryReport& report);
+	void compile(ClosureCompiler& cc);
+	FnDeclNode * clone(ASTArena& arena);
+	NodeKind kind() const { return FN_DECL_NODE; }
+	bool sameAs(ASTNode * other);
+	void children(std::vector<ASTNode *>& out);
+	void rehash(){
+		myHash = hashKids(FN_DECL_NODE,
+			{myType, myId, myFormalsList, myFnBody});
+	}
+	IdNode * getId(){ return myId; }
+	FnBodyNode * getFnBody(){ return myFnBody; }
+	void forgetRendered(){ myRendered = RenderedText(); }
 private:
-	AssignNode * myAssignNode;
+	TypeNode * myType;
+	IdNode * myId;
+	FormalsListNode * myFormalsList;
+	FnBodyNode * myFnBody;
+	RenderedText myRendered;
 };
 
 class AssignNode : public ExpNode {
@@ -325,8 +666,20 @@ public:
 	AssignNode(ExpNode * expNode1, ExpNode * expNode2) : ExpNode() {
 		myExpNode1 = expNode1;
 		myExpNode2 = expNode2;
+		rehash();
+	}
+	template <typename Sink> void render(Sink& out, int indent);
+	void exportTo(ASTExporter& exp, size_t parent);
+	void minify(Minifier& out);
+	void measure(MemoryReport& report);
+	Typed compile(ClosureCompiler& cc);
+	AssignNode * clone(ASTArena& arena);
+	NodeKind kind() const { return ASSIGN_NODE; }
+	bool sameAs(ASTNode * other);
+	void children(std::vector<ASTNode *>& out);
+	void rehash(){
+		myHash = hashKids(ASSIGN_NODE, {myExpNode1, myExpNode2});
 	}
-	void unparse(std::ostream& out, int indent);
 private:
 	ExpNode * myExpNode1;
 	ExpNode * myExpNode2;
@@ -337,8 +690,19 @@ public:
 	DotAccessNode(ExpNode * expNode, IdNode * id) : ExpNode() {
 		myExp = expNode;
 		myId = id;
+		rehash();
 	}
-	void unparse(std::ostream& out, int indent);
+	template <typename Sink> void render(Sink& out, int indent);
+	void exportTo(ASTExporter& exp, size_t parent);
+	void minify(Minifier& out);
+	void measure(MemoryReport& report);
+	Typed compile(ClosureCompiler& cc);
+	Place locate(ClosureCompiler& cc);
+	DotAccessNode * clone(ASTArena& arena);
+	NodeKind kind() const { return DOT_ACCESS_NODE; }
+	bool sameAs(ASTNode * other);
+	void children(std::vector<ASTNode *>& out);
+	void rehash(){ myHash = hashKids(DOT_ACCESS_NODE, {myExp, myId}); }
 private:
 	ExpNode * myExp;
 	IdNode * myId;
@@ -348,8 +712,18 @@ class IntLitNode : public ExpNode {
 public:
 	IntLitNode(IntLitToken * intLit) : ExpNode() {
 		myIntLit = intLit;
+		myHash = hashCombine(hashKids(INT_LIT_NODE, {}),
+			(uint32_t)intLit->value());
 	}
-	void unparse(std::ostream& out, int indent);
+	template <typename Sink> void render(Sink& out, int indent);
+	void exportTo(ASTExporter& exp, size_t parent);
+	void minify(Minifier& out);
+	void measure(MemoryReport& report);
+	Typed compile(ClosureCompiler& cc);
+	IntLitNode * clone(ASTArena& arena);
+	NodeKind kind() const { return INT_LIT_NODE; }
+	bool sameAs(ASTNode * other);
+	int getValue(){ return myIntLit->value(); }
 private:
 	IntLitToken * myIntLit;
 };
@@ -358,8 +732,17 @@ class StrLitNode : public ExpNode {
 public:
 	StrLitNode(StringLitToken * stringLit) : ExpNode() {
 		myStringLit = stringLit;
+		myHash = hashCombine(hashKids(STR_LIT_NODE, {}),
+			hashString(stringLit->value()));
 	}
-	void unparse(std::ostream& out, int indent);
+	template <typename Sink> void render(Sink& out, int indent);
+	void exportTo(ASTExporter& exp, size_t parent);
+	void minify(Minifier& out);
+	void measure(MemoryReport& report);
+	Typed compile(ClosureCompiler& cc);
+	StrLitNode * clone(ASTArena& arena);
+	NodeKind kind() const { return STR_LIT_NODE; }
+	bool sameAs(ASTNode * other);
 private:
 	StringLitToken * myStringLit;
 };
@@ -367,257 +750,489 @@ private:
 class TrueNode : public ExpNode {
 public:
 	TrueNode() : ExpNode() {
+		myHash = hashKids(TRUE_NODE, {});
 	}
-	void unparse(std::ostream& out, int indent);
+	template <typename Sink> void render(Sink& out, int indent);
+	void exportTo(ASTExporter& exp, size_t parent);
+	void minify(Minifier& out);
+	void measure(MemoryReport& report);
+	Typed compile(ClosureCompiler& cc);
+	TrueNode * clone(ASTArena& arena);
+	NodeKind kind() const { return TRUE_NODE; }
+	bool sameAs(ASTNode * other);
 };
 
 class FalseNode : public ExpNode {
 public:
 	FalseNode() : ExpNode() {
+		myHash = hashKids(FALSE_NODE, {});
 	}
-	void unparse(std::ostream& out, int indent);
+	template <typename Sink> void render(Sink& out, int indent);
+	void exportTo(ASTExporter& exp, size_t parent);
+	void minify(Minifier& out);
+	void measure(MemoryReport& report);
+	Typed compile(ClosureCompiler& cc);
+	FalseNode * clone(ASTArena& arena);
+	NodeKind kind() const { return FALSE_NODE; }
+	bool sameAs(ASTNode * other);
 };
 
-class PostIncStmtNode : public StmtNode {
+class BinaryExpNode : public ExpNode {
 public:
-	PostIncStmtNode(ExpNode * expNode) : StmtNode() {
-		myExp = expNode;
+	BinaryExpNode(NodeKind kind, ExpNode * expNode1, ExpNode * expNode2)
+	: ExpNode() {
+		myExp1 = expNode1;
+		myExp2 = expNode2;
+		myHash = hashKids(kind, {expNode1, expNode2});
 	}
-	void unparse(std::ostream& out, int indent);
-private:
-	ExpNode * myExp;
+	virtual void exportTo(ASTExporter& exp, size_t parent) = 0;
+	virtual void minify(Minifier& out) = 0;
+	void measure(MemoryReport& report);
+	Typed compile(ClosureCompiler& cc);
+	virtual ExpNode * clone(ASTArena& arena) = 0;
+	bool sameAs(ASTNode * other);
+	void children(std::vector<ASTNode *>& out);
+	void rehash(){ myHash = hashKids(kind(), {myExp1, myExp2}); }
+	ExpNode * getExp1(){ return myExp1; }
+	ExpNode * getExp2(){ return myExp2; }
+protected:
+	ExpNode * myExp1;
+	ExpNode * myExp2;
 };
 
-class PostDecStmtNode : public StmtNode {
+class PlusNode : public BinaryExpNode {
 public:
-	PostDecStmtNode(ExpNode * expNode) : StmtNode() {
-		myExp = expNode;
+	PlusNode(ExpNode * expNode1, ExpNode * expNode2)
+	: BinaryExpNode(PLUS_NODE, expNode1, expNode2) {
 	}
-	void unparse(std::ostream& out, int indent);
-private:
-	ExpNode * myExp;
+	template <typename Sink> void render(Sink& out, int indent);
+	void exportTo(ASTExporter& exp, size_t parent);
+	void minify(Minifier& out);
+	PlusNode * clone(ASTArena& arena);
+	NodeKind kind() const { return PLUS_NODE; }
 };
 
-class ReadStmtNode : public StmtNode {
+class MinusNode : public BinaryExpNode {
 public:
-	ReadStmtNode(ExpNode * expNode) : StmtNode() {
-		myExp = expNode;
+	MinusNode(ExpNode * expNode1, ExpNode * expNode2)
+	: BinaryExpNode(MINUS_NODE, expNode1, expNode2) {
 	}
-	void unparse(std::ostream& out, int indent);
-private:
-	ExpNode * myExp;
+	template <typename Sink> void render(Sink& out, int indent);
+	void exportTo(ASTExporter& exp, size_t parent);
+	void minify(Minifier& out);
+	MinusNode * clone(ASTArena& arena);
+	NodeKind kind() const { return MINUS_NODE; }
 };
 
-class WriteStmtNode : public StmtNode {
+class TimesNode : public BinaryExpNode {
 public:
-	WriteStmtNode(ExpNode * expNode) : StmtNode() {
-		myExp = expNode;
+	TimesNode(ExpNode * expNode1, ExpNode * expNode2)
+	: BinaryExpNode(TIMES_NODE, expNode1, expNode2) {
 	}
-	void unparse(std::ostream& out, int indent);
-private:
-	ExpNode * myExp;
+	template <typename Sink> void render(Sink& out, int indent);
+	void exportTo(ASTExporter& exp, size_t parent);
+	void minify(Minifier& out);
+	TimesNode * clone(ASTArena& arena);
+	NodeKind kind() const { return TIMES_NODE; }
 };
 
-class IfStmtNode : public StmtNode {
+class DivideNode : public BinaryExpNode {
 public:
-	IfStmtNode(ExpNode * expNode, DeclListNode* declList,
-		StmtListNode * stmtList) : StmtNode() {
-			myExp = expNode;
-			myDeclList = declList;
-			myStmtList = stmtList;
+	DivideNode(ExpNode * expNode1, ExpNode * expNode2)
+	: BinaryExpNode(DIVIDE_NODE, expNode1, expNode2) {
 	}
-	void unparse(std::ostream& out, int indent);
-private:
-	ExpNode * myExp;
-	DeclListNode * myDeclList;
-	StmtListNode * myStmtList;
+	template <typename Sink> void render(Sink& out, int indent);
+	void exportTo(ASTExporter& exp, size_t parent);
+	void minify(Minifier& out);
+	DivideNode * clone(ASTArena& arena);
+	NodeKind kind() const { return DIVIDE_NODE; }
 };
 
-class IfElseStmtNode : public StmtNode {
+class AndNode : public BinaryExpNode {
 public:
-	IfElseStmtNode(ExpNode * expNode, DeclListNode* declList1,
-		StmtListNode * stmtList1, DeclListNode* declList2,
-			StmtListNode * stmtList2) : StmtNode() {
-			myExp = expNode;
-			myDeclList1 = declList1;
-			myStmtList1 = stmtList1;
-			myDeclList2 = declList2;
-			myStmtList2 = stmtList2;
+	AndNode(ExpNode * expNode1, ExpNode * expNode2)
+	: BinaryExpNode(AND_NODE, expNode1, expNode2) {
 	}
-	void unparse(std::ostream& out, int indent);
-private:
-	ExpNode * myExp;
-	DeclListNode * myDeclList1;
-	StmtListNode * myStmtList1;
-	DeclListNode * myDeclList2;
-	StmtListNode * myStmtList2;
+	template <typename Sink> void render(Sink& out, int indent);
+	void exportTo(ASTExporter& exp, size_t parent);
+	void minify(Minifier& out);
+	AndNode * clone(ASTArena& arena);
+	NodeKind kind() const { return AND_NODE; }
 };
 
-class WhileStmtNode : public StmtNode {
+class OrNode : public BinaryExpNode {
 public:
-	WhileStmtNode(ExpNode * expNode, DeclListNode* declList,
-		StmtListNode * stmtList) : StmtNode() {
-			myExp = expNode;
-			myDeclList = declList;
-			myStmtList = stmtList;
+	OrNode(ExpNode * expNode1, ExpNode * expNode2)
+	: BinaryExpNode(OR_NODE, expNode1, expNode2) {
 	}
-	void unparse(std::ostream& out, int indent);
-private:
-	ExpNode * myExp;
-	DeclListNode * myDeclList;
-	StmtListNode * myStmtList;
+	template <typename Sink> void render(Sink& out, int indent);
+	void exportTo(ASTExporter& exp, size_t parent);
+	void minify(Minifier& out);
+	OrNode * clone(ASTArena& arena);
+	NodeKind kind() const { return OR_NODE; }
 };
 
-class ReturnStmtNode : public StmtNode {
+class EqualsNode : public BinaryExpNode {
 public:
-	ReturnStmtNode(ExpNode * expNode) : StmtNode() {
-		myExp = expNode;
+	EqualsNode(ExpNode * expNode1, ExpNode * expNode2)
+	: BinaryExpNode(EQUALS_NODE, expNode1, expNode2) {
 	}
-	void unparse(std::ostream& out, int indent);
-private:
-	ExpNode * myExp;
+	template <typename Sink> void render(Sink& out, int indent);
+	void exportTo(ASTExporter& exp, size_t parent);
+	void minify(Minifier& out);
+	EqualsNode * clone(ASTArena& arena);
+	NodeKind kind() const { return EQUALS_NODE; }
 };
 
-class BinaryExpNode : public ExpNode {
+class NotEqualsNode : public BinaryExpNode {
 public:
-	BinaryExpNode(ExpNode * expNode1, ExpNode * expNode2) : ExpNode() {
-		myExp1 = expNode1;
-		myExp2 = expNode2;
+	NotEqualsNode(ExpNode * expNode1, ExpNode * expNode2)
+	: BinaryExpNode(NOT_EQUALS_NODE, expNode1, expNode2) {
 	}
-	virtual void unparse(std::ostream& out, int indent) = 0;
-protected:
-	ExpNode * myExp1;
-	ExpNode * myExp2;
+	template <typename Sink> void render(Sink& out, int indent);
+	void exportTo(ASTExporter& exp, size_t parent);
+	void minify(Minifier& out);
+	NotEqualsNode * clone(ASTArena& arena);
+	NodeKind kind() const { return NOT_EQUALS_NODE; }
 };
 
-class PlusNode : public BinaryExpNode {
+class LessNode : public BinaryExpNode {
 public:
-	PlusNode(ExpNode * expNode1, ExpNode * expNode2) : BinaryExpNode(expNode1, expNode2) {
+	LessNode(ExpNode * expNode1, ExpNode * expNode2)
+	: BinaryExpNode(LESS_NODE, expNode1, expNode2) {
 	}
-	void unparse(std::ostream& out, int indent);
+	template <typename Sink> void render(Sink& out, int indent);
+	void exportTo(ASTExporter& exp, size_t parent);
+	void minify(Minifier& out);
+	LessNode * clone(ASTArena& arena);
+	NodeKind kind() const { return LESS_NODE; }
 };
 
-class MinusNode : public BinaryExpNode {
+class GreaterNode : public BinaryExpNode {
 public:
-	MinusNode(ExpNode * expNode1, ExpNode * expNode2) : BinaryExpNode(expNode1, expNode2) {
+	GreaterNode(ExpNode * expNode1, ExpNode * expNode2)
+	: BinaryExpNode(GREATER_NODE, expNode1, expNode2) {
 	}
-	void unparse(std::ostream& out, int indent);
+	template <typename Sink> void render(Sink& out, int indent);
+	void exportTo(ASTExporter& exp, size_t parent);
+	void minify(Minifier& out);
+	GreaterNode * clone(ASTArena& arena);
+	NodeKind kind() const { return GREATER_NODE; }
 };
 
-class TimesNode : public BinaryExpNode {
+class LessEqNode : public BinaryExpNode {
 public:
-	TimesNode(ExpNode * expNode1, ExpNode * expNode2) : BinaryExpNode(expNode1, expNode2) {
+	LessEqNode(ExpNode * expNode1, ExpNode * expNode2)
+	: BinaryExpNode(LESS_EQ_NODE, expNode1, expNode2) {
 	}
-	void unparse(std::ostream& out, int indent);
+	template <typename Sink> void render(Sink& out, int indent);
+	void exportTo(ASTExporter& exp, size_t parent);
+	void minify(Minifier& out);
+	LessEqNode * clone(ASTArena& arena);
+	NodeKind kind() const { return LESS_EQ_NODE; }
 };
 
-class DivideNode : public BinaryExpNode {
+class GreaterEqNode : public BinaryExpNode {
 public:
-	DivideNode(ExpNode * expNode1, ExpNode * expNode2) : BinaryExpNode(expNode1, expNode2) {
+	GreaterEqNode(ExpNode * expNode1, ExpNode * expNode2)
+	: BinaryExpNode(GREATER_EQ_NODE, expNode1, expNode2) {
 	}
-	void unparse(std::ostream& out, int indent);
+	template <typename Sink> void render(Sink& out, int indent);
+	void exportTo(ASTExporter& exp, size_t parent);
+	void minify(Minifier& out);
+	GreaterEqNode * clone(ASTArena& arena);
+	NodeKind kind() const { return GREATER_EQ_NODE; }
 };
 
-class AndNode : public BinaryExpNode {
+class UnaryExpNode : public ExpNode {
 public:
-	AndNode(ExpNode * expNode1, ExpNode * expNode2) : BinaryExpNode(expNode1, expNode2) {
+	UnaryExpNode(NodeKind kind, ExpNode * expNode) : ExpNode() {
+		myExp = expNode;
+		myHash = hashKids(kind, {expNode});
 	}
-	void unparse(std::ostream& out, int indent);
+	virtual void exportTo(ASTExporter& exp, size_t parent) = 0;
+	virtual void minify(Minifier& out) = 0;
+	void measure(MemoryReport& report);
+	Typed compile(ClosureCompiler& cc);
+	virtual ExpNode * clone(ASTArena& arena) = 0;
+	bool sameAs(ASTNode * other);
+	void children(std::vector<ASTNode *>& out);
+	void rehash(){ myHash = hashKids(kind(), {myExp}); }
+	ExpNode * getExp(){ return myExp; }
+protected:
+	ExpNode * myExp;
 };
 
-class OrNode : public BinaryExpNode {
+class NotNode : public UnaryExpNode {
 public:
-	OrNode(ExpNode * expNode1, ExpNode * expNode2) : BinaryExpNode(expNode1, expNode2) {
+	NotNode(ExpNode * expNode) : UnaryExpNode(NOT_NODE, expNode) {
 	}
-	void unparse(std::ostream& out, int indent);
+	template <typename Sink> void render(Sink& out, int indent);
+	void exportTo(ASTExporter& exp, size_t parent);
+	void minify(Minifier& out);
+	NotNode * clone(ASTArena& arena);
+	NodeKind kind() const { return NOT_NODE; }
 };
 
-class EqualsNode : public BinaryExpNode {
+class UnaryMinusNode : public UnaryExpNode {
 public:
-	EqualsNode(ExpNode * expNode1, ExpNode * expNode2) : BinaryExpNode(expNode1, expNode2) {
+	UnaryMinusNode(ExpNode * expNode)
+	: UnaryExpNode(UNARY_MINUS_NODE, expNode) {
 	}
-	void unparse(std::ostream& out, int indent);
+	template <typename Sink> void render(Sink& out, int indent);
+	void exportTo(ASTExporter& exp, size_t parent);
+	void minify(Minifier& out);
+	UnaryMinusNode * clone(ASTArena& arena);
+	NodeKind kind() const { return UNARY_MINUS_NODE; }
 };
 
-class NotEqualsNode : public BinaryExpNode {
+class CallExpNode : public ExpNode{
 public:
-	NotEqualsNode(ExpNode * expNode1, ExpNode * expNode2) : BinaryExpNode(expNode1, expNode2) {
+	CallExpNode(IdNode * id, ExpListNode * expListNode) : ExpNode(){
+		myExpList = expListNode;
+		myId = id;
+		rehash();
 	}
-	void unparse(std::ostream& out, int indent);
+	template <typename Sink> void render(Sink& out, int indent);
+	void exportTo(ASTExporter& exp, size_t parent);
+	void minify(Minifier& out);
+	void measure(MemoryReport& report);
+	Typed compile(ClosureCompiler& cc);
+	CallExpNode * clone(ASTArena& arena);
+	NodeKind kind() const { return CALL_EXP_NODE; }
+	bool sameAs(ASTNode * other);
+	void children(std::vector<ASTNode *>& out);
+	void rehash(){ myHash = hashKids(CALL_EXP_NODE, {myId, myExpList}); }
+private:
+	ExpListNode * myExpList;
+	IdNode * myId;
 };
 
-class LessNode : public BinaryExpNode {
+class AssignStmtNode : public StmtNode {
 public:
-	LessNode(ExpNode * expNode1, ExpNode * expNode2) : BinaryExpNode(expNode1, expNode2) {
+	AssignStmtNode(AssignNode * assignNode) : StmtNode() {
+		myAssignNode = assignNode;
+		rehash();
 	}
-	void unparse(std::ostream& out, int indent);
+	template <typename Sink> void render(Sink& out, int indent);
+	void exportTo(ASTExporter& exp, size_t parent);
+	void minify(Minifier& out);
+	void measure(MemoryReport& report);
+	const StmtCode * compile(ClosureCompiler& cc);
+	AssignStmtNode * clone(ASTArena& arena);
+	NodeKind kind() const { return ASSIGN_STMT_NODE; }
+	bool sameAs(ASTNode * other);
+	void children(std::vector<ASTNode *>& out);
+	void rehash(){ myHash = hashKids(ASSIGN_STMT_NODE, {myAssignNode}); }
+private:
+	AssignNode * myAssignNode;
 };
 
-class GreaterNode : public BinaryExpNode {
+class PostIncStmtNode : public StmtNode {
 public:
-	GreaterNode(ExpNode * expNode1, ExpNode * expNode2) : BinaryExpNode(expNode1, expNode2) {
+	PostIncStmtNode(ExpNode * expNode) : StmtNode() {
+		myExp = expNode;
+		rehash();
 	}
-	void unparse(std::ostream& out, int indent);
+	template <typename Sink> void render(Sink& out, int indent);
+	void exportTo(ASTExporter& exp, size_t parent);
+	void minify(Minifier& out);
+	void measure(MemoryReport& report);
+	const StmtCode * compile(ClosureCompiler& cc);
+	PostIncStmtNode * clone(ASTArena& arena);
+	NodeKind kind() const { return POST_INC_STMT_NODE; }
+	bool sameAs(ASTNode * other);
+	void children(std::vector<ASTNode *>& out);
+	void rehash(){ myHash = hashKids(POST_INC_STMT_NODE, {myExp}); }
+private:
+	ExpNode * myExp;
 };
 
-class LessEqNode : public BinaryExpNode {
+class PostDecStmtNode : public StmtNode {
 public:
-	LessEqNode(ExpNode * expNode1, ExpNode * expNode2) : BinaryExpNode(expNode1, expNode2) {
+	PostDecStmtNode(ExpNode * expNode) : StmtNode() {
+		myExp = expNode;
+		rehash();
 	}
-	void unparse(std::ostream& out, int indent);
+	template <typename Sink> void render(Sink& out, int indent);
+	void exportTo(ASTExporter& exp, size_t parent);
+	void minify(Minifier& out);
+	void measure(MemoryReport& report);
+	const StmtCode * compile(ClosureCompiler& cc);
+	PostDecStmtNode * clone(ASTArena& arena);
+	NodeKind kind() const { return POST_DEC_STMT_NODE; }
+	bool sameAs(ASTNode * other);
+	void children(std::vector<ASTNode *>& out);
+	void rehash(){ myHash = hashKids(POST_DEC_STMT_NODE, {myExp}); }
+private:
+	ExpNode * myExp;
 };
 
-class GreaterEqNode : public BinaryExpNode {
+class ReadStmtNode : public StmtNode {
 public:
-	GreaterEqNode(ExpNode * expNode1, ExpNode * expNode2) : BinaryExpNode(expNode1, expNode2) {
+	ReadStmtNode(ExpNode * expNode) : StmtNode() {
+		myExp = expNode;
+		rehash();
 	}
-	void unparse(std::ostream& out, int indent);
+	template <typename Sink> void render(Sink& out, int indent);
+	void exportTo(ASTExporter& exp, size_t parent);
+	void minify(Minifier& out);
+	void measure(MemoryReport& report);
+	const StmtCode * compile(ClosureCompiler& cc);
+	ReadStmtNode * clone(ASTArena& arena);
+	NodeKind kind() const { return READ_STMT_NODE; }
+	bool sameAs(ASTNode * other);
+	void children(std::vector<ASTNode *>& out);
+	void rehash(){ myHash = hashKids(READ_STMT_NODE, {myExp}); }
+private:
+	ExpNode * myExp;
 };
 
-class CallExpNode : public ExpNode{
+class WriteStmtNode : public StmtNode {
 public:
-	CallExpNode(IdNode * id, ExpListNode * expListNode) : ExpNode(){
-		myExpList = expListNode;
-		myId = id;
+	WriteStmtNode(ExpNode * expNode) : StmtNode() {
+		myExp = expNode;
+		rehash();
 	}
-	void unparse(std::ostream& out, int indent);
+	template <typename Sink> void render(Sink& out, int indent);
+	void exportTo(ASTExporter& exp, size_t parent);
+	void minify(Minifier& out);
+	void measure(MemoryReport& report);
+	const StmtCode * compile(ClosureCompiler& cc);
+	WriteStmtNode * clone(ASTArena& arena);
+	NodeKind kind() const { return WRITE_STMT_NODE; }
+	bool sameAs(ASTNode * other);
+	void children(std::vector<ASTNode *>& out);
+	void rehash(){ myHash = hashKids(WRITE_STMT_NODE, {myExp}); }
 private:
-	ExpListNode * myExpList;
-	IdNode * myId;
+	ExpNode * myExp;
 };
 
-class CallStmtNode : public StmtNode{
+class IfStmtNode : public StmtNode {
 public:
-	CallStmtNode(CallExpNode * callExpNode) : StmtNode(){
-		myCallExpNode = callExpNode;
+	IfStmtNode(ExpNode * expNode, DeclListNode* declList,
+		StmtListNode * stmtList) : StmtNode() {
+			myExp = expNode;
+			myDeclList = declList;
+			myStmtList = stmtList;
+			rehash();
+	}
+	template <typename Sink> void render(Sink& out, int indent);
+	void exportTo(ASTExporter& exp, size_t parent);
+	void minify(Minifier& out);
+	void measure(MemoryReport& report);
+	const StmtCode * compile(ClosureCompiler& cc);
+	IfStmtNode * clone(ASTArena& arena);
+	NodeKind kind() const { return IF_STMT_NODE; }
+	bool sameAs(ASTNode * other);
+	void children(std::vector<ASTNode *>& out);
+	void rehash(){
+		myHash = hashKids(IF_STMT_NODE, {myExp, myDeclList, myStmtList});
 	}
-	void unparse(std::ostream& out, int indent);
 private:
-	CallExpNode * myCallExpNode;
+	ExpNode * myExp;
+	DeclListNode * myDeclList;
+	StmtListNode * myStmtList;
 };
 
-class UnaryExpNode : public ExpNode {
+class IfElseStmtNode : public StmtNode {
 public:
-	UnaryExpNode(ExpNode * expNode) : ExpNode() {
-		myExp = expNode;
+	IfElseStmtNode(ExpNode * expNode, DeclListNode* declList1,
+		StmtListNode * stmtList1, DeclListNode* declList2,
+			StmtListNode * stmtList2) : StmtNode() {
+			myExp = expNode;
+			myDeclList1 = declList1;
+			myStmtList1 = stmtList1;
+			myDeclList2 = declList2;
+			myStmtList2 = stmtList2;
+			rehash();
 	}
-	virtual void unparse(std::ostream& out, int indent) = 0;
-protected:
+	template <typename Sink> void render(Sink& out, int indent);
+	void exportTo(ASTExporter& exp, size_t parent);
+	void minify(Minifier& out);
+	void measure(MemoryReport& report);
+	const StmtCode * compile(ClosureCompiler& cc);
+	IfElseStmtNode * clone(ASTArena& arena);
+	NodeKind kind() const { return IF_ELSE_STMT_NODE; }
+	bool sameAs(ASTNode * other);
+	void children(std::vector<ASTNode *>& out);
+	void rehash(){
+		myHash = hashKids(IF_ELSE_STMT_NODE,
+			{myExp, myDeclList1, myStmtList1, myDeclList2, myStmtList2});
+	}
+private:
 	ExpNode * myExp;
+	DeclListNode * myDeclList1;
+	StmtListNode * myStmtList1;
+	DeclListNode * myDeclList2;
+	StmtListNode * myStmtList2;
 };
 
-class NotNode : public UnaryExpNode {
+class WhileStmtNode : public StmtNode {
 public:
-	NotNode(ExpNode * expNode) : UnaryExpNode(expNode) {
+	WhileStmtNode(ExpNode * expNode, DeclListNode* declList,
+		StmtListNode * stmtList) : StmtNode() {
+			myExp = expNode;
+			myDeclList = declList;
+			myStmtList = stmtList;
+			rehash();
 	}
-	void unparse(std::ostream& out, int indent);
+	template <typename Sink> void render(Sink& out, int indent);
+	void exportTo(ASTExporter& exp, size_t parent);
+	void minify(Minifier& out);
+	void measure(MemoryReport& report);
+	const StmtCode * compile(ClosureCompiler& cc);
+	WhileStmtNode * clone(ASTArena& arena);
+	NodeKind kind() const { return WHILE_STMT_NODE; }
+	bool sameAs(ASTNode * other);
+	void children(std::vector<ASTNode *>& out);
+	void rehash(){
+		myHash = hashKids(WHILE_STMT_NODE, {myExp, myDeclList, myStmtList});
+	}
+private:
+	ExpNode * myExp;
+	DeclListNode * myDeclList;
+	StmtListNode * myStmtList;
 };
 
-class UnaryMinusNode : public UnaryExpNode {
+class ReturnStmtNode : public StmtNode {
 public:
-	UnaryMinusNode(ExpNode * expNode) : UnaryExpNode(expNode) {
+	ReturnStmtNode(ExpNode * expNode) : StmtNode() {
+		myExp = expNode;
+		rehash();
 	}
-	void unparse(std::ostream& out, int indent);
+	template <typename Sink> void render(Sink& out, int indent);
+	void exportTo(ASTExporter& exp, size_t parent);
+	void minify(Minifier& out);
+	void measure(MemoryReport& report);
+	const StmtCode * compile(ClosureCompiler& cc);
+	ReturnStmtNode * clone(ASTArena& arena);
+	NodeKind kind() const { return RETURN_STMT_NODE; }
+	bool sameAs(ASTNode * other);
+	void children(std::vector<ASTNode *>& out);
+	void rehash(){ myHash = hashKids(RETURN_STMT_NODE, {myExp}); }
+private:
+	ExpNode * myExp;
+};
+
+class CallStmtNode : public StmtNode{
+public:
+	CallStmtNode(CallExpNode * callExpNode) : StmtNode(){
+		myCallExpNode = callExpNode;
+		rehash();
+	}
+	template <typename Sink> void render(Sink& out, int indent);
+	void exportTo(ASTExporter& exp, size_t parent);
+	void minify(Minifier& out);
+	void measure(MemoryReport& report);
+	const StmtCode * compile(ClosureCompiler& cc);
+	CallStmtNode * clone(ASTArena& arena);
+	NodeKind kind() const { return CALL_STMT_NODE; }
+	bool sameAs(ASTNode * other);
+	void children(std::vector<ASTNode *>& out);
+	void rehash(){ myHash = hashKids(CALL_STMT_NODE, {myCallExpNode}); }
+private:
+	CallExpNode * myCallExpNode;
 };
 
 } //End namespace LIL' C
@@ -0,0 +1,134 @@
+#include "ast.hpp"
+
+// children lists a node's kids in the order their text appears, for
+// walks that do not need a method of their own on every node. Leaves use
+// ASTNode's, which adds nothing.
+
+namespace LILC{
+
+void ProgramNode::children(std::vector<ASTNode *>& out){
+	out.push_back(myDeclList);
+}
+
+void DeclListNode::children(std::vector<ASTNode *>& out){
+	out.insert(out.end(), myDecls.begin(), myDecls.end());
+}
+
+void ExpListNode::children(std::vector<ASTNode *>& out){
+	out.insert(out.end(), myExpList.begin(), myExpList.end());
+}
+
+void VarDeclNode::children(std::vector<ASTNode *>& out){
+	out.push_back(myType);
+	out.push_back(myId);
+}
+
+void StructDeclNode::children(std::vector<ASTNode *>& out){
+	out.push_back(myId);
+	out.push_back(myDeclList);
+}
+
+void FormalDeclNode::children(std::vector<ASTNode *>& out){
+	out.push_back(myType);
+	out.push_back(myId);
+}
+
+void FormalsListNode::children(std::vector<ASTNode *>& out){
+	out.insert(out.end(), myFormalDeclList.begin(), myFormalDeclList.end());
+}
+
+void FnDeclNode::children(std::vector<ASTNode *>& out){
+	out.push_back(myType);
+	out.push_back(myId);
+	out.push_back(myFormalsList);
+	out.push_back(myFnBody);
+}
+
+void FnBodyNode::children(std::vector<ASTNode *>& out){
+	out.push_back(myDeclList);
+	out.push_back(myStmtList);
+}
+
+void StmtListNode::children(std::vector<ASTNode *>& out){
+	out.insert(out.end(), myStmtList.begin(), myStmtList.end());
+}
+
+void StructNode::children(std::vector<ASTNode *>& out){
+	out.push_back(myId);
+}
+
+void AssignStmtNode::children(std::vector<ASTNode *>& out){
+	out.push_back(myAssignNode);
+}
+
+void PostIncStmtNode::children(std::vector<ASTNode *>& out){
+	out.push_back(myExp);
+}
+
+void PostDecStmtNode::children(std::vector<ASTNode *>& out){
+	out.push_back(myExp);
+}
+
+void ReadStmtNode::children(std::vector<ASTNode *>& out){
+	out.push_back(myExp);
+}
+
+void WriteStmtNode::children(std::vector<ASTNode *>& out){
+	out.push_back(myExp);
+}
+
+void IfStmtNode::children(std::vector<ASTNode *>& out){
+	out.push_back(myExp);
+	out.push_back(myDeclList);
+	out.push_back(myStmtList);
+}
+
+void IfElseStmtNode::children(std::vector<ASTNode *>& out){
+	out.push_back(myExp);
+	out.push_back(myDeclList1);
+	out.push_back(myStmtList1);
+	out.push_back(myDeclList2);
+	out.push_back(myStmtList2);
+}
+
+void WhileStmtNode::children(std::vector<ASTNode *>& out){
+	out.push_back(myExp);
+	out.push_back(myDeclList);
+	out.push_back(myStmtList);
+}
+
+void CallStmtNode::children(std::vector<ASTNode *>& out){
+	out.push_back(myCallExpNode);
+}
+
+void ReturnStmtNode::children(std::vector<ASTNode *>& out){
+	if (myExp != nullptr){
+		out.push_back(myExp);
+	}
+}
+
+void AssignNode::children(std::vector<ASTNode *>& out){
+	out.push_back(myExpNode1);
+	out.push_back(myExpNode2);
+}
+
+void DotAccessNode::children(std::vector<ASTNode *>& out){
+	out.push_back(myExp);
+	out.push_back(myId);
+}
+
+void CallExpNode::children(std::vector<ASTNode *>& out){
+	out.push_back(myId);
+	out.push_back(myExpList);
+}
+
+void BinaryExpNode::children(std::vector<ASTNode *>& out){
+	out.push_back(myExp1);
+	out.push_back(myExp2);
+}
+
+void UnaryExpNode::children(std::vector<ASTNode *>& out){
+	out.push_back(myExp);
+}
+
+} /* end namespace */
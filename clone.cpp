@@ -0,0 +1,311 @@
+#include "ast.hpp"
+#include "lilc_arena.hpp"
+
+// clone copies each node with its implicit copy constructor, which keeps
+// its attributes, hash and any cached text, then points the copy at
+// clones of the children and makes itself their parent. Tokens behind
+// literals are immutable and stay shared.
+
+namespace LILC{
+
+ProgramNode * ProgramNode::clone(ASTArena& arena){
+	ProgramNode * copy = arena.make<ProgramNode>(*this);
+	copy->myDeclList = copy->adopt(myDeclList->clone(arena));
+	return copy;
+}
+
+DeclListNode * DeclListNode::clone(ASTArena& arena){
+	DeclListNode * copy = arena.make<DeclListNode>(*this);
+	for (DeclNode *& decl : copy->myDecls){
+		decl = copy->adopt(decl->clone(arena));
+	}
+	return copy;
+}
+
+ExpListNode * ExpListNode::clone(ASTArena& arena){
+	ExpListNode * copy = arena.make<ExpListNode>(*this);
+	for (ExpNode *& exp : copy->myExpList){
+		exp = copy->adopt(exp->clone(arena));
+	}
+	return copy;
+}
+
+VarDeclNode * VarDeclNode::clone(ASTArena& arena){
+	VarDeclNode * copy = arena.make<VarDeclNode>(*this);
+	copy->myType = copy->adopt(myType->clone(arena));
+	copy->myId = copy->adopt(myId->clone(arena));
+	return copy;
+}
+
+StructDeclNode * StructDeclNode::clone(ASTArena& arena){
+	StructDeclNode * copy = arena.make<StructDeclNode>(*this);
+	copy->myId = copy->adopt(myId->clone(arena));
+	copy->myDeclList = copy->adopt(myDeclList->clone(arena));
+	return copy;
+}
+
+FormalDeclNode * FormalDeclNode::clone(ASTArena& arena){
+	FormalDeclNode * copy = arena.make<FormalDeclNode>(*this);
+	copy->myType = copy->adopt(myType->clone(arena));
+	copy->myId = copy->adopt(myId->clone(arena));
+	return copy;
+}
+
+FormalsListNode * FormalsListNode::clone(ASTArena& arena){
+	FormalsListNode * copy = arena.make<FormalsListNode>(*this);
+	for (FormalDeclNode *& formal : copy->myFormalDeclList){
+		formal = copy->adopt(formal->clone(arena));
+	}
+	return copy;
+}
+
+FnDeclNode * FnDeclNode::clone(ASTArena& arena){
+	FnDeclNode * copy = arena.make<FnDeclNode>(*this);
+	copy->myType = copy->adopt(myType->clone(arena));
+	copy->myId = copy->adopt(myId->clone(arena));
+	copy->myFormalsList = copy->adopt(myFormalsList->clone(arena));
+	copy->myFnBody = copy->adopt(myFnBody->clone(arena));
+	return copy;
+}
+
+FnBodyNode * FnBodyNode::clone(ASTArena& arena){
+	FnBodyNode * copy = arena.make<FnBodyNode>(*this);
+	copy->myDeclList = copy->adopt(myDeclList->clone(arena));
+	copy->myStmtList = copy->adopt(myStmtList->clone(arena));
+	return copy;
+}
+
+StmtListNode * StmtListNode::clone(ASTArena& arena){
+	StmtListNode * copy = arena.make<StmtListNode>(*this);
+	for (StmtNode *& stmt : copy->myStmtList){
+		stmt = copy->adopt(stmt->clone(arena));
+	}
+	return copy;
+}
+
+IdNode * IdNode::clone(ASTArena& arena){
+	return arena.make<IdNode>(*this);
+}
+
+IntNode * IntNode::clone(ASTArena& arena){
+	return arena.make<IntNode>(*this);
+}
+
+BoolNode * BoolNode::clone(ASTArena& arena){
+	return arena.make<BoolNode>(*this);
+}
+
+VoidNode * VoidNode::clone(ASTArena& arena){
+	return arena.make<VoidNode>(*this);
+}
+
+StructNode * StructNode::clone(ASTArena& arena){
+	StructNode * copy = arena.make<StructNode>(*this);
+	copy->myId = copy->adopt(myId->clone(arena));
+	return copy;
+}
+
+AssignStmtNode * AssignStmtNode::clone(ASTArena& arena){
+	AssignStmtNode * copy = arena.make<AssignStmtNode>(*this);
+	copy->myAssignNode = copy->adopt(myAssignNode->clone(arena));
+	return copy;
+}
+
+PostIncStmtNode * PostIncStmtNode::clone(ASTArena& arena){
+	PostIncStmtNode * copy = arena.make<PostIncStmtNode>(*this);
+	copy->myExp = copy->adopt(myExp->clone(arena));
+	return copy;
+}
+
+PostDecStmtNode * PostDecStmtNode::clone(ASTArena& arena){
+	PostDecStmtNode * copy = arena.make<PostDecStmtNode>(*this);
+	copy->myExp = copy->adopt(myExp->clone(arena));
+	return copy;
+}
+
+ReadStmtNode * ReadStmtNode::clone(ASTArena& arena){
+	ReadStmtNode * copy = arena.make<ReadStmtNode>(*this);
+	copy->myExp = copy->adopt(myExp->clone(arena));
+	return copy;
+}
+
+WriteStmtNode * WriteStmtNode::clone(ASTArena& arena){
+	WriteStmtNode * copy = arena.make<WriteStmtNode>(*this);
+	copy->myExp = copy->adopt(myExp->clone(arena));
+	return copy;
+}
+
+IfStmtNode * IfStmtNode::clone(ASTArena& arena){
+	IfStmtNode * copy = arena.make<IfStmtNode>(*this);
+	copy->myExp = copy->adopt(myExp->clone(arena));
+	copy->myDeclList = copy->adopt(myDeclList->clone(arena));
+	copy->myStmtList = copy->adopt(myStmtList->clone(arena));
+	return copy;
+}
+
+IfElseStmtNode * IfElseStmtNode::clone(ASTArena& arena){
+	IfElseStmtNode * copy = arena.make<IfElseStmtNode>(*this);
+	copy->myExp = copy->adopt(myExp->clone(arena));
+	copy->myDeclList1 = copy->adopt(myDeclList1->clone(arena));
+	copy->myStmtList1 = copy->adopt(myStmtList1->clone(arena));
+	copy->myDeclList2 = copy->adopt(myDeclList2->clone(arena));
+	copy->myStmtList2 = copy->adopt(myStmtList2->clone(arena));
+	return copy;
+}
+
+WhileStmtNode * WhileStmtNode::clone(ASTArena& arena){
+	WhileStmtNode * copy = arena.make<WhileStmtNode>(*this);
+	copy->myExp = copy->adopt(myExp->clone(arena));
+	copy->myDeclList = copy->adopt(myDeclList->clone(arena));
+	copy->myStmtList = copy->adopt(myStmtList->clone(arena));
+	return copy;
+}
+
+CallStmtNode * CallStmtNode::clone(ASTArena& arena){
+	CallStmtNode * copy = arena.make<CallStmtNode>(*this);
+	copy->myCallExpNode = copy->adopt(myCallExpNode->clone(arena));
+	return copy;
+}
+
+ReturnStmtNode * ReturnStmtNode::clone(ASTArena& arena){
+	ReturnStmtNode * copy = arena.make<ReturnStmtNode>(*this);
+	if (myExp != nullptr){
+		copy->myExp = copy->adopt(myExp->clone(arena));
+	}
+	return copy;
+}
+
+AssignNode * AssignNode::clone(ASTArena& arena){
+	AssignNode * copy = arena.make<AssignNode>(*this);
+	copy->myExpNode1 = copy->adopt(myExpNode1->clone(arena));
+	copy->myExpNode2 = copy->adopt(myExpNode2->clone(arena));
+	return copy;
+}
+
+DotAccessNode * DotAccessNode::clone(ASTArena& arena){
+	DotAccessNode * copy = arena.make<DotAccessNode>(*this);
+	copy->myExp = copy->adopt(myExp->clone(arena));
+	copy->myId = copy->adopt(myId->clone(arena));
+	return copy;
+}
+
+CallExpNode * CallExpNode::clone(ASTArena& arena){
+	CallExpNode * copy = arena.make<CallExpNode>(*this);
+	copy->myId = copy->adopt(myId->clone(arena));
+	copy->myExpList = copy->adopt(myExpList->clone(arena));
+	return copy;
+}
+
+IntLitNode * IntLitNode::clone(ASTArena& arena){
+	return arena.make<IntLitNode>(*this);
+}
+
+StrLitNode * StrLitNode::clone(ASTArena& arena){
+	return arena.make<StrLitNode>(*this);
+}
+
+TrueNode * TrueNode::clone(ASTArena& arena){
+	return arena.make<TrueNode>(*this);
+}
+
+FalseNode * FalseNode::clone(ASTArena& arena){
+	return arena.make<FalseNode>(*this);
+}
+
+PlusNode * PlusNode::clone(ASTArena& arena){
+	PlusNode * copy = arena.make<PlusNode>(*this);
+	copy->myExp1 = copy->adopt(myExp1->clone(arena));
+	copy->myExp2 = copy->adopt(myExp2->clone(arena));
+	return copy;
+}
+
+MinusNode * MinusNode::clone(ASTArena& arena){
+	MinusNode * copy = arena.make<MinusNode>(*this);
+	copy->myExp1 = copy->adopt(myExp1->clone(arena));
+	copy->myExp2 = copy->adopt(myExp2->clone(arena));
+	return copy;
+}
+
+TimesNode * TimesNode::clone(ASTArena& arena){
+	TimesNode * copy = arena.make<TimesNode>(*this);
+	copy->myExp1 = copy->adopt(myExp1->clone(arena));
+	copy->myExp2 = copy->adopt(myExp2->clone(arena));
+	return copy;
+}
+
+DivideNode * DivideNode::clone(ASTArena& arena){
+	DivideNode * copy = arena.make<DivideNode>(*this);
+	copy->myExp1 = copy->adopt(myExp1->clone(arena));
+	copy->myExp2 = copy->adopt(myExp2->clone(arena));
+	return copy;
+}
+
+AndNode * AndNode::clone(ASTArena& arena){
+	AndNode * copy = arena.make<AndNode>(*this);
+	copy->myExp1 = copy->adopt(myExp1->clone(arena));
+	copy->myExp2 = copy->adopt(myExp2->clone(arena));
+	return copy;
+}
+
+OrNode * OrNode::clone(ASTArena& arena){
+	OrNode * copy = arena.make<OrNode>(*this);
+	copy->myExp1 = copy->adopt(myExp1->clone(arena));
+	copy->myExp2 = copy->adopt(myExp2->clone(arena));
+	return copy;
+}
+
+EqualsNode * EqualsNode::clone(ASTArena& arena){
+	EqualsNode * copy = arena.make<EqualsNode>(*this);
+	copy->myExp1 = copy->adopt(myExp1->clone(arena));
+	copy->myExp2 = copy->adopt(myExp2->clone(arena));
+	return copy;
+}
+
+NotEqualsNode * NotEqualsNode::clone(ASTArena& arena){
+	NotEqualsNode * copy = arena.make<NotEqualsNode>(*this);
+	copy->myExp1 = copy->adopt(myExp1->clone(arena));
+	copy->myExp2 = copy->adopt(myExp2->clone(arena));
+	return copy;
+}
+
+LessNode * LessNode::clone(ASTArena& arena){
+	LessNode * copy = arena.make<LessNode>(*this);
+	copy->myExp1 = copy->adopt(myExp1->clone(arena));
+	copy->myExp2 = copy->adopt(myExp2->clone(arena));
+	return copy;
+}
+
+GreaterNode * GreaterNode::clone(ASTArena& arena){
+	GreaterNode * copy = arena.make<GreaterNode>(*this);
+	copy->myExp1 = copy->adopt(myExp1->clone(arena));
+	copy->myExp2 = copy->adopt(myExp2->clone(arena));
+	return copy;
+}
+
+LessEqNode * LessEqNode::clone(ASTArena& arena){
+	LessEqNode * copy = arena.make<LessEqNode>(*this);
+	copy->myExp1 = copy->adopt(myExp1->clone(arena));
+	copy->myExp2 = copy->adopt(myExp2->clone(arena));
+	return copy;
+}
+
+GreaterEqNode * GreaterEqNode::clone(ASTArena& arena){
+	GreaterEqNode * copy = arena.make<GreaterEqNode>(*this);
+	copy->myExp1 = copy->adopt(myExp1->clone(arena));
+	copy->myExp2 = copy->adopt(myExp2->clone(arena));
+	return copy;
+}
+
+NotNode * NotNode::clone(ASTArena& arena){
+	NotNode * copy = arena.make<NotNode>(*this);
+	copy->myExp = copy->adopt(myExp->clone(arena));
+	return copy;
+}
+
+UnaryMinusNode * UnaryMinusNode::clone(ASTArena& arena){
+	UnaryMinusNode * copy = arena.make<UnaryMinusNode>(*this);
+	copy->myExp = copy->adopt(myExp->clone(arena));
+	return copy;
+}
+
+} // End namespace LIL' C
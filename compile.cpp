@@ -0,0 +1,208 @@
+#include "ast.hpp"
+#include "lilc_engine.hpp"
+
+// compile turns each node into records for the closure-compiled engine,
+// see lilc_engine.hpp. Declarations and types go straight to the
+// ClosureCompiler; expressions and statements hand it the code of their
+// children to combine.
+
+namespace LILC{
+
+// Each block has a scope of its own, whose locals are zeroed on entry
+static const StmtCode * compileBlock(ClosureCompiler& cc,
+	DeclListNode * decls, StmtListNode * stmts){
+	cc.beginScope();
+	decls->compile(cc);
+	return cc.endScope(stmts->compile(cc));
+}
+
+void ProgramNode::compile(ClosureCompiler& cc){
+	myDeclList->compile(cc);
+}
+
+void DeclListNode::compile(ClosureCompiler& cc){
+	for (DeclNode * decl : myDecls){
+		decl->compile(cc);
+	}
+}
+
+void ExpListNode::compile(ClosureCompiler& cc, std::vector<Typed>& out){
+	for (ExpNode * exp : myExpList){
+		out.push_back(exp->compile(cc));
+	}
+}
+
+void VarDeclNode::compile(ClosureCompiler& cc){
+	if (cc.declaring()){
+		cc.declareVariable(myId, myType->compile(cc));
+	}
+}
+
+void StructDeclNode::compile(ClosureCompiler& cc){
+	if (cc.declaring()){
+		cc.beginStruct(myId);
+		myDeclList->compile(cc);
+		cc.endStruct();
+	}
+}
+
+void FormalDeclNode::compile(ClosureCompiler& cc){
+	cc.declareFormal(myId, myType->compile(cc));
+}
+
+void FormalsListNode::compile(ClosureCompiler& cc){
+	for (FormalDeclNode * formal : myFormalDeclList){
+		formal->compile(cc);
+	}
+}
+
+// The signature in the DECLARE pass, the body in the DEFINE pass
+void FnDeclNode::compile(ClosureCompiler& cc){
+	cc.beginFunction(myId, myType->compile(cc));
+	myFormalsList->compile(cc);
+	if (cc.pass() == ClosureCompiler::DEFINE){
+		cc.endFunction(myFnBody->compile(cc));
+	} else {
+		cc.endFunction(nullptr);
+	}
+}
+
+// The body's locals share the formals' scope
+const StmtCode * FnBodyNode::compile(ClosureCompiler& cc){
+	myDeclList->compile(cc);
+	return myStmtList->compile(cc);
+}
+
+ValueType IntNode::compile(ClosureCompiler& cc){
+	return ValueType{ INT_TYPE, nullptr };
+}
+
+ValueType BoolNode::compile(ClosureCompiler& cc){
+	return ValueType{ BOOL_TYPE, nullptr };
+}
+
+ValueType VoidNode::compile(ClosureCompiler& cc){
+	return ValueType{ VOID_TYPE, nullptr };
+}
+
+ValueType StructNode::compile(ClosureCompiler& cc){
+	return cc.structType(myId);
+}
+
+const StmtCode * StmtListNode::compile(ClosureCompiler& cc){
+	std::vector<const StmtCode *> stmts;
+	stmts.reserve(myStmtList.size());
+	for (StmtNode * stmt : myStmtList){
+		stmts.push_back(stmt->compile(cc));
+	}
+	return cc.sequence(stmts);
+}
+
+const StmtCode * AssignStmtNode::compile(ClosureCompiler& cc){
+	return cc.evaluate(myAssignNode->compile(cc));
+}
+
+const StmtCode * PostIncStmtNode::compile(ClosureCompiler& cc){
+	return cc.step(myExp->locate(cc), 1, this);
+}
+
+const StmtCode * PostDecStmtNode::compile(ClosureCompiler& cc){
+	return cc.step(myExp->locate(cc), -1, this);
+}
+
+const StmtCode * ReadStmtNode::compile(ClosureCompiler& cc){
+	return cc.read(myExp->locate(cc), this);
+}
+
+const StmtCode * WriteStmtNode::compile(ClosureCompiler& cc){
+	return cc.write(myExp->compile(cc), this);
+}
+
+const StmtCode * IfStmtNode::compile(ClosureCompiler& cc){
+	Typed cond = myExp->compile(cc);
+	return cc.branch(cond, compileBlock(cc, myDeclList, myStmtList),
+		nullptr, this);
+}
+
+const StmtCode * IfElseStmtNode::compile(ClosureCompiler& cc){
+	Typed cond = myExp->compile(cc);
+	const StmtCode * then = compileBlock(cc, myDeclList1, myStmtList1);
+	return cc.branch(cond, then,
+		compileBlock(cc, myDeclList2, myStmtList2), this);
+}
+
+const StmtCode * WhileStmtNode::compile(ClosureCompiler& cc){
+	Typed cond = myExp->compile(cc);
+	return cc.loop(cond, compileBlock(cc, myDeclList, myStmtList), this);
+}
+
+const StmtCode * ReturnStmtNode::compile(ClosureCompiler& cc){
+	if (myExp == nullptr){
+		return cc.returnVoid(this);
+	}
+	return cc.returnValue(myExp->compile(cc), this);
+}
+
+const StmtCode * CallStmtNode::compile(ClosureCompiler& cc){
+	return cc.evaluate(myCallExpNode->compile(cc));
+}
+
+// Only ids and field accesses are locations, which the grammar ensures
+Place ExpNode::locate(ClosureCompiler& cc){
+	cc.error(this, "Not a location");
+	return Place{ NOWHERE, 0, ValueType{ ERROR_TYPE, nullptr } };
+}
+
+Typed IdNode::compile(ClosureCompiler& cc){
+	return cc.load(locate(cc));
+}
+
+Place IdNode::locate(ClosureCompiler& cc){
+	return cc.variable(this);
+}
+
+Typed DotAccessNode::compile(ClosureCompiler& cc){
+	return cc.load(locate(cc));
+}
+
+Place DotAccessNode::locate(ClosureCompiler& cc){
+	return cc.field(myExp->locate(cc), myId);
+}
+
+Typed AssignNode::compile(ClosureCompiler& cc){
+	Place place = myExpNode1->locate(cc);
+	return cc.assign(place, myExpNode2->compile(cc), this);
+}
+
+Typed CallExpNode::compile(ClosureCompiler& cc){
+	std::vector<Typed> args;
+	myExpList->compile(cc, args);
+	return cc.call(myId, args, this);
+}
+
+Typed IntLitNode::compile(ClosureCompiler& cc){
+	return cc.constant(myIntLit->value(), INT_TYPE);
+}
+
+Typed StrLitNode::compile(ClosureCompiler& cc){
+	return cc.string(myStringLit->value());
+}
+
+Typed TrueNode::compile(ClosureCompiler& cc){
+	return cc.constant(1, BOOL_TYPE);
+}
+
+Typed FalseNode::compile(ClosureCompiler& cc){
+	return cc.constant(0, BOOL_TYPE);
+}
+
+Typed UnaryExpNode::compile(ClosureCompiler& cc){
+	return cc.unary(kind(), myExp->compile(cc), this);
+}
+
+Typed BinaryExpNode::compile(ClosureCompiler& cc){
+	Typed left = myExp1->compile(cc);
+	return cc.binary(kind(), left, myExp2->compile(cc), this);
+}
+
+} // End namespace LIL' C
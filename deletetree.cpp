@@ -0,0 +1,22 @@
+#include "ast.hpp"
+
+// deleteTree frees a tree the parser allocated. The parser nests nodes as
+// deep as the input does (a chain of a million ifs is a million levels),
+// so rather than recursing it keeps the nodes still to free on a list of
+// its own: each node taken off it puts its children (see children.cpp)
+// on it, then is deleted. Tokens behind literals belong to whoever
+// scanned them (see IncrementalDocument).
+
+namespace LILC{
+
+void ASTNode::deleteTree(){
+	std::vector<ASTNode *> pending(1, this);
+	while (!pending.empty()){
+		ASTNode * node = pending.back();
+		pending.pop_back();
+		node->children(pending);
+		delete node;
+	}
+}
+
+} /* end namespace */
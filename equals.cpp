@@ -0,0 +1,209 @@
+#include "ast.hpp"
+
+// sameAs backs ASTNode::equals: it is only called once the hashes and
+// kinds already agree, and compares attributes and children in order so
+// that the first difference ends the walk. Source offsets are not part
+// of the structure.
+
+namespace LILC{
+
+template <typename T>
+static bool sameList(const std::list<T *>& mine, const std::list<T *>& theirs){
+	if (mine.size() != theirs.size()){
+		return false;
+	}
+	typename std::list<T *>::const_iterator it = theirs.begin();
+	for (T * node : mine){
+		if (!node->equals(*it++)){
+			return false;
+		}
+	}
+	return true;
+}
+
+bool ProgramNode::sameAs(ASTNode * other){
+	ProgramNode * that = static_cast<ProgramNode *>(other);
+	return myDeclList->equals(that->myDeclList);
+}
+
+bool DeclListNode::sameAs(ASTNode * other){
+	DeclListNode * that = static_cast<DeclListNode *>(other);
+	return sameList(myDecls, that->myDecls);
+}
+
+bool ExpListNode::sameAs(ASTNode * other){
+	ExpListNode * that = static_cast<ExpListNode *>(other);
+	return sameList(myExpList, that->myExpList);
+}
+
+bool VarDeclNode::sameAs(ASTNode * other){
+	VarDeclNode * that = static_cast<VarDeclNode *>(other);
+	return mySize == that->mySize
+		&& myType->equals(that->myType)
+		&& myId->equals(that->myId);
+}
+
+bool StructDeclNode::sameAs(ASTNode * other){
+	StructDeclNode * that = static_cast<StructDeclNode *>(other);
+	return myId->equals(that->myId)
+		&& myDeclList->equals(that->myDeclList);
+}
+
+bool FormalDeclNode::sameAs(ASTNode * other){
+	FormalDeclNode * that = static_cast<FormalDeclNode *>(other);
+	return myType->equals(that->myType)
+		&& myId->equals(that->myId);
+}
+
+bool FormalsListNode::sameAs(ASTNode * other){
+	FormalsListNode * that = static_cast<FormalsListNode *>(other);
+	return sameList(myFormalDeclList, that->myFormalDeclList);
+}
+
+bool FnDeclNode::sameAs(ASTNode * other){
+	FnDeclNode * that = static_cast<FnDeclNode *>(other);
+	return myType->equals(that->myType)
+		&& myId->equals(that->myId)
+		&& myFormalsList->equals(that->myFormalsList)
+		&& myFnBody->equals(that->myFnBody);
+}
+
+bool FnBodyNode::sameAs(ASTNode * other){
+	FnBodyNode * that = static_cast<FnBodyNode *>(other);
+	return myDeclList->equals(that->myDeclList)
+		&& myStmtList->equals(that->myStmtList);
+}
+
+bool StmtListNode::sameAs(ASTNode * other){
+	StmtListNode * that = static_cast<StmtListNode *>(other);
+	return sameList(myStmtList, that->myStmtList);
+}
+
+bool IdNode::sameAs(ASTNode * other){
+	IdNode * that = static_cast<IdNode *>(other);
+	return myStrVal == that->myStrVal;
+}
+
+bool IntNode::sameAs(ASTNode * other){
+	return true;
+}
+
+bool BoolNode::sameAs(ASTNode * other){
+	return true;
+}
+
+bool VoidNode::sameAs(ASTNode * other){
+	return true;
+}
+
+bool StructNode::sameAs(ASTNode * other){
+	StructNode * that = static_cast<StructNode *>(other);
+	return myId->equals(that->myId);
+}
+
+bool AssignStmtNode::sameAs(ASTNode * other){
+	AssignStmtNode * that = static_cast<AssignStmtNode *>(other);
+	return myAssignNode->equals(that->myAssignNode);
+}
+
+bool PostIncStmtNode::sameAs(ASTNode * other){
+	PostIncStmtNode * that = static_cast<PostIncStmtNode *>(other);
+	return myExp->equals(that->myExp);
+}
+
+bool PostDecStmtNode::sameAs(ASTNode * other){
+	PostDecStmtNode * that = static_cast<PostDecStmtNode *>(other);
+	return myExp->equals(that->myExp);
+}
+
+bool ReadStmtNode::sameAs(ASTNode * other){
+	ReadStmtNode * that = static_cast<ReadStmtNode *>(other);
+	return myExp->equals(that->myExp);
+}
+
+bool WriteStmtNode::sameAs(ASTNode * other){
+	WriteStmtNode * that = static_cast<WriteStmtNode *>(other);
+	return myExp->equals(that->myExp);
+}
+
+bool IfStmtNode::sameAs(ASTNode * other){
+	IfStmtNode * that = static_cast<IfStmtNode *>(other);
+	return myExp->equals(that->myExp)
+		&& myDeclList->equals(that->myDeclList)
+		&& myStmtList->equals(that->myStmtList);
+}
+
+bool IfElseStmtNode::sameAs(ASTNode * other){
+	IfElseStmtNode * that = static_cast<IfElseStmtNode *>(other);
+	return myExp->equals(that->myExp)
+		&& myDeclList1->equals(that->myDeclList1)
+		&& myStmtList1->equals(that->myStmtList1)
+		&& myDeclList2->equals(that->myDeclList2)
+		&& myStmtList2->equals(that->myStmtList2);
+}
+
+bool WhileStmtNode::sameAs(ASTNode * other){
+	WhileStmtNode * that = static_cast<WhileStmtNode *>(other);
+	return myExp->equals(that->myExp)
+		&& myDeclList->equals(that->myDeclList)
+		&& myStmtList->equals(that->myStmtList);
+}
+
+bool CallStmtNode::sameAs(ASTNode * other){
+	CallStmtNode * that = static_cast<CallStmtNode *>(other);
+	return myCallExpNode->equals(that->myCallExpNode);
+}
+
+bool ReturnStmtNode::sameAs(ASTNode * other){
+	ReturnStmtNode * that = static_cast<ReturnStmtNode *>(other);
+	return equal(myExp, that->myExp);
+}
+
+bool AssignNode::sameAs(ASTNode * other){
+	AssignNode * that = static_cast<AssignNode *>(other);
+	return myExpNode1->equals(that->myExpNode1)
+		&& myExpNode2->equals(that->myExpNode2);
+}
+
+bool DotAccessNode::sameAs(ASTNode * other){
+	DotAccessNode * that = static_cast<DotAccessNode *>(other);
+	return myExp->equals(that->myExp)
+		&& myId->equals(that->myId);
+}
+
+bool CallExpNode::sameAs(ASTNode * other){
+	CallExpNode * that = static_cast<CallExpNode *>(other);
+	return myId->equals(that->myId)
+		&& myExpList->equals(that->myExpList);
+}
+
+bool IntLitNode::sameAs(ASTNode * other){
+	IntLitNode * that = static_cast<IntLitNode *>(other);
+	return myIntLit->value() == that->myIntLit->value();
+}
+
+bool StrLitNode::sameAs(ASTNode * other){
+	StrLitNode * that = static_cast<StrLitNode *>(other);
+	return myStringLit->value() == that->myStringLit->value();
+}
+
+bool TrueNode::sameAs(ASTNode * other){
+	return true;
+}
+
+bool FalseNode::sameAs(ASTNode * other){
+	return true;
+}
+
+bool BinaryExpNode::sameAs(ASTNode * other){
+	BinaryExpNode * that = static_cast<BinaryExpNode *>(other);
+	return myExp1->equals(that->myExp1)
+		&& myExp2->equals(that->myExp2);
+}
+
+bool UnaryExpNode::sameAs(ASTNode * other){
+	UnaryExpNode * that = static_cast<UnaryExpNode *>(other);
+	return myExp->equals(that->myExp);
+}
+
+} // End namespace LIL' C
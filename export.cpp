@@ -0,0 +1,276 @@
+#include "ast.hpp"
+#include "lilc_export.hpp"
+
+// exportTo writes a node's record and then its children's, see
+// lilc_export.hpp for the formats.
+
+namespace LILC{
+
+void ProgramNode::exportTo(ASTExporter& exp, size_t parent){
+	size_t id = exp.node(PROGRAM_NODE, parent, mySpan);
+	myDeclList->exportTo(exp, id);
+}
+
+void DeclListNode::exportTo(ASTExporter& exp, size_t parent){
+	size_t id = exp.node(DECL_LIST_NODE, parent, mySpan);
+	for (std::list<DeclNode *>::iterator it=myDecls.begin();
+		it != myDecls.end(); ++it){
+		(*it)->exportTo(exp, id);
+	}
+}
+
+void VarDeclNode::exportTo(ASTExporter& exp, size_t parent){
+	size_t id = mySize == NOT_STRUCT ? exp.node(VAR_DECL_NODE, parent, mySpan)
+		: exp.sized(VAR_DECL_NODE, parent, mySize, mySpan);
+	myType->exportTo(exp, id);
+	myId->exportTo(exp, id);
+}
+
+void IdNode::exportTo(ASTExporter& exp, size_t parent){
+	exp.name(ID_NODE, parent, myStrVal, mySpan);
+}
+
+void IntNode::exportTo(ASTExporter& exp, size_t parent){
+	exp.node(INT_NODE, parent, mySpan);
+}
+
+void BoolNode::exportTo(ASTExporter& exp, size_t parent){
+	exp.node(BOOL_NODE, parent, mySpan);
+}
+
+void VoidNode::exportTo(ASTExporter& exp, size_t parent){
+	exp.node(VOID_NODE, parent, mySpan);
+}
+
+void StructDeclNode::exportTo(ASTExporter& exp, size_t parent){
+	size_t id = exp.node(STRUCT_DECL_NODE, parent, mySpan);
+	myId->exportTo(exp, id);
+	myDeclList->exportTo(exp, id);
+}
+
+void StructNode::exportTo(ASTExporter& exp, size_t parent){
+	size_t id = exp.node(STRUCT_NODE, parent, mySpan);
+	myId->exportTo(exp, id);
+}
+
+void FnDeclNode::exportTo(ASTExporter& exp, size_t parent){
+	size_t id = exp.node(FN_DECL_NODE, parent, mySpan);
+	myType->exportTo(exp, id);
+	myId->exportTo(exp, id);
+	myFormalsList->exportTo(exp, id);
+	myFnBody->exportTo(exp, id);
+}
+
+void FormalDeclNode::exportTo(ASTExporter& exp, size_t parent){
+	size_t id = exp.node(FORMAL_DECL_NODE, parent, mySpan);
+	myType->exportTo(exp, id);
+	myId->exportTo(exp, id);
+}
+
+void FormalsListNode::exportTo(ASTExporter& exp, size_t parent){
+	size_t id = exp.node(FORMALS_LIST_NODE, parent, mySpan);
+	for (std::list<FormalDeclNode *>::iterator it=myFormalDeclList.begin();
+		it != myFormalDeclList.end(); ++it){
+		(*it)->exportTo(exp, id);
+	}
+}
+
+void FnBodyNode::exportTo(ASTExporter& exp, size_t parent){
+	size_t id = exp.node(FN_BODY_NODE, parent, mySpan);
+	myDeclList->exportTo(exp, id);
+	myStmtList->exportTo(exp, id);
+}
+
+void StmtListNode::exportTo(ASTExporter& exp, size_t parent){
+	size_t id = exp.node(STMT_LIST_NODE, parent, mySpan);
+	for (std::list<StmtNode *>::iterator it=myStmtList.begin();
+		it != myStmtList.end(); ++it){
+		(*it)->exportTo(exp, id);
+	}
+}
+
+void ExpListNode::exportTo(ASTExporter& exp, size_t parent){
+	size_t id = exp.node(EXP_LIST_NODE, parent, mySpan);
+	for (std::list<ExpNode *>::iterator it=myExpList.begin();
+		it != myExpList.end(); ++it){
+		(*it)->exportTo(exp, id);
+	}
+}
+
+void AssignStmtNode::exportTo(ASTExporter& exp, size_t parent){
+	size_t id = exp.node(ASSIGN_STMT_NODE, parent, mySpan);
+	myAssignNode->exportTo(exp, id);
+}
+
+void PostIncStmtNode::exportTo(ASTExporter& exp, size_t parent){
+	size_t id = exp.node(POST_INC_STMT_NODE, parent, mySpan);
+	myExp->exportTo(exp, id);
+}
+
+void PostDecStmtNode::exportTo(ASTExporter& exp, size_t parent){
+	size_t id = exp.node(POST_DEC_STMT_NODE, parent, mySpan);
+	myExp->exportTo(exp, id);
+}
+
+void ReadStmtNode::exportTo(ASTExporter& exp, size_t parent){
+	size_t id = exp.node(READ_STMT_NODE, parent, mySpan);
+	myExp->exportTo(exp, id);
+}
+
+void WriteStmtNode::exportTo(ASTExporter& exp, size_t parent){
+	size_t id = exp.node(WRITE_STMT_NODE, parent, mySpan);
+	myExp->exportTo(exp, id);
+}
+
+void IfStmtNode::exportTo(ASTExporter& exp, size_t parent){
+	size_t id = exp.node(IF_STMT_NODE, parent, mySpan);
+	myExp->exportTo(exp, id);
+	myDeclList->exportTo(exp, id);
+	myStmtList->exportTo(exp, id);
+}
+
+void IfElseStmtNode::exportTo(ASTExporter& exp, size_t parent){
+	size_t id = exp.node(IF_ELSE_STMT_NODE, parent, mySpan);
+	myExp->exportTo(exp, id);
+	myDeclList1->exportTo(exp, id);
+	myStmtList1->exportTo(exp, id);
+	myDeclList2->exportTo(exp, id);
+	myStmtList2->exportTo(exp, id);
+}
+
+void WhileStmtNode::exportTo(ASTExporter& exp, size_t parent){
+	size_t id = exp.node(WHILE_STMT_NODE, parent, mySpan);
+	myExp->exportTo(exp, id);
+	myDeclList->exportTo(exp, id);
+	myStmtList->exportTo(exp, id);
+}
+
+void CallStmtNode::exportTo(ASTExporter& exp, size_t parent){
+	size_t id = exp.node(CALL_STMT_NODE, parent, mySpan);
+	myCallExpNode->exportTo(exp, id);
+}
+
+void ReturnStmtNode::exportTo(ASTExporter& exp, size_t parent){
+	size_t id = exp.node(RETURN_STMT_NODE, parent, mySpan);
+	if (myExp != nullptr){
+		myExp->exportTo(exp, id);
+	}
+}
+
+void IntLitNode::exportTo(ASTExporter& exp, size_t parent){
+	exp.intValue(INT_LIT_NODE, parent, myIntLit->value(), mySpan);
+}
+
+void StrLitNode::exportTo(ASTExporter& exp, size_t parent){
+	exp.stringValue(STR_LIT_NODE, parent, myStringLit->value(), mySpan);
+}
+
+void TrueNode::exportTo(ASTExporter& exp, size_t parent){
+	exp.node(TRUE_NODE, parent, mySpan);
+}
+
+void FalseNode::exportTo(ASTExporter& exp, size_t parent){
+	exp.node(FALSE_NODE, parent, mySpan);
+}
+
+void DotAccessNode::exportTo(ASTExporter& exp, size_t parent){
+	size_t id = exp.node(DOT_ACCESS_NODE, parent, mySpan);
+	myExp->exportTo(exp, id);
+	myId->exportTo(exp, id);
+}
+
+void AssignNode::exportTo(ASTExporter& exp, size_t parent){
+	size_t id = exp.node(ASSIGN_NODE, parent, mySpan);
+	myExpNode1->exportTo(exp, id);
+	myExpNode2->exportTo(exp, id);
+}
+
+void CallExpNode::exportTo(ASTExporter& exp, size_t parent){
+	size_t id = exp.node(CALL_EXP_NODE, parent, mySpan);
+	myId->exportTo(exp, id);
+	myExpList->exportTo(exp, id);
+}
+
+void UnaryMinusNode::exportTo(ASTExporter& exp, size_t parent){
+	size_t id = exp.node(UNARY_MINUS_NODE, parent, mySpan);
+	myExp->exportTo(exp, id);
+}
+
+void NotNode::exportTo(ASTExporter& exp, size_t parent){
+	size_t id = exp.node(NOT_NODE, parent, mySpan);
+	myExp->exportTo(exp, id);
+}
+
+void PlusNode::exportTo(ASTExporter& exp, size_t parent){
+	size_t id = exp.node(PLUS_NODE, parent, mySpan);
+	myExp1->exportTo(exp, id);
+	myExp2->exportTo(exp, id);
+}
+
+void MinusNode::exportTo(ASTExporter& exp, size_t parent){
+	size_t id = exp.node(MINUS_NODE, parent, mySpan);
+	myExp1->exportTo(exp, id);
+	myExp2->exportTo(exp, id);
+}
+
+void TimesNode::exportTo(ASTExporter& exp, size_t parent){
+	size_t id = exp.node(TIMES_NODE, parent, mySpan);
+	myExp1->exportTo(exp, id);
+	myExp2->exportTo(exp, id);
+}
+
+void DivideNode::exportTo(ASTExporter& exp, size_t parent){
+	size_t id = exp.node(DIVIDE_NODE, parent, mySpan);
+	myExp1->exportTo(exp, id);
+	myExp2->exportTo(exp, id);
+}
+
+void AndNode::exportTo(ASTExporter& exp, size_t parent){
+	size_t id = exp.node(AND_NODE, parent, mySpan);
+	myExp1->exportTo(exp, id);
+	myExp2->exportTo(exp, id);
+}
+
+void OrNode::exportTo(ASTExporter& exp, size_t parent){
+	size_t id = exp.node(OR_NODE, parent, mySpan);
+	myExp1->exportTo(exp, id);
+	myExp2->exportTo(exp, id);
+}
+
+void EqualsNode::exportTo(ASTExporter& exp, size_t parent){
+	size_t id = exp.node(EQUALS_NODE, parent, mySpan);
+	myExp1->exportTo(exp, id);
+	myExp2->exportTo(exp, id);
+}
+
+void NotEqualsNode::exportTo(ASTExporter& exp, size_t parent){
+	size_t id = exp.node(NOT_EQUALS_NODE, parent, mySpan);
+	myExp1->exportTo(exp, id);
+	myExp2->exportTo(exp, id);
+}
+
+void LessNode::exportTo(ASTExporter& exp, size_t parent){
+	size_t id = exp.node(LESS_NODE, parent, mySpan);
+	myExp1->exportTo(exp, id);
+	myExp2->exportTo(exp, id);
+}
+
+void GreaterNode::exportTo(ASTExporter& exp, size_t parent){
+	size_t id = exp.node(GREATER_NODE, parent, mySpan);
+	myExp1->exportTo(exp, id);
+	myExp2->exportTo(exp, id);
+}
+
+void LessEqNode::exportTo(ASTExporter& exp, size_t parent){
+	size_t id = exp.node(LESS_EQ_NODE, parent, mySpan);
+	myExp1->exportTo(exp, id);
+	myExp2->exportTo(exp, id);
+}
+
+void GreaterEqNode::exportTo(ASTExporter& exp, size_t parent){
+	size_t id = exp.node(GREATER_EQ_NODE, parent, mySpan);
+	myExp1->exportTo(exp, id);
+	myExp2->exportTo(exp, id);
+}
+
+} // End namespace LIL' C
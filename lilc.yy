@@ -4,6 +4,8 @@
 %defines
 %define api.namespace {LILC}
 %define parser_class_name {LilC_Parser}
+%locations
+%define api.location.type {LILC::Span}
 %output "lilc_parser.cc"
 %token-table
 
@@ -14,6 +16,10 @@
    namespace LILC {
       class LilC_Compiler;
       class LilC_Scanner;
+
+      inline std::ostream & operator<<(std::ostream &out, const Span &span){
+         return out << span.offset << "+" << span.length;
+      }
    }
 
 // The following definitions is missing when %locations isn't used
@@ -37,9 +43,46 @@
 
    /* include for interoperation between scanner/parser */
    #include "lilc_compiler.hpp"
+   #include "lilc_profile.hpp"
+   #include "lilc_selfprofile.hpp"
+   #include "lilc_probes.hpp"
 
 #undef yylex
 #define yylex scanner.yylex
+
+/* A span runs from the start of the first symbol to the end of the last;
+ * an empty production gets an empty span where its predecessor ends.
+ * Bison expands this for every reduction, just after picking its rule
+ * (yyn), so it also counts reductions for --profile and notes how far
+ * the parse has got (the end of the span) for --self-profile. */
+#define YYLLOC_DEFAULT(Cur, Rhs, N)                                        \
+   do {                                                                  \
+      if (N){                                                            \
+         (Cur).offset = YYRHSLOC(Rhs, 1).offset;                         \
+         (Cur).length = YYRHSLOC(Rhs, N).offset                          \
+            + YYRHSLOC(Rhs, N).length - (Cur).offset;                    \
+      } else {                                                           \
+         (Cur).offset = YYRHSLOC(Rhs, 0).offset + YYRHSLOC(Rhs, 0).length; \
+         (Cur).length = 0;                                               \
+      }                                                                  \
+      LILC::SelfProfiler::at((Cur).offset + (Cur).length);               \
+      if (LILC::Profile::active() != nullptr){                           \
+         LILC::Profile::active()->reduction(yyn, yyrline_[yyn],          \
+            yytname_[yyr1_[yyn]]);                                       \
+      }                                                                  \
+   } while (0)
+
+   // Stamps node with the source bytes of the production that built it.
+   template <typename T>
+   static T * spanned(T * node, const LILC::Span &span){
+      node->setSpan(span);
+      return node;
+   }
+
+   static LILC::Span through(const LILC::Span &first, const LILC::Span &last){
+      return LILC::makeSpan(first.offset,
+         last.offset + last.length - first.offset);
+   }
 }
 
 /*%define api.value.type variant*/
@@ -151,6 +194,16 @@
 %type <expListNode> actualList
 %type <callExpNode> fncall
 
+/* A syntax error abandons what is on the stack; free those subtrees and
+ * lists. Tokens are left alone (an IncrementalDocument owns its), and
+ * the program, once reduced, belongs to the compiler.
+ */
+%destructor { $$->deleteTree(); } <declNode> <varDeclNode> <typeNode>
+   <idNode> <structDeclNode> <fnDeclNode> <formalsListNode> <formalsDecl>
+   <fnBody> <stmtNode> <assignNode> <expNode> <loc> <term> <callExpNode>
+%destructor { for (auto node : *$$){ node->deleteTree(); } delete $$; }
+   <declList> <formalsList> <varDeclList> <stmtList> <expListNode>
+
 /* NOTE: Make sure to add precedence and associativity
  * declarations
 */
@@ -165,12 +218,15 @@
 
 program : declList {
 		   //$$ = new ProgramNode(new DeclListNode($1));
-		   $$ = new ProgramNode(new DeclListNode($1));
+		   $$ = spanned(new ProgramNode(spanned(new DeclListNode($1), @1)), @$);
+		   delete $1;
 		   compiler.setASTRoot($$);
 		   }
   	;
 
 declList : declList decl {
+			 LILC_PROBE3(decl, (int)$2->kind(), (size_t)@2.offset,
+			    (size_t)@2.length);
 			 $1->push_back($2);
 			 $$ = $1;
 			 }
@@ -198,17 +254,19 @@ varDeclList : varDeclList varDecl {
     }
   ;
 varDecl : type id SEMICOLON {
-		$$ = new VarDeclNode($1, $2, VarDeclNode::NOT_STRUCT);
+		$$ = spanned(new VarDeclNode($1, $2, VarDeclNode::NOT_STRUCT), @$);
 		}
   | STRUCT id id SEMICOLON {
-    $$ = new VarDeclNode(new StructNode($2), $3, 0);
+    $$ = spanned(new VarDeclNode(
+       spanned(new StructNode($2), through(@1, @2)), $3, 0), @$);
     }
   ;
 fnDecl : type id formals fnBody {
-    $$ = new FnDeclNode($1, $2, $3, $4);
+    $$ = spanned(new FnDeclNode($1, $2, $3, $4), @$);
     }
 structDecl : STRUCT id LCURLY structBody RCURLY SEMICOLON {
-    $$ = new StructDeclNode($2, new DeclListNode($4));
+    $$ = spanned(new StructDeclNode($2, spanned(new DeclListNode($4), @4)), @$);
+    delete $4;
     }
   ;
 structBody : structBody varDecl {
@@ -221,26 +279,31 @@ structBody : structBody varDecl {
     }
   ;
 formals : LPAREN RPAREN {
-    $$ = new FormalsListNode(new std::list<FormalDeclNode *>());
+    std::list<FormalDeclNode *> none;
+    $$ = spanned(new FormalsListNode(&none), @$);
     }
   | LPAREN formalsList RPAREN {
-    $$ = new FormalsListNode($2);
+    $$ = spanned(new FormalsListNode($2), @$);
+    delete $2;
     }
   ;
 formalsList : formalDecl {
     $$ = new std::list<FormalDeclNode *>();
-    $$->push_front($1);
+    $$->push_back($1);
     }
-  | formalDecl COMMA formalsList {
-    $3->push_front($1);
-    $$ = $3;
+  | formalsList COMMA formalDecl {
+    $1->push_back($3);
+    $$ = $1;
     }
   ;
 formalDecl : type id {
-    $$ = new FormalDeclNode($1, $2);
+    $$ = spanned(new FormalDeclNode($1, $2), @$);
     }
 fnBody : LCURLY varDeclList stmtList RCURLY {
-    $$ = new FnBodyNode(new DeclListNode($2), new StmtListNode($3));
+    $$ = spanned(new FnBodyNode(spanned(new DeclListNode($2), @2),
+       spanned(new StmtListNode($3), @3)), @$);
+    delete $2;
+    delete $3;
     }
 stmtList : stmtList stmt {
     $1->push_back($2);
@@ -251,87 +314,99 @@ stmtList : stmtList stmt {
     }
   ;
 stmt : assignExp SEMICOLON {
-    $$ = new AssignStmtNode($1);
+    $$ = spanned(new AssignStmtNode($1), @$);
     }
   | loc PLUSPLUS SEMICOLON {
-    $$ = new PostIncStmtNode($1);
+    $$ = spanned(new PostIncStmtNode($1), @$);
     }
   | loc MINUSMINUS SEMICOLON {
-    $$ = new PostDecStmtNode($1);
+    $$ = spanned(new PostDecStmtNode($1), @$);
     }
   | INPUT READ loc SEMICOLON {
-    $$ = new ReadStmtNode($3);
+    $$ = spanned(new ReadStmtNode($3), @$);
     }
   | OUTPUT WRITE exp SEMICOLON {
-    $$ = new WriteStmtNode($3);
+    $$ = spanned(new WriteStmtNode($3), @$);
     }
   | IF LPAREN exp RPAREN LCURLY varDeclList stmtList RCURLY {
-    $$ = new IfStmtNode($3, new DeclListNode($6), new StmtListNode($7));
+    $$ = spanned(new IfStmtNode($3, spanned(new DeclListNode($6), @6),
+       spanned(new StmtListNode($7), @7)), @$);
+    delete $6;
+    delete $7;
     }
   | IF LPAREN exp RPAREN LCURLY varDeclList stmtList RCURLY ELSE LCURLY varDeclList stmtList RCURLY {
-    $$ = new IfElseStmtNode($3, new DeclListNode($6), new StmtListNode($7),
-                            new DeclListNode($11), new StmtListNode($12));
+    $$ = spanned(new IfElseStmtNode($3,
+       spanned(new DeclListNode($6), @6), spanned(new StmtListNode($7), @7),
+       spanned(new DeclListNode($11), @11),
+       spanned(new StmtListNode($12), @12)), @$);
+    delete $6;
+    delete $7;
+    delete $11;
+    delete $12;
     }
   | WHILE LPAREN exp RPAREN LCURLY varDeclList stmtList RCURLY {
-    $$ = new WhileStmtNode($3, new DeclListNode($6), new StmtListNode($7));
+    $$ = spanned(new WhileStmtNode($3, spanned(new DeclListNode($6), @6),
+       spanned(new StmtListNode($7), @7)), @$);
+    delete $6;
+    delete $7;
     }
   | RETURN exp SEMICOLON {
-    $$ = new ReturnStmtNode($2);
+    $$ = spanned(new ReturnStmtNode($2), @$);
     }
   | RETURN SEMICOLON {
-    $$ = new ReturnStmtNode(nullptr);
+    $$ = spanned(new ReturnStmtNode(nullptr), @$);
     }
   | fncall SEMICOLON{
-      $$ = new CallStmtNode($1);
+      $$ = spanned(new CallStmtNode($1), @$);
     }
   ;
 assignExp : loc ASSIGN exp {
-    $$ = new AssignNode($1, $3);
+    $$ = spanned(new AssignNode($1, $3), @$);
     }
 exp  : assignExp {
     $$ = $1;
     }
   | exp PLUS exp {
-    $$ = new PlusNode($1, $3);
+    $$ = compiler.rewritten(spanned(new PlusNode($1, $3), @$));
     }
   | exp MINUS exp {
-    $$ = new MinusNode($1, $3);
+    $$ = compiler.rewritten(spanned(new MinusNode($1, $3), @$));
     }
   | exp TIMES exp {
-    $$ = new TimesNode($1, $3);
+    $$ = compiler.rewritten(spanned(new TimesNode($1, $3), @$));
     }
   | exp DIVIDE exp {
-    $$ = new DivideNode($1, $3);
+    $$ = spanned(new DivideNode($1, $3), @$);
     }
   | NOT exp {
-    $$ = new NotNode($2);
+    $$ = compiler.rewritten(spanned(new NotNode($2), @$));
     }
   | exp AND exp {
-    $$ = new AndNode($1, $3);
+    $$ = compiler.rewritten(spanned(new AndNode($1, $3), @$));
     }
   | exp OR exp {
-    $$ = new OrNode($1, $3);
+    $$ = compiler.rewritten(spanned(new OrNode($1, $3), @$));
     }
   | exp EQUALS exp {
-    $$ = new EqualsNode($1, $3);
+    $$ = compiler.rewritten(spanned(new EqualsNode($1, $3), @$));
     }
   | exp NOTEQUALS exp {
-    $$ = new NotEqualsNode($1, $3);
+    $$ = compiler.rewritten(spanned(new NotEqualsNode($1, $3), @$));
     }
   | exp LESS exp {
-    $$ = new LessNode($1, $3);
+    $$ = compiler.rewritten(spanned(new LessNode($1, $3), @$));
     }
   | exp GREATER exp {
-    $$ = new GreaterNode($1, $3);
+    $$ = compiler.rewritten(spanned(new GreaterNode($1, $3), @$));
     }
   | exp LESSEQ exp {
-    $$ = new LessEqNode($1, $3);
+    $$ = compiler.rewritten(spanned(new LessEqNode($1, $3), @$));
     }
   | exp GREATEREQ exp {
-    $$ = new GreaterEqNode($1, $3);
+    $$ = compiler.rewritten(spanned(new GreaterEqNode($1, $3), @$));
     }
   | MINUS term {
-    $$ = new UnaryMinusNode($2);
+    $$ = compiler.rewritten(spanned(new UnaryMinusNode($2), @$));
     }
   | term {
     $$ = $1;
@@ -341,16 +416,16 @@ term : loc {
     $$ = $1;
     }
   | INTLITERAL {
-    $$ = new IntLitNode($1);
+    $$ = spanned(new IntLitNode($1), @$);
     }
   | STRINGLITERAL {
-    $$ = new StrLitNode($1);
+    $$ = spanned(new StrLitNode($1), @$);
     }
   | TRUE {
-    $$ = new TrueNode();
+    $$ = spanned(new TrueNode(), @$);
     }
   | FALSE {
-    $$ = new FalseNode();
+    $$ = spanned(new FalseNode(), @$);
     }
   | LPAREN exp RPAREN {
     $$ = $2;
@@ -360,10 +435,14 @@ term : loc {
     }
   ;
 fncall : id LPAREN RPAREN {
-    $$ = new CallExpNode($1, new ExpListNode(new std::list<ExpNode*>()));
+    std::list<ExpNode*> empty;
+    ExpListNode * none = new ExpListNode(&empty);
+    $$ = spanned(new CallExpNode($1,
+       spanned(none, LILC::makeSpan(@3.offset, 0))), @$);
     }
   | id LPAREN actualList RPAREN{
-    $$ = new CallExpNode($1, new ExpListNode($3));
+    $$ = spanned(new CallExpNode($1, spanned(new ExpListNode($3), @3)), @$);
+    delete $3;
     }
 actualList : exp{
     $$ = new std::list<ExpNode*>();
@@ -373,22 +452,23 @@ actualList : exp{
     $1->push_back($3);
     $$ = $1;
     }
-type : INT { $$ = new IntNode();}
-  | BOOL { $$ = new BoolNode();}
-  | VOID {$$ = new VoidNode();}
+type : INT { $$ = spanned(new IntNode(), @$);}
+  | BOOL { $$ = spanned(new BoolNode(), @$);}
+  | VOID {$$ = spanned(new VoidNode(), @$);}
   ;
 loc : id {
     $$ = $1;
     }
   | loc DOT id {
-  $$ = new DotAccessNode($1, $3);
+  $$ = spanned(new DotAccessNode($1, $3), @$);
     }
   ;
-id : ID { $$ = new IdNode($1);}
+id : ID { $$ = spanned(new IdNode($1), @$);}
 
 %%
 void
-LILC::LilC_Parser::error(const std::string &err_message )
+LILC::LilC_Parser::error(const location_type &, const std::string &err_message )
 {
-   std::cerr << "Error: " << err_message << "\n";
+   LILC::Position pos = scanner.position();
+   compiler.diagnostics().error(pos.line, pos.col, err_message);
 }
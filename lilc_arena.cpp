@@ -0,0 +1,50 @@
+#include <cstddef>
+#include <cstdlib>
+#include <iostream>
+
+#include "lilc_arena.hpp"
+
+namespace LILC{
+
+namespace {
+
+const size_t ALIGN = alignof(std::max_align_t);
+
+} /* end anonymous namespace */
+
+ASTArena::ASTArena(size_t blockSize)
+: myBlockSize(blockSize)
+{
+}
+
+ASTArena::~ASTArena()
+{
+   for (size_t i = myNodes.size(); i-- > 0; ){
+      myNodes[i]->~ASTNode();
+   }
+   for (char * block : myBlocks){
+      free(block);
+   }
+}
+
+void * ASTArena::allocate(size_t size)
+{
+   size = (size + ALIGN - 1) & ~(ALIGN - 1);
+   if (myNext == nullptr || (size_t)(myEnd - myNext) < size){
+      size_t len = size > myBlockSize ? size : myBlockSize;
+      char * block = (char *)malloc(len);
+      if (block == nullptr){
+         std::cerr << "Out of memory cloning AST\n";
+         exit( EXIT_FAILURE );
+      }
+      myBlocks.push_back(block);
+      myNext = block;
+      myEnd = block + len;
+   }
+   void * mem = myNext;
+   myNext += size;
+   myBytes += size;
+   return mem;
+}
+
+} /* end namespace */
@@ -0,0 +1,44 @@
+#ifndef __LILC_ARENA_HPP__
+#define __LILC_ARENA_HPP__ 1
+
+#include <new>
+#include <cstddef>
+#include <vector>
+#include <utility>
+
+#include "ast.hpp"
+
+namespace LILC{
+
+// Bump allocator for AST nodes made by clone(). Nodes are carved out of
+// large blocks and live until the arena is destroyed, which runs their
+// destructors; they must never be deleted one by one.
+class ASTArena{
+public:
+   ASTArena(size_t blockSize = 1 << 16);
+   ~ASTArena();
+   ASTArena(const ASTArena &) = delete;
+   ASTArena & operator=(const ASTArena &) = delete;
+
+   template <typename T, typename... Args>
+   T * make(Args&&... args){
+      T * node = new (allocate(sizeof(T))) T(std::forward<Args>(args)...);
+      myNodes.push_back(node);
+      return node;
+   }
+
+   size_t nodeCount() const { return myNodes.size(); }
+   size_t bytesUsed() const { return myBytes; }
+private:
+   void * allocate(size_t size);
+
+   size_t myBlockSize;
+   char * myNext = nullptr;
+   char * myEnd = nullptr;
+   size_t myBytes = 0;
+   std::vector<char *> myBlocks;
+   std::vector<ASTNode *> myNodes;
+};
+
+} /* end namespace */
+#endif /* END __LILC_ARENA_HPP__ */
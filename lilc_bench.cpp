@@ -0,0 +1,180 @@
+#include <cmath>
+#include <chrono>
+#include <vector>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <algorithm>
+
+#include "lilc_bench.hpp"
+#include "lilc_generate.hpp"
+#include "lilc_compiler.hpp"
+#include "lilc_json.hpp"
+
+using TokenTag = LILC::LilC_Parser::token;
+
+namespace LILC{
+
+namespace {
+
+struct Result{
+   const char * name;
+   double median;
+   double low;
+   double high;
+};
+
+size_t scanText(const std::string &text)
+{
+   MemoryStreamBuf buf(text.data(), text.size());
+   std::istream in(&buf);
+   Diagnostics diags;
+   LilC_Scanner scanner(&in, &diags);
+   LilC_Parser::semantic_type lval;
+   size_t tokens = 0;
+   while (scanner.yylex(&lval) != TokenTag::END){
+      delete(lval.symbolValue);
+      tokens++;
+   }
+   return tokens;
+}
+
+size_t parseText(const std::string &text)
+{
+   LilC_Compiler compiler;
+   return compiler.buildAST(text) ? 1 : 0;
+}
+
+// Median of the sorted times, with the order statistics that bound a
+// 95% confidence interval for it (normal approximation to the binomial).
+Result summarize(const char * name, std::vector<double> &times)
+{
+   std::sort(times.begin(), times.end());
+   size_t n = times.size();
+   double spread = 1.96 * std::sqrt((double)n) / 2;
+   long lo = (long)std::floor(n / 2.0 - spread);
+   long hi = (long)std::ceil(n / 2.0 + spread);
+   lo = std::max(0L, lo);
+   hi = std::min((long)n - 1, hi);
+   double median = n % 2 == 1 ? times[n / 2]
+      : (times[n / 2 - 1] + times[n / 2]) / 2;
+   return Result{ name, median, times[lo], times[hi] };
+}
+
+template <typename Fn>
+Result measure(const char * name, const BenchSettings &settings, Fn run)
+{
+   volatile size_t sink = 0;
+   for (int i = 0; i < settings.warmups; i++){
+      sink = sink + run();
+   }
+   std::vector<double> times;
+   for (int i = 0; i < settings.runs; i++){
+      auto start = std::chrono::steady_clock::now();
+      sink = sink + run();
+      auto end = std::chrono::steady_clock::now();
+      times.push_back(
+         std::chrono::duration<double, std::milli>(end - start).count());
+   }
+   return summarize(name, times);
+}
+
+} /* end anonymous namespace */
+
+int benchGate(const char * baselineFile, bool update,
+const BenchSettings &settings, std::ostream &report)
+{
+   std::string text = generateProgram(settings.seed, settings.scale);
+   LilC_Compiler unparsed;
+   if (!unparsed.buildAST(text)){
+      report << "generated input does not parse\n";
+      return 2;
+   }
+   ProgramNode * root = unparsed.getASTRoot();
+
+   std::vector<Result> results;
+   results.push_back(measure("scan", settings,
+      [&](){ return scanText(text); }));
+   results.push_back(measure("parse", settings,
+      [&](){ return parseText(text); }));
+   results.push_back(measure("unparse", settings, [&](){
+      std::ostringstream out;
+      root->unparse(out, 0);
+      return out.str().size();
+   }));
+
+   report << std::fixed << std::setprecision(3) << "input: seed "
+      << settings.seed << ", scale " << settings.scale << ", "
+      << text.size() << " bytes; " << settings.warmups << " warm-up and "
+      << settings.runs << " timed runs\n";
+
+   if (update){
+      JSONValue metrics = JSONValue::object();
+      for (const Result &r : results){
+         JSONValue metric = JSONValue::object();
+         metric.set("median_ms", r.median);
+         metric.set("ci_low_ms", r.low);
+         metric.set("ci_high_ms", r.high);
+         metrics.set(r.name, metric);
+         report << r.name << ": median " << r.median << " ms [" << r.low
+            << ", " << r.high << "]\n";
+      }
+      JSONValue baseline = JSONValue::object();
+      baseline.set("format", "lilc-bench");
+      baseline.set("version", 1);
+      baseline.set("seed", (long long)settings.seed);
+      baseline.set("scale", settings.scale);
+      baseline.set("input_bytes", text.size());
+      baseline.set("runs", settings.runs);
+      baseline.set("metrics", metrics);
+      std::ofstream out(baselineFile);
+      out << baseline.str() << "\n";
+      if (!out.good()){
+         report << "cannot write " << baselineFile << "\n";
+         return 2;
+      }
+      report << "baseline written to " << baselineFile << "\n";
+      return 0;
+   }
+
+   std::ifstream in(baselineFile);
+   std::string json((std::istreambuf_iterator<char>(in)),
+      std::istreambuf_iterator<char>());
+   bool ok;
+   JSONValue baseline = JSONValue::parse(json, ok);
+   if (!in.is_open() || !ok || baseline["format"].string() != "lilc-bench"){
+      report << "cannot read baseline " << baselineFile << "\n";
+      return 2;
+   }
+   if ((uint64_t)baseline["seed"].number() != settings.seed
+      || (size_t)baseline["scale"].number() != settings.scale){
+      report << "baseline was made with seed "
+         << (uint64_t)baseline["seed"].number() << ", scale "
+         << (size_t)baseline["scale"].number() << "\n";
+      return 2;
+   }
+
+   int regressed = 0;
+   for (const Result &r : results){
+      const JSONValue &metric = baseline["metrics"][r.name];
+      report << r.name << ": median " << r.median << " ms [" << r.low
+         << ", " << r.high << "]";
+      if (metric.isNull()){
+         report << ", not in baseline\n";
+         continue;
+      }
+      double base = metric["median_ms"].number();
+      double change = base > 0 ? r.median / base - 1 : 0;
+      bool worse = change > settings.threshold && r.low > base;
+      report << ", baseline " << base << " ms, " << std::showpos
+         << std::setprecision(1) << 100 * change << "%" << std::noshowpos
+         << std::setprecision(3) << (worse ? "  REGRESSED" : "") << "\n";
+      if (worse){ regressed++; }
+   }
+   report << (regressed == 0 ? "no regressions" : "regressions found")
+      << " (threshold " << std::setprecision(0) << 100 * settings.threshold
+      << "%)\n";
+   return regressed == 0 ? 0 : 1;
+}
+
+} /* end namespace */
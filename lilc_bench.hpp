@@ -0,0 +1,36 @@
+#ifndef __LILC_BENCH_HPP__
+#define __LILC_BENCH_HPP__ 1
+
+#include <ostream>
+#include <cstddef>
+#include <cstdint>
+
+namespace LILC{
+
+struct BenchSettings{
+   uint64_t seed = 1;
+   // Functions in the generated input, about 1 KB of text each
+   size_t scale = 1000;
+   int warmups = 2;
+   int runs = 15;
+   // Allowed slowdown of a median against the baseline, as a fraction
+   double threshold = 0.10;
+};
+
+// Performance gate (--bench). Generates an input with generateProgram()
+// and times scanning, parsing and unparsing it: warm-up runs first, then
+// settings.runs timed runs, each summarized by its median and a
+// distribution-free 95% confidence interval for the median.
+//
+// With update set the results are written to baselineFile as JSON, for
+// later runs on the same machine to compare with. Otherwise they are
+// compared with it: a metric regresses when its median exceeds the
+// baseline median by more than the threshold and the whole confidence
+// interval lies above the baseline, so one noisy run cannot fail the
+// gate. Returns 0 if nothing regressed, 1 if something did, and 2 if the
+// baseline is missing or was made with another seed or scale.
+int benchGate(const char * baselineFile, bool update,
+   const BenchSettings &settings, std::ostream &report);
+
+} /* end namespace */
+#endif /* END __LILC_BENCH_HPP__ */
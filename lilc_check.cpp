@@ -0,0 +1,168 @@
+#include <sstream>
+#include <vector>
+
+#include "lilc_check.hpp"
+#include "lilc_compiler.hpp"
+#include "lilc_minify.hpp"
+#include "lilc_arena.hpp"
+#include "lilc_unparse.hpp"
+#include "lilc_timing.hpp"
+
+namespace LILC{
+
+namespace {
+
+std::string unparsed(ProgramNode * root)
+{
+   std::ostringstream out;
+   root->unparse(out, 0);
+   return out.str();
+}
+
+std::string unparsedCached(ProgramNode * root)
+{
+   std::ostringstream out;
+   unparseCached(root, out);
+   return out.str();
+}
+
+std::string minified(ProgramNode * root)
+{
+   std::ostringstream out;
+   Minifier minifier(out, false);
+   minifier.minifyProgram(root);
+   return out.str();
+}
+
+// The first statement list under node, in pre-order, with at least two
+// statements, or nullptr.
+StmtListNode * firstStmtList(ASTNode * node)
+{
+   if (node->kind() == STMT_LIST_NODE){
+      StmtListNode * stmts = static_cast<StmtListNode *>(node);
+      if (stmts->getStmts()->size() >= 2){ return stmts; }
+   }
+   std::vector<ASTNode *> kids;
+   node->children(kids);
+   for (ASTNode * kid : kids){
+      StmtListNode * found = firstStmtList(kid);
+      if (found != nullptr){ return found; }
+   }
+   return nullptr;
+}
+
+// Why text fails to parse back into a tree equal to expected, or nullptr
+// if it does.
+const char * reparseFailure(const std::string &text, ProgramNode * expected)
+{
+   LilC_Compiler compiler;
+   if (!compiler.buildAST(text)){
+      return "does not parse";
+   }
+   if (!compiler.getASTRoot()->equals(expected)){
+      return "parses to a different tree";
+   }
+   return nullptr;
+}
+
+} /* end anonymous namespace */
+
+int roundTripCheck(const char * const * files, int count, std::ostream &report)
+{
+   int failed = 0;
+   for (int i = 0; i < count; i++){
+      LilC_Compiler original;
+      if (!original.buildAST(files[i])){
+         report << files[i] << ": does not parse\n";
+         failed++;
+         continue;
+      }
+      ProgramNode * root = original.getASTRoot();
+      std::string text = unparsed(root);
+      const char * stage = "unparsed output";
+      const char * why = reparseFailure(text, root);
+      if (why == nullptr){
+         LilC_Compiler again;
+         again.buildAST(text);
+         if (unparsed(again.getASTRoot()) != text){
+            why = "is not idempotent";
+         }
+      }
+      if (why == nullptr && unparseExact(root) != text){
+         stage = "exact-size unparse";
+         why = "differs from the streamed one";
+      }
+      if (why == nullptr){
+         // Once to fill the caches and once to copy from them
+         stage = "cached unparse";
+         if (unparsedCached(root) != text || unparsedCached(root) != text){
+            why = "differs from the streamed one";
+         }
+      }
+      if (why == nullptr){
+         stage = "minified output";
+         why = reparseFailure(minified(root), root);
+      }
+      if (why == nullptr){
+         stage = "clone";
+         ASTArena arena;
+         ProgramNode * copy = root->clone(arena);
+         if (!copy->equals(root) || unparsed(copy) != text){
+            why = "differs from the original";
+         }
+      }
+      if (why == nullptr){
+         // Last, as it changes the tree: move a statement to the end of
+         // its list in place. The cached unparse must render the change,
+         // and the new text must parse to the rehashed tree.
+         stage = "in-place edit";
+         StmtListNode * stmts = firstStmtList(root);
+         if (stmts != nullptr){
+            std::list<StmtNode *> &list = *stmts->getStmts();
+            list.splice(list.end(), list, list.begin());
+            stmts->modified();
+            std::string edited = unparsedCached(root);
+            why = edited != unparsed(root) ? "is missed by the cached unparse"
+               : reparseFailure(edited, root);
+         }
+      }
+      if (why != nullptr){
+         report << files[i] << ": " << stage << " " << why << "\n";
+         failed++;
+      }
+   }
+   report << count - failed << " of " << count << " files round-trip\n";
+   return failed;
+}
+
+int unparseBenchmark(const char * filename, std::ostream &report)
+{
+   LilC_Compiler compiler;
+   if (!compiler.buildAST(filename)){
+      return 1;
+   }
+   ProgramNode * root = compiler.getASTRoot();
+   const int rounds = 15;
+   struct Pass{
+      const char * name;
+      std::string (*run)(ProgramNode *);
+   };
+   const Pass passes[] = {
+      { "unparse", unparsed },
+      { "unparse exact", [](ProgramNode * root){ return unparseExact(root); } },
+      { "unparse cached", unparsedCached },
+      { "minify", minified }
+   };
+   for (const Pass &pass : passes){
+      size_t bytes = 0;
+      double median = medianMs(rounds, [&](){
+         bytes = pass.run(root).size();
+      });
+      report << pass.name << ": " << bytes << " bytes, median "
+         << median << " ms, " << (bytes / 1e6) / (median / 1e3)
+         << " MB/s (" << rounds << " rounds)\n";
+   }
+   return 0;
+}
+
+} /* end namespace */
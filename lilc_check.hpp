@@ -0,0 +1,27 @@
+#ifndef __LILC_CHECK_HPP__
+#define __LILC_CHECK_HPP__ 1
+
+#include <ostream>
+
+namespace LILC{
+
+// Round-trip check over a corpus. Each file is parsed and unparsed, the
+// text is parsed again, and the two trees must be structurally equal.
+// Unparsing the second tree must give back the same text (idempotence),
+// and so must the exact-size two-pass unparse of the first and two
+// cached unparses of it in a row.
+// The minified form must parse back to the same tree as well, and a
+// deep clone must equal the original and unparse identically. Last, a
+// statement list is edited in place and ASTNode::modified() called: the
+// cached unparse must show the edit and parse back to the edited tree.
+// Reports each failure and a summary; returns the number of files that
+// failed.
+int roundTripCheck(const char * const * files, int count, std::ostream &report);
+
+// Parses filename once and times repeated unparse (streamed, exact-size
+// and cached) and minify passes over its AST into memory, reporting
+// median time and throughput.
+int unparseBenchmark(const char * filename, std::ostream &report);
+
+} /* end namespace */
+#endif /* END __LILC_CHECK_HPP__ */
@@ -3,6 +3,13 @@
 #include <cassert>
 
 #include "lilc_compiler.hpp"
+#include "lilc_export.hpp"
+#include "lilc_compress.hpp"
+#include "lilc_minify.hpp"
+#include "lilc_memreport.hpp"
+#include "lilc_unparse.hpp"
+#include "lilc_selfprofile.hpp"
+#include "lilc_probes.hpp"
 
 using TokenTag = LILC::LilC_Parser::token;
 using Lexeme = LILC::LilC_Parser::semantic_type;
@@ -13,21 +20,50 @@ LILC::LilC_Compiler::~LilC_Compiler()
    scanner = nullptr;
    delete(parser);
    parser = nullptr;
+   if( astRoot != nullptr )
+   {
+      astRoot->deleteTree();
+   }
+   closeSource();
+}
+
+void LILC::LilC_Compiler::openSource( const char * const filename )
+{
+   closeSource();
+   source = new LILC::MappedSource();
+   if( ! source->open( filename ) )
+   {
+       exit( EXIT_FAILURE );
+   }
+   sourceName = filename;
+   LILC_PROBE2( file_open, sourceName.c_str(), source->size() );
+}
+
+void LILC::LilC_Compiler::closeSource()
+{
+   if( source == nullptr )
+   {
+      return;
+   }
+   LILC_PROBE1( file_close, sourceName.c_str() );
+   delete(source);
+   source = nullptr;
 }
 
 void LILC::LilC_Compiler::scan( const char * const filename,
 const char * outfile )
 {
+   LILC::SelfProfiler::Phase phase( "scan", filename );
 
-   std::ifstream inStream( filename );
-   if( ! inStream.good() ) {
-       exit( EXIT_FAILURE );
-   }
+   openSource( filename );
+   std::istream inStream( source->streamBuf() );
 
    delete(scanner);
-   scanner = new LILC::LilC_Scanner( &inStream );
+   scanner = new LILC::LilC_Scanner( &inStream, &myDiagnostics,
+      &source->lineIndex() );
 
-   std::ofstream out(outfile);
+   LILC::OutputFile outFile(outfile);
+   std::ostream &out = outFile.stream();
    Lexeme lexeme;
    int tokenTag;
    while(true){
@@ -35,6 +71,7 @@ const char * outfile )
 	switch (tokenTag){
 		case TokenTag::END:
 			out << "EOF" << std::endl;
+			myDiagnostics.flush(std::cerr);
 			return;
 		case TokenTag::BOOL:
 			out << "bool" << std::endl;
@@ -172,21 +209,65 @@ const char * outfile )
    }
 }
 
-void 
-LILC::LilC_Compiler::parse( const char * const filename, const char * const outfile )
+bool
+LILC::LilC_Compiler::buildAST( const char * const filename )
 {
    assert( filename != nullptr );
-   std::ifstream in_stream( filename );
-   if( ! in_stream.good() )
+   LILC::SelfProfiler::Phase phase( "parse", filename );
+   openSource( filename );
+   std::istream in_stream( source->streamBuf() );
+   return parseStream( in_stream, &source->lineIndex() );
+}
+
+bool
+LILC::LilC_Compiler::buildAST( const std::string &text )
+{
+   textIndex = LILC::LineIndex( text.data(), text.size() );
+   LILC::MemoryStreamBuf in_buf( text.data(), text.size() );
+   std::istream in_stream( &in_buf );
+   return parseStream( in_stream, &textIndex );
+}
+
+bool
+LILC::LilC_Compiler::parseStream( std::istream &in_stream,
+const LILC::LineIndex * lines )
+{
+   astLines = lines;
+   if( tokenArrayMode )
    {
-       exit( EXIT_FAILURE );
+      {
+         LILC::SelfProfiler::Phase phase( "lex" );
+         if( !myTokens.lex( in_stream, &myDiagnostics, lines ) )
+         {
+            return false;
+         }
+      }
+      return buildAST( myTokens, lines );
    }
-   std::ofstream out(outfile);
-   
    delete(scanner);
-   scanner = new LILC::LilC_Scanner( &in_stream );
+   scanner = new LILC::LilC_Scanner( &in_stream, &myDiagnostics, lines );
+   return runParser();
+}
+
+bool
+LILC::LilC_Compiler::buildAST( const LILC::TokenArray &tokens,
+const LILC::LineIndex * lines )
+{
+   astLines = lines;
+   delete(scanner);
+   scanner = new LILC::TokenArrayScanner( tokens, &myDiagnostics, lines );
+   return runParser();
+}
+
+bool
+LILC::LilC_Compiler::runParser()
+{
    delete(parser); 
-   delete(astRoot);
+   if( astRoot != nullptr )
+   {
+      astRoot->deleteTree();
+   }
+   astRoot = nullptr;
    try
    {
       parser = new LILC::LilC_Parser( (*scanner) /* scanner */, 
@@ -199,10 +280,94 @@ LILC::LilC_Compiler::parse( const char * const filename, const char * const outf
       exit( EXIT_FAILURE );
    }
    const int accept( 0 );
-   if( parser->parse() != accept )
+   const bool parsed = parser->parse() == accept;
+   myDiagnostics.flush(*diagnosticsOut);
+   if( ! parsed )
    {
-      std::cerr << "Parse failed!!\n";
+      *diagnosticsOut << "Parse failed!!\n";
+      return false;
    }
-   this->astRoot->unparse(out, 0);
+   return true;
+}
+
+void 
+LILC::LilC_Compiler::parse( const char * const filename, const char * const outfile )
+{
+   if( ! buildAST( filename ) )
+   {
+      LILC::OutputFile empty(outfile);
+      return;
+   }
+   LILC::SelfProfiler::Phase phase( "unparse", filename );
+   // Uncompressed output is sized exactly and written with one write()
+   // or in place, without an ofstream; see lilc_unparse.hpp
+   if( LILC::compressionForName( outfile ) == LILC::NO_COMPRESSION
+      && LILC::unparseToFile( this->astRoot, outfile ) )
+   {
+      return;
+   }
+   LILC::OutputFile out(outfile);
+   this->astRoot->unparse(out.stream(), 0);
    return;
 }
+
+void
+LILC::LilC_Compiler::exportAST( const char * const filename,
+const char * const outfile, LILC::ASTExporter::Format format )
+{
+   LILC::OutputFile out(outfile);
+   if( ! buildAST( filename ) )
+   {
+      return;
+   }
+   LILC::SelfProfiler::Phase phase( "export", filename );
+   LILC::ASTExporter exporter(out.stream(), format);
+   exporter.exportProgram(this->astRoot);
+}
+
+void
+LILC::LilC_Compiler::minify( const char * const filename,
+const char * const outfile, bool renameLocals )
+{
+   LILC::OutputFile out(outfile);
+   if( ! buildAST( filename ) )
+   {
+      return;
+   }
+   LILC::SelfProfiler::Phase phase( "minify", filename );
+   LILC::Minifier minifier(out.stream(), renameLocals);
+   minifier.minifyProgram(this->astRoot);
+}
+
+void
+LILC::LilC_Compiler::memReport( const char * const filename,
+const char * const outfile )
+{
+   LILC::OutputFile out(outfile);
+   if( ! buildAST( filename ) )
+   {
+      return;
+   }
+   LILC::SelfProfiler::Phase phase( "measure", filename );
+   LILC::MemoryReport report;
+   this->astRoot->measure(report);
+
+   // The parser does not keep its tokens, so lex the input once more to
+   // count them; its diagnostics were reported by the parse.
+   LILC::MappedSource again;
+   if( ! again.open( filename ) )
+   {
+      exit( EXIT_FAILURE );
+   }
+   std::istream inStream( again.streamBuf() );
+   LILC::Diagnostics quiet;
+   LILC::LilC_Scanner tokenScanner( &inStream, &quiet );
+   Lexeme lexeme;
+   int tokenTag;
+   while( ( tokenTag = tokenScanner.yylex( &lexeme ) ) != TokenTag::END )
+   {
+      report.token( tokenTag, lexeme.symbolValue );
+      delete( lexeme.symbolValue );
+   }
+   report.print(out.stream());
+}
@@ -4,11 +4,17 @@
 #include <string>
 #include <cstddef>
 #include <istream>
+#include <iostream>
 
 #include "lilc_scanner.hpp"
 #include "symbols.hpp"
 #include "ast.hpp"
 #include "grammar.hh"
+#include "lilc_diagnostics.hpp"
+#include "lilc_source.hpp"
+#include "lilc_export.hpp"
+#include "lilc_tokens.hpp"
+#include "lilc_superopt.hpp"
 
 namespace LILC{
 
@@ -18,15 +24,68 @@ public:
 
    virtual ~LilC_Compiler();
 
+   // The compiler owns the tree it parsed, and frees it at the next parse
+   // and in its destructor; setASTRoot(nullptr) takes it over instead.
    void setASTRoot(ProgramNode * root){ this->astRoot = root; }
    ProgramNode * getASTRoot(){ return this->astRoot; }
 
+   Diagnostics & diagnostics(){ return this->myDiagnostics; }
+   // Where buildAST writes the diagnostics of each parse, and that it
+   // failed; std::cerr unless set
+   void setDiagnosticsStream(std::ostream * out){ this->diagnosticsOut = out; }
+
    void scan( const char * const filename, const char * outfile);
    void parse( const char * const filename, const char * outfile );
+   // Parses filename into the AST root without unparsing it; returns
+   // false (after reporting the diagnostics) if the parse failed.
+   bool buildAST( const char * const filename );
+   // As above, for text already in memory
+   bool buildAST( const std::string &text );
+   // As above, for input already lexed; lines gives the positions of
+   // syntax errors
+   bool buildAST( const TokenArray &tokens, const LineIndex * lines );
+   // Lex the whole input into tokens() before parsing it, rather than
+   // lexing as the parser asks for each token; see lilc_tokens.hpp
+   void setTokenArrayMode( bool on ){ this->tokenArrayMode = on; }
+   // Rewrite expressions with table as they are parsed, see
+   // lilc_superopt.hpp; null (the default) for none
+   void setRewriteTable( const RewriteTable * table ){ this->rewrites = table; }
+   ExpNode * rewritten( ExpNode * exp ){
+      return this->rewrites == nullptr ? exp : this->rewrites->apply(exp);
+   }
+   const TokenArray & tokens() const { return this->myTokens; }
+   // Positions in the source of the last parse; null if it had none
+   const LineIndex * lineIndex() const { return this->astLines; }
+   // Parses filename and streams its AST to outfile, see lilc_export.hpp
+   void exportAST( const char * const filename, const char * outfile,
+      ASTExporter::Format format );
+   // Parses filename and writes it back in as few bytes as possible, see
+   // lilc_minify.hpp
+   void minify( const char * const filename, const char * outfile,
+      bool renameLocals );
+   // Parses filename and writes a table of the memory its AST and
+   // tokens take up, see lilc_memreport.hpp
+   void memReport( const char * const filename, const char * outfile );
 private:
+   // Maps filename as source, exiting if it cannot; closeSource()
+   // releases it
+   void openSource( const char * const filename );
+   void closeSource();
+   bool parseStream( std::istream &in, const LineIndex * lines );
+   bool runParser();
+
    LILC::LilC_Parser  *parser  = nullptr;
    LILC::LilC_Scanner *scanner = nullptr;
+   LILC::MappedSource *source  = nullptr;
+   std::string sourceName;
    ProgramNode * astRoot = nullptr;
+   LineIndex textIndex;
+   const LineIndex * astLines = nullptr;
+   Diagnostics myDiagnostics;
+   std::ostream * diagnosticsOut = &std::cerr;
+   bool tokenArrayMode = false;
+   const RewriteTable * rewrites = nullptr;
+   TokenArray myTokens;
 };
 
 } /* end namespace */
@@ -0,0 +1,346 @@
+#include <cstring>
+#include <cstdlib>
+#include <climits>
+#include <iostream>
+#include <algorithm>
+#ifndef LILC_NO_ZSTD
+#include <dlfcn.h>
+#endif
+#include <zlib.h>
+
+#include "lilc_compress.hpp"
+#include "lilc_source.hpp"
+
+namespace LILC{
+
+namespace {
+
+// The slice of the libzstd streaming API we use, declared here since
+// only the shared library (not its headers) is assumed to be installed.
+struct ZstdInBuffer{ const void * src; size_t size; size_t pos; };
+struct ZstdOutBuffer{ void * dst; size_t size; size_t pos; };
+
+struct Zstd{
+   void * (*createDStream)();
+   size_t (*initDStream)(void *);
+   size_t (*decompressStream)(void *, ZstdOutBuffer *, ZstdInBuffer *);
+   size_t (*freeDStream)(void *);
+   void * (*createCStream)();
+   size_t (*initCStream)(void *, int);
+   size_t (*compressStream)(void *, ZstdOutBuffer *, ZstdInBuffer *);
+   size_t (*endStream)(void *, ZstdOutBuffer *);
+   size_t (*freeCStream)(void *);
+   unsigned (*isError)(size_t);
+   const char * (*getErrorName)(size_t);
+};
+
+#ifndef LILC_NO_ZSTD
+template <typename Fn>
+bool bind(void * lib, const char * name, Fn &fn)
+{
+   fn = (Fn)dlsym(lib, name);
+   return fn != nullptr;
+}
+#endif
+
+// Loads libzstd on first use; exits with a message if it is missing.
+// Built with -DLILC_NO_ZSTD, as P3-static is, there is no libzstd to
+// load and zstd is refused.
+const Zstd & zstd()
+{
+   static Zstd api;
+   static bool loaded = false;
+   if (loaded){ return api; }
+#ifdef LILC_NO_ZSTD
+   std::cerr << "zstd support is not built into this P3\n";
+   exit( EXIT_FAILURE );
+#else
+   void * lib = dlopen("libzstd.so.1", RTLD_NOW | RTLD_LOCAL);
+   if (lib == nullptr){ lib = dlopen("libzstd.so", RTLD_NOW | RTLD_LOCAL); }
+   if (lib == nullptr
+      || !bind(lib, "ZSTD_createDStream", api.createDStream)
+      || !bind(lib, "ZSTD_initDStream", api.initDStream)
+      || !bind(lib, "ZSTD_decompressStream", api.decompressStream)
+      || !bind(lib, "ZSTD_freeDStream", api.freeDStream)
+      || !bind(lib, "ZSTD_createCStream", api.createCStream)
+      || !bind(lib, "ZSTD_initCStream", api.initCStream)
+      || !bind(lib, "ZSTD_compressStream", api.compressStream)
+      || !bind(lib, "ZSTD_endStream", api.endStream)
+      || !bind(lib, "ZSTD_freeCStream", api.freeCStream)
+      || !bind(lib, "ZSTD_isError", api.isError)
+      || !bind(lib, "ZSTD_getErrorName", api.getErrorName)){
+      std::cerr << "zstd support needs libzstd.so.1, which could not be "
+         "loaded\n";
+      exit( EXIT_FAILURE );
+   }
+#endif
+   loaded = true;
+   return api;
+}
+
+void corrupt(const char * format, const char * detail)
+{
+   std::cerr << "Corrupt " << format << " input: " << detail << "\n";
+   exit( EXIT_FAILURE );
+}
+
+// For errors that are not the input's fault, in either direction
+void failed(const char * action, const char * detail)
+{
+   std::cerr << "Could not " << action << ": " << detail << "\n";
+   exit( EXIT_FAILURE );
+}
+
+// Checks a libzstd return code
+size_t checkZstd(size_t rc, const char * action)
+{
+   if (zstd().isError(rc)){
+      failed(action, zstd().getErrorName(rc));
+   }
+   return rc;
+}
+
+const int ZSTD_LEVEL = 3;
+
+} /* end anonymous namespace */
+
+Compression detectCompression(const char * data, size_t len)
+{
+   const unsigned char * b = (const unsigned char *)data;
+   if (len >= 2 && b[0] == 0x1f && b[1] == 0x8b){
+      return GZIP;
+   }
+   if (len >= 4 && b[0] == 0x28 && b[1] == 0xb5 && b[2] == 0x2f
+      && b[3] == 0xfd){
+      return ZSTD;
+   }
+   return NO_COMPRESSION;
+}
+
+Compression compressionForName(const char * filename)
+{
+   size_t len = strlen(filename);
+   if (len > 3 && strcmp(filename + len - 3, ".gz") == 0){ return GZIP; }
+   if (len > 4 && strcmp(filename + len - 4, ".zst") == 0){ return ZSTD; }
+   return NO_COMPRESSION;
+}
+
+DecompressStreamBuf::DecompressStreamBuf(const char * data, size_t len,
+Compression kind, LineIndex * index)
+: myData(data), myLen(len), myKind(kind), myIndex(index)
+{
+   if (myKind == GZIP){
+      z_stream * zs = new z_stream();
+      // 15 + 32: any window size, gzip or zlib header
+      if (inflateInit2(zs, 15 + 32) != Z_OK){
+         corrupt("gzip", zs->msg != nullptr ? zs->msg : "inflateInit2");
+      }
+      myStream = zs;
+   } else {
+      myStream = zstd().createDStream();
+      if (myStream == nullptr){
+         failed("start zstd decompression", "out of memory");
+      }
+      checkZstd(zstd().initDStream(myStream), "start zstd decompression");
+   }
+   setg(myBuf, myBuf, myBuf);
+}
+
+DecompressStreamBuf::~DecompressStreamBuf()
+{
+   if (myKind == GZIP){
+      inflateEnd((z_stream *)myStream);
+      delete((z_stream *)myStream);
+   } else {
+      zstd().freeDStream(myStream);
+   }
+}
+
+DecompressStreamBuf::int_type DecompressStreamBuf::underflow()
+{
+   if (gptr() < egptr()){
+      return traits_type::to_int_type(*gptr());
+   }
+   size_t n = 0;
+   if (!myDone){
+      n = myKind == GZIP ? inflateGzip() : inflateZstd();
+   }
+   if (n == 0){
+      return traits_type::eof();
+   }
+   if (myIndex != nullptr){
+      myIndex->append(myBuf, n);
+   }
+   setg(myBuf, myBuf, myBuf + n);
+   return traits_type::to_int_type(*gptr());
+}
+
+size_t DecompressStreamBuf::inflateGzip()
+{
+   z_stream * zs = (z_stream *)myStream;
+   zs->next_out = (Bytef *)myBuf;
+   zs->avail_out = CHUNK_SIZE;
+   while (zs->avail_out == CHUNK_SIZE){
+      if (zs->avail_in == 0 && myPos < myLen){
+         size_t n = std::min<size_t>(myLen - myPos, UINT_MAX);
+         zs->next_in = (Bytef *)(myData + myPos);
+         zs->avail_in = (uInt)n;
+         myPos += n;
+      }
+      int rc = inflate(zs, Z_NO_FLUSH);
+      if (rc == Z_STREAM_END){
+         if (zs->avail_in == 0 && myPos == myLen){
+            myDone = true;
+            break;
+         }
+         inflateReset(zs); // concatenated members, as gzip(1) writes them
+      } else if (rc == Z_BUF_ERROR && zs->avail_in == 0 && myPos == myLen){
+         corrupt("gzip", "unexpected end of data");
+      } else if (rc != Z_OK && rc != Z_BUF_ERROR){
+         corrupt("gzip", zs->msg != nullptr ? zs->msg : "inflate failed");
+      }
+   }
+   return CHUNK_SIZE - zs->avail_out;
+}
+
+size_t DecompressStreamBuf::inflateZstd()
+{
+   const Zstd &api = zstd();
+   ZstdInBuffer in = { myData, myLen, myPos };
+   ZstdOutBuffer out = { myBuf, CHUNK_SIZE, 0 };
+   while (out.pos == 0){
+      if (in.pos == in.size && myHint == 0){
+         myDone = true;
+         break;
+      }
+      size_t before = in.pos;
+      myHint = api.decompressStream(myStream, &out, &in);
+      if (api.isError(myHint)){
+         corrupt("zstd", api.getErrorName(myHint));
+      }
+      if (out.pos == 0 && in.pos == before && in.pos == in.size){
+         corrupt("zstd", "unexpected end of data");
+      }
+   }
+   myPos = in.pos;
+   return out.pos;
+}
+
+CompressStreamBuf::CompressStreamBuf(std::ofstream &out, Compression kind)
+: myOut(out), myKind(kind)
+{
+   if (myKind == GZIP){
+      z_stream * zs = new z_stream();
+      // 15 + 16: default window, gzip wrapper
+      if (deflateInit2(zs, Z_DEFAULT_COMPRESSION, Z_DEFLATED, 15 + 16, 8,
+         Z_DEFAULT_STRATEGY) != Z_OK){
+         failed("start gzip compression",
+            zs->msg != nullptr ? zs->msg : "deflateInit2");
+      }
+      myStream = zs;
+   } else {
+      myStream = zstd().createCStream();
+      if (myStream == nullptr){
+         failed("start zstd compression", "out of memory");
+      }
+      checkZstd(zstd().initCStream(myStream, ZSTD_LEVEL),
+         "start zstd compression");
+   }
+   setp(myBuf, myBuf + CHUNK_SIZE);
+}
+
+CompressStreamBuf::~CompressStreamBuf()
+{
+   finish();
+   if (myKind == GZIP){
+      deflateEnd((z_stream *)myStream);
+      delete((z_stream *)myStream);
+   } else {
+      zstd().freeCStream(myStream);
+   }
+}
+
+void CompressStreamBuf::finish()
+{
+   if (myFinished){ return; }
+   compress(true);
+   myFinished = true;
+   myOut.flush();
+}
+
+CompressStreamBuf::int_type CompressStreamBuf::overflow(int_type c)
+{
+   compress(false);
+   if (!traits_type::eq_int_type(c, traits_type::eof())){
+      *pptr() = traits_type::to_char_type(c);
+      pbump(1);
+   }
+   return traits_type::not_eof(c);
+}
+
+int CompressStreamBuf::sync()
+{
+   compress(false);
+   myOut.flush();
+   return 0;
+}
+
+// Compresses the put area, and with end set the stream trailer too.
+void CompressStreamBuf::compress(bool end)
+{
+   size_t len = pptr() - pbase();
+   if (myKind == GZIP){
+      z_stream * zs = (z_stream *)myStream;
+      zs->next_in = (Bytef *)pbase();
+      zs->avail_in = (uInt)len;
+      int rc;
+      do {
+         zs->next_out = (Bytef *)myOutBuf;
+         zs->avail_out = CHUNK_SIZE;
+         rc = deflate(zs, end ? Z_FINISH : Z_NO_FLUSH);
+         if (rc == Z_STREAM_ERROR){
+            failed("write gzip output",
+               zs->msg != nullptr ? zs->msg : "deflate failed");
+         }
+         myOut.write(myOutBuf, CHUNK_SIZE - zs->avail_out);
+      } while (zs->avail_out == 0 || (end && rc != Z_STREAM_END));
+   } else {
+      const Zstd &api = zstd();
+      ZstdInBuffer in = { pbase(), len, 0 };
+      while (in.pos < in.size){
+         ZstdOutBuffer out = { myOutBuf, CHUNK_SIZE, 0 };
+         // An error consumes no input, so it must stop the loop
+         checkZstd(api.compressStream(myStream, &out, &in),
+            "write zstd output");
+         myOut.write(myOutBuf, out.pos);
+      }
+      size_t remaining = end ? 1 : 0;
+      while (remaining != 0){
+         ZstdOutBuffer out = { myOutBuf, CHUNK_SIZE, 0 };
+         remaining = checkZstd(api.endStream(myStream, &out),
+            "write zstd output");
+         myOut.write(myOutBuf, out.pos);
+      }
+   }
+   setp(myBuf, myBuf + CHUNK_SIZE);
+}
+
+OutputFile::OutputFile(const char * filename)
+: myFile(filename, std::ios::binary), myStream(nullptr)
+{
+   Compression kind = compressionForName(filename);
+   if (kind != NO_COMPRESSION){
+      myCompressor = new CompressStreamBuf(myFile, kind);
+      myStream.rdbuf(myCompressor);
+   } else {
+      myStream.rdbuf(myFile.rdbuf());
+   }
+}
+
+OutputFile::~OutputFile()
+{
+   myStream.flush();
+   delete(myCompressor);
+}
+
+} /* end namespace */
@@ -0,0 +1,96 @@
+#ifndef __LILC_COMPRESS_HPP__
+#define __LILC_COMPRESS_HPP__ 1
+
+#include <string>
+#include <cstddef>
+#include <fstream>
+#include <streambuf>
+
+namespace LILC{
+
+class LineIndex;
+
+// Compressed sources and artifacts. gzip goes through zlib; zstd through
+// the system libzstd, loaded on first use so that P3 still runs (without
+// zstd support) where it is not installed. -DLILC_NO_ZSTD leaves zstd
+// out altogether, for static builds.
+enum Compression { NO_COMPRESSION, GZIP, ZSTD };
+
+// Recognizes the gzip and zstd frame magic at the start of a buffer.
+Compression detectCompression(const char * data, size_t len);
+
+// Compression implied by an output file name: ".gz" or ".zst".
+Compression compressionForName(const char * filename);
+
+// Inflates a compressed buffer chunk by chunk as the scanner pulls on
+// it, so no decompressed copy of the whole file is ever held. If index
+// is given, every chunk is appended to it, which keeps the line index
+// ahead of any token the scanner can report on. Corrupt input is fatal.
+class DecompressStreamBuf : public std::streambuf{
+public:
+   DecompressStreamBuf(const char * data, size_t len, Compression kind,
+      LineIndex * index = nullptr);
+   ~DecompressStreamBuf();
+   DecompressStreamBuf(const DecompressStreamBuf &) = delete;
+   DecompressStreamBuf & operator=(const DecompressStreamBuf &) = delete;
+protected:
+   int_type underflow() override;
+private:
+   size_t inflateGzip();
+   size_t inflateZstd();
+
+   static const size_t CHUNK_SIZE = 1 << 16;
+
+   const char * myData;
+   size_t myLen;
+   size_t myPos = 0;
+   Compression myKind;
+   LineIndex * myIndex;
+   void * myStream = nullptr;
+   bool myDone = false;
+   size_t myHint = 1; // zstd: nonzero while a frame is unfinished
+   char myBuf[CHUNK_SIZE];
+};
+
+// Compresses everything written through it into a file.
+class CompressStreamBuf : public std::streambuf{
+public:
+   CompressStreamBuf(std::ofstream &out, Compression kind);
+   ~CompressStreamBuf();
+   CompressStreamBuf(const CompressStreamBuf &) = delete;
+   CompressStreamBuf & operator=(const CompressStreamBuf &) = delete;
+
+   // Compresses what is buffered and writes the stream trailer. Called by
+   // the destructor if not before.
+   void finish();
+protected:
+   int_type overflow(int_type c) override;
+   int sync() override;
+private:
+   void compress(bool end);
+
+   static const size_t CHUNK_SIZE = 1 << 16;
+
+   std::ofstream &myOut;
+   Compression myKind;
+   void * myStream = nullptr;
+   bool myFinished = false;
+   char myBuf[CHUNK_SIZE];
+   char myOutBuf[CHUNK_SIZE];
+};
+
+// An output file that is transparently compressed when its name ends in
+// ".gz" or ".zst".
+class OutputFile{
+public:
+   explicit OutputFile(const char * filename);
+   ~OutputFile();
+   std::ostream & stream(){ return myStream; }
+private:
+   std::ofstream myFile;
+   CompressStreamBuf * myCompressor = nullptr;
+   std::ostream myStream;
+};
+
+} /* end namespace */
+#endif /* END __LILC_COMPRESS_HPP__ */
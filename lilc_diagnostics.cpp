@@ -0,0 +1,121 @@
+#include <algorithm>
+
+#include "lilc_diagnostics.hpp"
+#include "lilc_json.hpp"
+
+namespace LILC{
+
+void Diagnostics::report(Severity sev, size_t line, size_t col,
+const std::string &msg, size_t mergeLength)
+{
+   report(Entry{sev, line, col, msg, 1, mergeLength});
+}
+
+void Diagnostics::report(const Entry &entry)
+{
+   if (entry.severity == ERROR){
+      myErrors += entry.count;
+   } else {
+      myWarnings += entry.count;
+   }
+
+   // Merge a run of identical reports at adjacent positions (e.g. one
+   // illegal character per byte of binary garbage, whatever the bytes)
+   // into the entry that started the run. The same report elsewhere is
+   // a separate entry.
+   if (!myEntries.empty() && myRunOpen){
+      Entry &last = myEntries.back();
+      bool adjacent = (entry.line == myRunLine && entry.col == myRunCol + 1)
+         || (entry.line == myRunLine + 1 && entry.col == 1);
+      if (adjacent && last.severity == entry.severity
+         && last.mergeLength == entry.mergeLength
+         && last.msg.compare(0, last.mergeLength, entry.msg, 0,
+            entry.mergeLength) == 0){
+         last.count += entry.count;
+         myRunLine = entry.line;
+         myRunCol = entry.col;
+         return;
+      }
+   }
+   if (myEntries.size() >= myMaxEntries){
+      mySuppressed += entry.count;
+      myRunOpen = false;
+      return;
+   }
+   myEntries.push_back(entry);
+   myRunOpen = true;
+   myRunLine = entry.line;
+   myRunCol = entry.col;
+}
+
+void Diagnostics::clear(){
+   myEntries.clear();
+   myRunOpen = false;
+   mySuppressed = 0;
+   myErrors = 0;
+   myWarnings = 0;
+}
+
+void Diagnostics::flush(std::ostream &out){
+   if (empty()){ return; }
+   std::stable_sort(myEntries.begin(), myEntries.end(),
+      [](const Entry &a, const Entry &b){
+         if (a.line != b.line){ return a.line < b.line; }
+         return a.col < b.col;
+      });
+
+   std::string buf;
+   buf.reserve(myEntries.size() * 64 + 64);
+   if (myFormat == JSON){
+      renderJSON(buf);
+   } else {
+      renderText(buf);
+   }
+   out.write(buf.data(), buf.size());
+   out.flush();
+   clear();
+}
+
+void Diagnostics::renderText(std::string &buf){
+   for (const Entry &e : myEntries){
+      buf += std::to_string(e.line);
+      buf += ':';
+      buf += std::to_string(e.col);
+      buf += e.severity == ERROR ? " ***ERROR*** " : " ***WARNING*** ";
+      buf += e.msg;
+      if (e.count > 1){
+         buf += " (repeated ";
+         buf += std::to_string(e.count);
+         buf += " times)";
+      }
+      buf += '\n';
+   }
+   if (mySuppressed > 0){
+      buf += std::to_string(mySuppressed);
+      buf += " further diagnostics suppressed\n";
+   }
+}
+
+void Diagnostics::renderJSON(std::string &buf){
+   buf += "{\"diagnostics\":[";
+   for (size_t i = 0; i < myEntries.size(); i++){
+      const Entry &e = myEntries[i];
+      buf += i == 0 ? "\n" : ",\n";
+      buf += "{\"severity\":";
+      buf += e.severity == ERROR ? "\"error\"" : "\"warning\"";
+      buf += ",\"line\":";
+      buf += std::to_string(e.line);
+      buf += ",\"column\":";
+      buf += std::to_string(e.col);
+      buf += ",\"message\":";
+      appendJSONString(buf, e.msg);
+      buf += ",\"count\":";
+      buf += std::to_string(e.count);
+      buf += '}';
+   }
+   buf += "\n],\"suppressed\":";
+   buf += std::to_string(mySuppressed);
+   buf += "}\n";
+}
+
+} /* end namespace */
@@ -0,0 +1,84 @@
+#ifndef __LILC_DIAGNOSTICS_HPP__
+#define __LILC_DIAGNOSTICS_HPP__ 1
+
+#include <string>
+#include <vector>
+#include <cstddef>
+#include <ostream>
+
+namespace LILC{
+
+// Collects warnings and errors from the scanner and parser instead of
+// writing each one straight to std::cerr. Runs of consecutive identical
+// reports at adjacent positions (the next column, or the start of the
+// next line) are merged into a single entry with a repeat count, which
+// keeps the message of the first; a report may leave the end of its
+// message (such as the byte of an illegal character) out of the
+// comparison. The
+// total number of stored entries is capped, and everything is written
+// out in one buffered write by flush().
+class Diagnostics{
+public:
+   enum Severity { WARNING, ERROR };
+   enum Format { TEXT, JSON };
+
+   static const size_t DEFAULT_MAX_ENTRIES = 100;
+
+   Diagnostics(size_t maxEntries = DEFAULT_MAX_ENTRIES)
+   : myMaxEntries(maxEntries) { }
+
+   void warn(size_t line, size_t col, const std::string &msg){
+      report(WARNING, line, col, msg);
+   }
+   void error(size_t line, size_t col, const std::string &msg){
+      report(ERROR, line, col, msg);
+   }
+   // Only the first mergeLength bytes of msg need to match for the
+   // report to merge into the run before it.
+   void report(Severity sev, size_t line, size_t col, const std::string &msg,
+      size_t mergeLength = std::string::npos);
+
+   void setMaxEntries(size_t max){ myMaxEntries = max; }
+   void setFormat(Format fmt){ myFormat = fmt; }
+   Format format() const { return myFormat; }
+
+   size_t errorCount() const { return myErrors; }
+   size_t warningCount() const { return myWarnings; }
+   bool empty() const { return myEntries.empty() && mySuppressed == 0; }
+
+   struct Entry{
+      Severity severity;
+      size_t line;
+      size_t col;
+      std::string msg;
+      size_t count;
+      size_t mergeLength = std::string::npos;
+   };
+   const std::vector<Entry> & entries() const { return myEntries; }
+   // Re-reports an entry taken from another collector, keeping its count.
+   void report(const Entry &entry);
+
+   // Sorts the collected entries by location, renders them in the
+   // current format and writes them to out with a single write call.
+   // The collector is empty afterwards.
+   void flush(std::ostream &out);
+   void clear();
+
+private:
+   void renderText(std::string &buf);
+   void renderJSON(std::string &buf);
+
+   std::vector<Entry> myEntries;
+   // Where the last report merged into myEntries.back() was, if any
+   bool myRunOpen = false;
+   size_t myRunLine = 0;
+   size_t myRunCol = 0;
+   size_t myMaxEntries;
+   size_t mySuppressed = 0;
+   size_t myErrors = 0;
+   size_t myWarnings = 0;
+   Format myFormat = TEXT;
+};
+
+} /* end namespace */
+#endif /* END __LILC_DIAGNOSTICS_HPP__ */
@@ -0,0 +1,245 @@
+#include <sstream>
+#include <algorithm>
+#include <iterator>
+#include <typeinfo>
+#include <unordered_map>
+
+#include "lilc_diff.hpp"
+
+namespace LILC{
+
+namespace {
+
+// Statement alignment is quadratic in the size of the changed region;
+// beyond this many cells the region is paired up positionally instead.
+const size_t LCS_LIMIT = 1 << 22;
+
+std::string declName(DeclNode * decl)
+{
+   if (FnDeclNode * fn = dynamic_cast<FnDeclNode *>(decl)){
+      return "fn " + fn->getId()->getName();
+   }
+   if (StructDeclNode * st = dynamic_cast<StructDeclNode *>(decl)){
+      return "struct " + st->getId()->getName();
+   }
+   if (VarDeclNode * var = dynamic_cast<VarDeclNode *>(decl)){
+      return "var " + var->getId()->getName();
+   }
+   return "decl";
+}
+
+// Skips the common prefix and suffix of two lists, one hash compare per
+// element, and copies out what remains. offset is the prefix length.
+template <typename T>
+void trimEqual(std::list<T *> &a, std::list<T *> &b,
+std::vector<T *> &midA, std::vector<T *> &midB, size_t &offset)
+{
+   auto aFirst = a.begin();
+   auto bFirst = b.begin();
+   offset = 0;
+   while (aFirst != a.end() && bFirst != b.end()
+      && (*aFirst)->hash() == (*bFirst)->hash()){
+      ++aFirst;
+      ++bFirst;
+      offset++;
+   }
+   auto aLast = a.end();
+   auto bLast = b.end();
+   while (aLast != aFirst && bLast != bFirst
+      && (*std::prev(aLast))->hash() == (*std::prev(bLast))->hash()){
+      --aLast;
+      --bLast;
+   }
+   midA.assign(aFirst, aLast);
+   midB.assign(bFirst, bLast);
+}
+
+class Differ{
+public:
+   Differ(std::vector<ASTChange> &changes) : changes(changes) { }
+
+   void decls(std::list<DeclNode *> &before, std::list<DeclNode *> &after){
+      std::vector<DeclNode *> a, b;
+      size_t offset;
+      trimEqual(before, after, a, b, offset);
+      std::vector<bool> aUsed(a.size(), false);
+      std::vector<bool> bUsed(b.size(), false);
+
+      // Identical declarations that only moved. Candidates are pushed in
+      // reverse so that back() is always the earliest unused one.
+      std::unordered_map<uint64_t, std::vector<size_t> > byHash;
+      for (size_t i = a.size(); i-- > 0; ){
+         byHash[a[i]->hash()].push_back(i);
+      }
+      for (size_t j = 0; j < b.size(); j++){
+         auto found = byHash.find(b[j]->hash());
+         if (found != byHash.end() && !found->second.empty()){
+            aUsed[found->second.back()] = true;
+            bUsed[j] = true;
+            found->second.pop_back();
+         }
+      }
+
+      // What is left pairs up by kind and name.
+      std::unordered_map<std::string, std::vector<size_t> > byName;
+      for (size_t i = a.size(); i-- > 0; ){
+         if (!aUsed[i]){ byName[declName(a[i])].push_back(i); }
+      }
+      for (size_t j = 0; j < b.size(); j++){
+         if (bUsed[j]){ continue; }
+         std::string name = declName(b[j]);
+         auto found = byName.find(name);
+         if (found == byName.end() || found->second.empty()){
+            add(ASTChange::ADDED, name, ASTChange::NO_STMT, nullptr, b[j]);
+            continue;
+         }
+         size_t i = found->second.back();
+         found->second.pop_back();
+         aUsed[i] = true;
+         add(ASTChange::MODIFIED, name, ASTChange::NO_STMT, a[i], b[j]);
+         FnDeclNode * fnA = dynamic_cast<FnDeclNode *>(a[i]);
+         FnDeclNode * fnB = dynamic_cast<FnDeclNode *>(b[j]);
+         if (fnA != nullptr && fnB != nullptr){
+            stmts(name, fnA->getFnBody()->getStmtList(),
+               fnB->getFnBody()->getStmtList());
+         }
+      }
+      for (size_t i = 0; i < a.size(); i++){
+         if (!aUsed[i]){
+            add(ASTChange::REMOVED, declName(a[i]), ASTChange::NO_STMT,
+               a[i], nullptr);
+         }
+      }
+   }
+
+private:
+   void stmts(const std::string &decl, StmtListNode * before,
+   StmtListNode * after){
+      if (before->hash() == after->hash()){ return; }
+      std::vector<StmtNode *> a, b;
+      size_t offset;
+      trimEqual(*before->getStmts(), *after->getStmts(), a, b, offset);
+
+      size_t n = a.size();
+      size_t m = b.size();
+      std::vector<StmtNode *> runA, runB;
+      size_t runAStart = offset;
+      size_t runBStart = offset;
+      if ((n + 1) * (m + 1) > LCS_LIMIT){
+         pairUp(decl, a, offset, b, offset);
+         return;
+      }
+      // lcs[i * (m + 1) + j] is the LCS length of a[i..] and b[j..].
+      std::vector<unsigned> lcs((n + 1) * (m + 1), 0);
+      for (size_t i = n; i-- > 0; ){
+         for (size_t j = m; j-- > 0; ){
+            size_t cell = i * (m + 1) + j;
+            if (a[i]->hash() == b[j]->hash()){
+               lcs[cell] = lcs[cell + m + 2] + 1;
+            } else {
+               lcs[cell] = std::max(lcs[cell + m + 1], lcs[cell + 1]);
+            }
+         }
+      }
+      size_t i = 0;
+      size_t j = 0;
+      while (i < n || j < m){
+         if (i < n && j < m && a[i]->hash() == b[j]->hash()){
+            pairUp(decl, runA, runAStart, runB, runBStart);
+            runA.clear();
+            runB.clear();
+            i++;
+            j++;
+            runAStart = offset + i;
+            runBStart = offset + j;
+         } else if (j == m
+            || (i < n && lcs[(i + 1) * (m + 1) + j] >= lcs[i * (m + 1) + j + 1])){
+            runA.push_back(a[i++]);
+         } else {
+            runB.push_back(b[j++]);
+         }
+      }
+      pairUp(decl, runA, runAStart, runB, runBStart);
+   }
+
+   // Reports a region of unmatched statements. Statements of the same kind
+   // at the same position count as modified.
+   void pairUp(const std::string &decl, const std::vector<StmtNode *> &a,
+   size_t aStart, const std::vector<StmtNode *> &b, size_t bStart){
+      size_t k = 0;
+      for (; k < a.size() && k < b.size(); k++){
+         if (typeid(*a[k]) == typeid(*b[k])){
+            add(ASTChange::MODIFIED, decl, bStart + k, a[k], b[k]);
+         } else {
+            add(ASTChange::REMOVED, decl, aStart + k, a[k], nullptr);
+            add(ASTChange::ADDED, decl, bStart + k, nullptr, b[k]);
+         }
+      }
+      for (size_t r = k; r < a.size(); r++){
+         add(ASTChange::REMOVED, decl, aStart + r, a[r], nullptr);
+      }
+      for (size_t r = k; r < b.size(); r++){
+         add(ASTChange::ADDED, decl, bStart + r, nullptr, b[r]);
+      }
+   }
+
+   void add(ASTChange::Kind kind, const std::string &decl, size_t stmt,
+   ASTNode * before, ASTNode * after){
+      ASTChange change;
+      change.kind = kind;
+      change.decl = decl;
+      change.stmt = stmt;
+      change.before = before;
+      change.after = after;
+      changes.push_back(change);
+   }
+
+   std::vector<ASTChange> &changes;
+};
+
+std::string firstLine(ASTNode * node)
+{
+   std::ostringstream text;
+   node->unparse(text, 0);
+   std::string line = text.str();
+   line = line.substr(0, line.find('\n'));
+   size_t start = line.find_first_not_of(' ');
+   return start == std::string::npos ? std::string() : line.substr(start);
+}
+
+} /* end anonymous namespace */
+
+std::vector<ASTChange> diffPrograms(ProgramNode * before, ProgramNode * after)
+{
+   std::vector<ASTChange> changes;
+   if (before->hash() == after->hash()){
+      return changes;
+   }
+   Differ differ(changes);
+   differ.decls(*before->getDeclList()->getDecls(),
+      *after->getDeclList()->getDecls());
+   return changes;
+}
+
+void printChanges(const std::vector<ASTChange> &changes, std::ostream &out)
+{
+   std::string buf;
+   for (const ASTChange &c : changes){
+      char sign = c.kind == ASTChange::ADDED ? '+'
+         : c.kind == ASTChange::REMOVED ? '-' : '~';
+      if (c.stmt == ASTChange::NO_STMT){
+         buf += sign;
+         buf += ' ';
+         buf += c.decl;
+      } else {
+         buf += "    ";
+         buf += sign;
+         buf += " stmt " + std::to_string(c.stmt + 1) + ": ";
+         buf += firstLine(c.after != nullptr ? c.after : c.before);
+      }
+      buf += '\n';
+   }
+   out.write(buf.data(), buf.size());
+}
+
+} /* end namespace */
@@ -0,0 +1,44 @@
+#ifndef __LILC_DIFF_HPP__
+#define __LILC_DIFF_HPP__ 1
+
+#include <string>
+#include <vector>
+#include <ostream>
+#include <cstddef>
+
+#include "ast.hpp"
+
+namespace LILC{
+
+// One difference between two versions of a program: a top-level
+// declaration, or a statement of a function body, that was added,
+// removed or modified.
+struct ASTChange{
+   enum Kind { ADDED, REMOVED, MODIFIED };
+   static const size_t NO_STMT = (size_t)-1;
+
+   Kind kind;
+   // Kind and name of the top-level declaration, e.g. "fn main".
+   std::string decl;
+   // For statement changes, the 0-based index of the statement in the
+   // function body (in the old program for removals, in the new one
+   // otherwise); NO_STMT for declaration level changes.
+   size_t stmt;
+   ASTNode * before;
+   ASTNode * after;
+};
+
+// Compares two programs using the subtree hashes. Runs of equal
+// declarations are skipped with one hash compare each and unchanged
+// subtrees are never descended into, so the work beyond that walk is
+// proportional to the size of the change. Declarations are matched by
+// kind and name; statements of a modified function are aligned by a
+// longest common subsequence over their hashes.
+std::vector<ASTChange> diffPrograms(ProgramNode * before, ProgramNode * after);
+
+// Writes one line per change: "+", "-" or "~", the declaration, and for
+// statements their 1-based index and first unparsed line.
+void printChanges(const std::vector<ASTChange> &changes, std::ostream &out);
+
+} /* end namespace */
+#endif /* END __LILC_DIFF_HPP__ */
@@ -0,0 +1,1425 @@
+#include <cstdlib>
+#include <sstream>
+#include <iostream>
+#include <algorithm>
+#include <functional>
+#include <sys/resource.h>
+
+#include "lilc_engine.hpp"
+#include "lilc_timing.hpp"
+#include "lilc_compiler.hpp"
+#include "lilc_selfprofile.hpp"
+
+namespace LILC{
+
+class Machine{
+public:
+   Word * fp;
+   Word * sp;
+   Word * limit;
+   Word * globals;
+   Word ret;
+   // A call whose native frame lies below this address would come too
+   // close to the end of the process's stack
+   uintptr_t stackFloor;
+   std::string out;
+   std::ostream * sink;
+   std::istream * in;
+};
+
+namespace {
+
+const size_t STACK_SLOTS = (size_t)1 << 22;
+const size_t OUT_BUFFER = (size_t)1 << 16;
+// Native stack kept back from the deepest call, and the size assumed
+// when the stack's limit is unlimited
+const size_t STACK_MARGIN = (size_t)256 << 10;
+const size_t STACK_CAP = (size_t)64 << 20;
+
+// For runtime errors, which end the process: its output so far is
+// written first
+Machine * running = nullptr;
+
+void flushOutput(Machine &m)
+{
+   m.sink->write(m.out.data(), m.out.size());
+   m.out.clear();
+}
+
+[[noreturn]] void runtimeError(const char * what)
+{
+   if (running != nullptr){
+      flushOutput(*running);
+      running->sink->flush();
+   }
+   std::cerr << "Runtime error: " << what << "\n";
+   exit(EXIT_FAILURE);
+}
+
+uintptr_t nativeStackFloor()
+{
+   size_t size = STACK_CAP;
+   rlimit limit;
+   if (getrlimit(RLIMIT_STACK, &limit) == 0
+      && limit.rlim_cur != RLIM_INFINITY){
+      size = std::min(size, (size_t)limit.rlim_cur);
+   }
+   char here;
+   return (uintptr_t)&here - (size - std::min(size, 2 * STACK_MARGIN));
+}
+
+inline Word eval(const ExpCode * code, Machine &m)
+{
+   return code->eval(code, m);
+}
+
+inline bool run(const StmtCode * code, Machine &m)
+{
+   return code->run(code, m);
+}
+
+template <Storage S>
+inline Word & slot(Machine &m, int32_t i)
+{
+   return S == LOCAL ? m.fp[i] : m.globals[i];
+}
+
+// Operators, on 32-bit words that wrap around
+struct Add{
+   static Word apply(Word a, Word b){ return (Word)((uint32_t)a + (uint32_t)b); }
+};
+struct Sub{
+   static Word apply(Word a, Word b){ return (Word)((uint32_t)a - (uint32_t)b); }
+};
+struct Mul{
+   static Word apply(Word a, Word b){ return (Word)((uint32_t)a * (uint32_t)b); }
+};
+struct Div{
+   static Word apply(Word a, Word b){
+      if (b == 0){
+         runtimeError("division by zero");
+      }
+      return b == -1 ? (Word)(0u - (uint32_t)a) : a / b;
+   }
+};
+struct Eq{
+   static Word apply(Word a, Word b){ return a == b; }
+};
+struct Ne{
+   static Word apply(Word a, Word b){ return a != b; }
+};
+struct Lt{
+   static Word apply(Word a, Word b){ return a < b; }
+};
+struct Gt{
+   static Word apply(Word a, Word b){ return a > b; }
+};
+struct Le{
+   static Word apply(Word a, Word b){ return a <= b; }
+};
+struct Ge{
+   static Word apply(Word a, Word b){ return a >= b; }
+};
+
+// Whether a op b can be worked out at compile time
+template <typename Op> bool folds(Word){ return true; }
+template <> bool folds<Div>(Word b){ return b != 0; }
+
+/* Expression records and the functions that evaluate them */
+
+struct Const : ExpCode{
+   Word value;
+};
+
+struct Text : ExpCode{
+   std::string text;
+};
+
+struct Load : ExpCode{
+   int32_t slot;
+};
+
+struct Store : ExpCode{
+   int32_t slot;
+   const ExpCode * value;
+};
+
+struct Binary : ExpCode{
+   const ExpCode * left;
+   const ExpCode * right;
+};
+
+struct BinaryConst : ExpCode{
+   const ExpCode * left;
+   Word right;
+};
+
+struct LocalConst : ExpCode{
+   int32_t left;
+   Word right;
+};
+
+struct LocalLocal : ExpCode{
+   int32_t left;
+   int32_t right;
+};
+
+struct Unary : ExpCode{
+   const ExpCode * operand;
+};
+
+struct Call : ExpCode{
+   const FunctionCode * function;
+   std::vector<const ExpCode *> args;
+};
+
+Word evalConst(const ExpCode * code, Machine &)
+{
+   return static_cast<const Const *>(code)->value;
+}
+
+// Strings can only be written, which takes their text from the record
+Word evalText(const ExpCode *, Machine &)
+{
+   return 0;
+}
+
+template <Storage S>
+Word evalLoad(const ExpCode * code, Machine &m)
+{
+   return slot<S>(m, static_cast<const Load *>(code)->slot);
+}
+
+template <Storage S>
+Word evalStore(const ExpCode * code, Machine &m)
+{
+   const Store * store = static_cast<const Store *>(code);
+   Word value = eval(store->value, m);
+   slot<S>(m, store->slot) = value;
+   return value;
+}
+
+template <typename Op>
+Word evalBinary(const ExpCode * code, Machine &m)
+{
+   const Binary * b = static_cast<const Binary *>(code);
+   Word left = eval(b->left, m);
+   return Op::apply(left, eval(b->right, m));
+}
+
+template <typename Op>
+Word evalBinaryConst(const ExpCode * code, Machine &m)
+{
+   const BinaryConst * b = static_cast<const BinaryConst *>(code);
+   return Op::apply(eval(b->left, m), b->right);
+}
+
+template <typename Op>
+Word evalLocalConst(const ExpCode * code, Machine &m)
+{
+   const LocalConst * b = static_cast<const LocalConst *>(code);
+   return Op::apply(m.fp[b->left], b->right);
+}
+
+template <typename Op>
+Word evalLocalLocal(const ExpCode * code, Machine &m)
+{
+   const LocalLocal * b = static_cast<const LocalLocal *>(code);
+   return Op::apply(m.fp[b->left], m.fp[b->right]);
+}
+
+Word evalAnd(const ExpCode * code, Machine &m)
+{
+   const Binary * b = static_cast<const Binary *>(code);
+   return eval(b->left, m) && eval(b->right, m);
+}
+
+Word evalOr(const ExpCode * code, Machine &m)
+{
+   const Binary * b = static_cast<const Binary *>(code);
+   return eval(b->left, m) || eval(b->right, m);
+}
+
+Word evalNot(const ExpCode * code, Machine &m)
+{
+   return !eval(static_cast<const Unary *>(code)->operand, m);
+}
+
+Word evalNegate(const ExpCode * code, Machine &m)
+{
+   return Sub::apply(0, eval(static_cast<const Unary *>(code)->operand, m));
+}
+
+// The arguments are evaluated into the new frame, each one claiming its
+// slot before the next is evaluated so that calls among them build their
+// frames above it. The rest of the frame is zeroed.
+Word evalCall(const ExpCode * code, Machine &m)
+{
+   const Call * call = static_cast<const Call *>(code);
+   const FunctionCode * function = call->function;
+   Word * base = m.sp;
+   char here;
+   if (function->frameSize > m.limit - base
+      || (uintptr_t)&here < m.stackFloor){
+      runtimeError("call stack overflow");
+   }
+   for (const ExpCode * arg : call->args){
+      Word value = eval(arg, m);
+      *m.sp++ = value;
+   }
+   std::fill(m.sp, base + function->frameSize, 0);
+   Word * caller = m.fp;
+   m.fp = base;
+   m.sp = base + function->frameSize;
+   m.ret = 0;
+   run(function->body, m);
+   m.fp = caller;
+   m.sp = base;
+   return m.ret;
+}
+
+/* Statement records and the functions that run them */
+
+struct ExpStmt : StmtCode{
+   const ExpCode * exp;
+};
+
+struct StoreStmt : StmtCode{
+   int32_t slot;
+   const ExpCode * value;
+};
+
+struct StepStmt : StmtCode{
+   int32_t slot;
+   Word delta;
+};
+
+struct ReadStmt : StmtCode{
+   int32_t slot;
+   bool boolean;
+};
+
+struct WriteStmt : StmtCode{
+   const ExpCode * value;
+};
+
+struct WriteText : StmtCode{
+   std::string text;
+};
+
+struct IfStmt : StmtCode{
+   const ExpCode * cond;
+   const StmtCode * then;
+   const StmtCode * otherwise;
+};
+
+struct WhileStmt : StmtCode{
+   const ExpCode * cond;
+   const StmtCode * body;
+};
+
+struct ReturnStmt : StmtCode{
+   const ExpCode * value;
+};
+
+struct Sequence : StmtCode{
+   std::vector<const StmtCode *> stmts;
+};
+
+struct ScopeStmt : StmtCode{
+   int32_t first;
+   int32_t count;
+   const StmtCode * body;
+};
+
+bool runNothing(const StmtCode *, Machine &)
+{
+   return false;
+}
+
+bool runExp(const StmtCode * code, Machine &m)
+{
+   eval(static_cast<const ExpStmt *>(code)->exp, m);
+   return false;
+}
+
+template <Storage S>
+bool runStore(const StmtCode * code, Machine &m)
+{
+   const StoreStmt * store = static_cast<const StoreStmt *>(code);
+   Word value = eval(store->value, m);
+   slot<S>(m, store->slot) = value;
+   return false;
+}
+
+template <Storage S>
+bool runStep(const StmtCode * code, Machine &m)
+{
+   const StepStmt * step = static_cast<const StepStmt *>(code);
+   Word &value = slot<S>(m, step->slot);
+   value = Add::apply(value, step->delta);
+   return false;
+}
+
+// Anything written so far goes out before the program waits for input.
+// A bool reads as an int, true unless 0; what does not read as an int
+// reads as 0.
+template <Storage S>
+bool runRead(const StmtCode * code, Machine &m)
+{
+   const ReadStmt * read = static_cast<const ReadStmt *>(code);
+   flushOutput(m);
+   m.sink->flush();
+   Word value = 0;
+   if (!(*m.in >> value)){
+      value = 0;
+   }
+   slot<S>(m, read->slot) = read->boolean ? value != 0 : value;
+   return false;
+}
+
+bool runWrite(const StmtCode * code, Machine &m)
+{
+   Word value = eval(static_cast<const WriteStmt *>(code)->value, m);
+   char digits[12];
+   char * end = digits + sizeof(digits);
+   char * p = end;
+   uint32_t magnitude = value < 0 ? 0u - (uint32_t)value : (uint32_t)value;
+   do {
+      *--p = '0' + magnitude % 10;
+      magnitude /= 10;
+   } while (magnitude != 0);
+   if (value < 0){
+      *--p = '-';
+   }
+   m.out.append(p, end - p);
+   if (m.out.size() >= OUT_BUFFER){
+      flushOutput(m);
+   }
+   return false;
+}
+
+bool runWriteText(const StmtCode * code, Machine &m)
+{
+   m.out += static_cast<const WriteText *>(code)->text;
+   if (m.out.size() >= OUT_BUFFER){
+      flushOutput(m);
+   }
+   return false;
+}
+
+bool runIf(const StmtCode * code, Machine &m)
+{
+   const IfStmt * stmt = static_cast<const IfStmt *>(code);
+   return eval(stmt->cond, m) && run(stmt->then, m);
+}
+
+bool runIfElse(const StmtCode * code, Machine &m)
+{
+   const IfStmt * stmt = static_cast<const IfStmt *>(code);
+   return eval(stmt->cond, m)
+      ? run(stmt->then, m) : run(stmt->otherwise, m);
+}
+
+bool runWhile(const StmtCode * code, Machine &m)
+{
+   const WhileStmt * stmt = static_cast<const WhileStmt *>(code);
+   while (eval(stmt->cond, m)){
+      if (run(stmt->body, m)){
+         return true;
+      }
+   }
+   return false;
+}
+
+bool runReturn(const StmtCode * code, Machine &m)
+{
+   m.ret = eval(static_cast<const ReturnStmt *>(code)->value, m);
+   return true;
+}
+
+bool runReturnVoid(const StmtCode *, Machine &)
+{
+   return true;
+}
+
+bool runSequence(const StmtCode * code, Machine &m)
+{
+   for (const StmtCode * stmt : static_cast<const Sequence *>(code)->stmts){
+      if (run(stmt, m)){
+         return true;
+      }
+   }
+   return false;
+}
+
+// A block's locals start out 0 each time it is entered
+bool runScope(const StmtCode * code, Machine &m)
+{
+   const ScopeStmt * scope = static_cast<const ScopeStmt *>(code);
+   std::fill(m.fp + scope->first, m.fp + scope->first + scope->count, 0);
+   return run(scope->body, m);
+}
+
+const ValueType ERROR_VALUE = { ERROR_TYPE, nullptr };
+const Place NO_PLACE = { NOWHERE, 0, ERROR_VALUE };
+
+bool isConst(const ExpCode * code)
+{
+   return code->eval == evalConst;
+}
+
+bool isLocal(const ExpCode * code)
+{
+   return code->eval == evalLoad<LOCAL>;
+}
+
+Word constValue(const ExpCode * code)
+{
+   return static_cast<const Const *>(code)->value;
+}
+
+int32_t loadSlot(const ExpCode * code)
+{
+   return static_cast<const Load *>(code)->slot;
+}
+
+int32_t slots(ValueType type)
+{
+   return type.base == STRUCT_TYPE ? type.layout->size : 1;
+}
+
+// The text a string literal (quotes included) writes
+std::string decodeString(const std::string &literal)
+{
+   std::string text;
+   size_t end = literal.size() > 0 && literal.back() == '"'
+      ? literal.size() - 1 : literal.size();
+   for (size_t i = 1; i < end; i++){
+      char c = literal[i];
+      if (c == '\\' && i + 1 < end){
+         switch (literal[++i]){
+            case 'n': c = '\n'; break;
+            case 't': c = '\t'; break;
+            default: c = literal[i]; break;
+         }
+      }
+      text += c;
+   }
+   return text;
+}
+
+} /* end anonymous namespace */
+
+ClosureCompiler::ClosureCompiler(Diagnostics &diagnostics,
+const LineIndex * lines)
+: myDiagnostics(diagnostics), myLines(lines)
+{
+   Const * zero = make<Const>();
+   zero->eval = evalConst;
+   zero->value = 0;
+   myZero = zero;
+   StmtCode * nothing = make<StmtCode>();
+   nothing->run = runNothing;
+   myNothing = nothing;
+   myScopes.emplace_back();
+   myScopeStarts.push_back(0);
+}
+
+ClosureCompiler::~ClosureCompiler()
+{
+}
+
+template <typename T>
+T * ClosureCompiler::make()
+{
+   std::shared_ptr<T> record = std::make_shared<T>();
+   myRecords.push_back(record);
+   return record.get();
+}
+
+bool ClosureCompiler::declaring() const
+{
+   return myPass == DECLARE || myFunction != nullptr;
+}
+
+void ClosureCompiler::error(ASTNode * at, const std::string &msg)
+{
+   error(at->span().offset, msg);
+}
+
+void ClosureCompiler::error(size_t offset, const std::string &msg)
+{
+   Position pos = myLines != nullptr ? myLines->position(offset)
+      : Position{0, 0};
+   myDiagnostics.error(pos.line, pos.col, msg);
+   myErrors++;
+}
+
+const ClosureCompiler::Symbol *
+ClosureCompiler::lookup(const std::string &name) const
+{
+   for (auto scope = myScopes.rbegin(); scope != myScopes.rend(); ++scope){
+      auto found = scope->find(name);
+      if (found != scope->end()){
+         return &found->second;
+      }
+   }
+   return nullptr;
+}
+
+void ClosureCompiler::declare(IdNode * id, const Symbol &symbol)
+{
+   if (!myScopes.back().emplace(id->getName(), symbol).second){
+      error(id, "Multiply declared identifier");
+   }
+}
+
+Place ClosureCompiler::allocate(ValueType type)
+{
+   if (myFunction == nullptr){
+      Place place = { GLOBAL, myGlobalSlots, type };
+      myGlobalSlots += slots(type);
+      return place;
+   }
+   Place place = { LOCAL, myNextSlot, type };
+   myNextSlot += slots(type);
+   myFunction->frameSize = std::max(myFunction->frameSize, myNextSlot);
+   return place;
+}
+
+void ClosureCompiler::declareVariable(IdNode * id, ValueType type)
+{
+   if (type.base == VOID_TYPE){
+      error(id, "Non-function declared void");
+      type = ERROR_VALUE;
+   }
+   if (myStruct != nullptr){
+      StructLayout::Field field = { myStruct->size, type };
+      if (!myStruct->fields.emplace(id->getName(), field).second){
+         error(id, "Multiply declared identifier");
+         return;
+      }
+      myStruct->size += slots(type);
+      return;
+   }
+   Symbol symbol = { allocate(type), nullptr };
+   declare(id, symbol);
+}
+
+void ClosureCompiler::declareFormal(IdNode * id, ValueType type)
+{
+   if (myPass == DECLARE){
+      if (type.base == VOID_TYPE){
+         error(id, "Non-function declared void");
+         type = ERROR_VALUE;
+      }
+      myFunction->params.push_back(type);
+      return;
+   }
+   Symbol symbol = { allocate(type), nullptr };
+   declare(id, symbol);
+}
+
+ValueType ClosureCompiler::structType(IdNode * id)
+{
+   auto found = myStructs.find(id->getName());
+   if (found == myStructs.end()){
+      error(id, "Invalid name of struct type");
+      return ERROR_VALUE;
+   }
+   return ValueType{ STRUCT_TYPE, found->second.get() };
+}
+
+void ClosureCompiler::beginStruct(IdNode * id)
+{
+   if (myStructs.count(id->getName()) != 0){
+      error(id, "Multiply declared identifier");
+   }
+   myStruct = new StructLayout();
+   myStruct->name = id->getName();
+}
+
+void ClosureCompiler::endStruct()
+{
+   std::unique_ptr<StructLayout> layout(myStruct);
+   myStruct = nullptr;
+   if (myStructs.count(layout->name) == 0){
+      myStructs[layout->name] = std::move(layout);
+   }
+}
+
+void ClosureCompiler::beginFunction(IdNode * id, ValueType result)
+{
+   std::unique_ptr<FunctionCode> &function = myFunctions[id];
+   if (myPass == DECLARE){
+      function.reset(new FunctionCode());
+      function->name = id->getName();
+      function->result = result;
+      Symbol symbol = { NO_PLACE, function.get() };
+      declare(id, symbol);
+   }
+   myFunction = function.get();
+   myScopes.emplace_back();
+   myScopeStarts.push_back(0);
+   myNextSlot = 0;
+}
+
+void ClosureCompiler::endFunction(const StmtCode * body)
+{
+   if (body != nullptr){
+      myFunction->body = body;
+   }
+   myScopes.pop_back();
+   myScopeStarts.pop_back();
+   myFunction = nullptr;
+}
+
+void ClosureCompiler::beginScope()
+{
+   myScopes.emplace_back();
+   myScopeStarts.push_back(myNextSlot);
+}
+
+const StmtCode * ClosureCompiler::endScope(const StmtCode * body)
+{
+   int32_t first = myScopeStarts.back();
+   int32_t count = myNextSlot - first;
+   myScopes.pop_back();
+   myScopeStarts.pop_back();
+   myNextSlot = first;
+   if (count == 0){
+      return body;
+   }
+   ScopeStmt * scope = make<ScopeStmt>();
+   scope->run = runScope;
+   scope->first = first;
+   scope->count = count;
+   scope->body = body;
+   return scope;
+}
+
+Typed ClosureCompiler::constant(Word value, BaseType type)
+{
+   Const * code = make<Const>();
+   code->eval = evalConst;
+   code->value = value;
+   return Typed{ code, ValueType{ type, nullptr } };
+}
+
+Typed ClosureCompiler::string(const std::string &literal)
+{
+   Text * code = make<Text>();
+   code->eval = evalText;
+   code->text = decodeString(literal);
+   return Typed{ code, ValueType{ STRING_TYPE, nullptr } };
+}
+
+Place ClosureCompiler::variable(IdNode * id)
+{
+   const Symbol * symbol = lookup(id->getName());
+   if (symbol == nullptr){
+      error(id, "Undeclared identifier");
+      return NO_PLACE;
+   }
+   if (symbol->function != nullptr){
+      error(id, "Function name used as a variable");
+      return NO_PLACE;
+   }
+   return symbol->place;
+}
+
+Place ClosureCompiler::field(const Place &base, IdNode * id)
+{
+   if (base.type.base == ERROR_TYPE){
+      return NO_PLACE;
+   }
+   if (base.type.base != STRUCT_TYPE){
+      error(id, "Dot-access of non-struct type");
+      return NO_PLACE;
+   }
+   auto found = base.type.layout->fields.find(id->getName());
+   if (found == base.type.layout->fields.end()){
+      error(id, "Invalid struct field name");
+      return NO_PLACE;
+   }
+   return Place{ base.storage, base.slot + found->second.offset,
+      found->second.type };
+}
+
+Typed ClosureCompiler::load(const Place &place)
+{
+   if (place.storage == NOWHERE || place.type.base == STRUCT_TYPE){
+      return Typed{ myZero, place.type };
+   }
+   Load * code = make<Load>();
+   code->eval = place.storage == LOCAL ? evalLoad<LOCAL> : evalLoad<GLOBAL>;
+   code->slot = place.slot;
+   return Typed{ code, place.type };
+}
+
+Typed ClosureCompiler::assign(const Place &place, Typed value, ASTNode * at)
+{
+   if (place.type.base == ERROR_TYPE || value.type.base == ERROR_TYPE){
+      return Typed{ myZero, ERROR_VALUE };
+   }
+   if (place.type.base == STRUCT_TYPE && value.type.base == STRUCT_TYPE){
+      error(at, "Struct variable assignment");
+      return Typed{ myZero, ERROR_VALUE };
+   }
+   if (place.type.base != value.type.base){
+      error(at, "Type mismatch");
+      return Typed{ myZero, ERROR_VALUE };
+   }
+   Store * code = make<Store>();
+   code->eval = place.storage == LOCAL ? evalStore<LOCAL> : evalStore<GLOBAL>;
+   code->slot = place.slot;
+   code->value = value.code;
+   return Typed{ code, place.type };
+}
+
+Typed ClosureCompiler::call(IdNode * id, std::vector<Typed> &args,
+ASTNode * at)
+{
+   const Symbol * symbol = lookup(id->getName());
+   if (symbol == nullptr){
+      error(id, "Undeclared identifier");
+      return Typed{ myZero, ERROR_VALUE };
+   }
+   if (symbol->function == nullptr){
+      error(id, "Attempt to call a non-function");
+      return Typed{ myZero, ERROR_VALUE };
+   }
+   FunctionCode * function = symbol->function;
+   Typed result = { myZero, function->result };
+   if (args.size() != function->params.size()){
+      error(at, "Function call with wrong number of args");
+      return result;
+   }
+   bool ok = true;
+   for (size_t i = 0; i < args.size(); i++){
+      BaseType want = function->params[i].base;
+      BaseType have = args[i].type.base;
+      if (have != want && have != ERROR_TYPE && want != ERROR_TYPE){
+         error(at, "Type of actual does not match type of formal");
+      }
+      ok = ok && have == want;
+   }
+   if (!ok){
+      return result;
+   }
+   Call * code = make<Call>();
+   code->eval = evalCall;
+   code->function = function;
+   for (const Typed &arg : args){
+      code->args.push_back(arg.code);
+   }
+   result.code = code;
+   return result;
+}
+
+bool ClosureCompiler::check(Typed exp, BaseType want, ASTNode * at,
+const char * what)
+{
+   if (exp.type.base == want){
+      return true;
+   }
+   if (exp.type.base != ERROR_TYPE){
+      error(at, what);
+   }
+   return false;
+}
+
+Typed ClosureCompiler::unary(NodeKind op, Typed operand, ASTNode * at)
+{
+   bool negate = op == UNARY_MINUS_NODE;
+   BaseType type = negate ? INT_TYPE : BOOL_TYPE;
+   if (!check(operand, type, at, negate
+      ? "Arithmetic operator applied to non-numeric operand"
+      : "Logical operator applied to non-bool operand")){
+      return Typed{ myZero, ERROR_VALUE };
+   }
+   if (isConst(operand.code)){
+      Word value = constValue(operand.code);
+      return constant(negate ? Sub::apply(0, value) : !value, type);
+   }
+   Unary * code = make<Unary>();
+   code->eval = negate ? evalNegate : evalNot;
+   code->operand = operand.code;
+   return Typed{ code, ValueType{ type, nullptr } };
+}
+
+template <typename Op>
+const ExpCode * ClosureCompiler::operation(const ExpCode * left,
+const ExpCode * right)
+{
+   if (isConst(right)){
+      Word value = constValue(right);
+      if (isConst(left) && folds<Op>(value)){
+         Const * code = make<Const>();
+         code->eval = evalConst;
+         code->value = Op::apply(constValue(left), value);
+         return code;
+      }
+      if (isLocal(left)){
+         LocalConst * code = make<LocalConst>();
+         code->eval = evalLocalConst<Op>;
+         code->left = loadSlot(left);
+         code->right = value;
+         return code;
+      }
+      BinaryConst * code = make<BinaryConst>();
+      code->eval = evalBinaryConst<Op>;
+      code->left = left;
+      code->right = value;
+      return code;
+   }
+   if (isLocal(left) && isLocal(right)){
+      LocalLocal * code = make<LocalLocal>();
+      code->eval = evalLocalLocal<Op>;
+      code->left = loadSlot(left);
+      code->right = loadSlot(right);
+      return code;
+   }
+   Binary * code = make<Binary>();
+   code->eval = evalBinary<Op>;
+   code->left = left;
+   code->right = right;
+   return code;
+}
+
+Typed ClosureCompiler::binary(NodeKind op, Typed left, Typed right,
+ASTNode * at)
+{
+   const Typed failed = { myZero, ERROR_VALUE };
+   const ValueType INT = { INT_TYPE, nullptr };
+   const ValueType BOOL = { BOOL_TYPE, nullptr };
+   switch (op){
+      case PLUS_NODE: case MINUS_NODE: case TIMES_NODE: case DIVIDE_NODE:
+      {
+         const char * what =
+            "Arithmetic operator applied to non-numeric operand";
+         bool ok = check(left, INT_TYPE, at, what);
+         if (!(check(right, INT_TYPE, at, what) && ok)){
+            return failed;
+         }
+         const ExpCode * code =
+            op == PLUS_NODE ? operation<Add>(left.code, right.code)
+            : op == MINUS_NODE ? operation<Sub>(left.code, right.code)
+            : op == TIMES_NODE ? operation<Mul>(left.code, right.code)
+            : operation<Div>(left.code, right.code);
+         return Typed{ code, INT };
+      }
+      case LESS_NODE: case GREATER_NODE: case LESS_EQ_NODE:
+      case GREATER_EQ_NODE:
+      {
+         const char * what =
+            "Relational operator applied to non-numeric operand";
+         bool ok = check(left, INT_TYPE, at, what);
+         if (!(check(right, INT_TYPE, at, what) && ok)){
+            return failed;
+         }
+         const ExpCode * code =
+            op == LESS_NODE ? operation<Lt>(left.code, right.code)
+            : op == GREATER_NODE ? operation<Gt>(left.code, right.code)
+            : op == LESS_EQ_NODE ? operation<Le>(left.code, right.code)
+            : operation<Ge>(left.code, right.code);
+         return Typed{ code, BOOL };
+      }
+      case EQUALS_NODE: case NOT_EQUALS_NODE:
+      {
+         BaseType a = left.type.base;
+         BaseType b = right.type.base;
+         if (a == ERROR_TYPE || b == ERROR_TYPE){
+            return failed;
+         }
+         if (a == VOID_TYPE || b == VOID_TYPE){
+            error(at, "Equality operator applied to void functions");
+            return failed;
+         }
+         if (a == STRUCT_TYPE || b == STRUCT_TYPE){
+            error(at, "Equality operator applied to struct variables");
+            return failed;
+         }
+         if (a == STRING_TYPE || b == STRING_TYPE){
+            error(at, "Equality operator applied to string literals");
+            return failed;
+         }
+         if (a != b){
+            error(at, "Type mismatch");
+            return failed;
+         }
+         const ExpCode * code = op == EQUALS_NODE
+            ? operation<Eq>(left.code, right.code)
+            : operation<Ne>(left.code, right.code);
+         return Typed{ code, BOOL };
+      }
+      case AND_NODE: case OR_NODE:
+      {
+         const char * what = "Logical operator applied to non-bool operand";
+         bool ok = check(left, BOOL_TYPE, at, what);
+         if (!(check(right, BOOL_TYPE, at, what) && ok)){
+            return failed;
+         }
+         // The right operand only runs when the left does not decide
+         if (isConst(left.code)){
+            bool decides = (constValue(left.code) != 0) == (op == OR_NODE);
+            return decides ? left : right;
+         }
+         Binary * code = make<Binary>();
+         code->eval = op == AND_NODE ? evalAnd : evalOr;
+         code->left = left.code;
+         code->right = right.code;
+         return Typed{ code, BOOL };
+      }
+      default:
+         return failed;
+   }
+}
+
+const StmtCode * ClosureCompiler::evaluate(Typed exp)
+{
+   if (exp.code == myZero || isConst(exp.code)){
+      return myNothing;
+   }
+   // x = e; as a store, and x = x + c; on a local as a step
+   if (exp.code->eval == evalStore<LOCAL> || exp.code->eval == evalStore<GLOBAL>){
+      const Store * store = static_cast<const Store *>(exp.code);
+      bool local = exp.code->eval == evalStore<LOCAL>;
+      const ExpCode * value = store->value;
+      if (local && (value->eval == evalLocalConst<Add>
+         || value->eval == evalLocalConst<Sub>)
+         && static_cast<const LocalConst *>(value)->left == store->slot){
+         Word delta = static_cast<const LocalConst *>(value)->right;
+         StepStmt * code = make<StepStmt>();
+         code->run = runStep<LOCAL>;
+         code->slot = store->slot;
+         code->delta = value->eval == evalLocalConst<Add>
+            ? delta : Sub::apply(0, delta);
+         return code;
+      }
+      StoreStmt * code = make<StoreStmt>();
+      code->run = local ? runStore<LOCAL> : runStore<GLOBAL>;
+      code->slot = store->slot;
+      code->value = value;
+      return code;
+   }
+   ExpStmt * code = make<ExpStmt>();
+   code->run = runExp;
+   code->exp = exp.code;
+   return code;
+}
+
+const StmtCode * ClosureCompiler::step(const Place &place, Word delta,
+ASTNode * at)
+{
+   if (!check(Typed{ myZero, place.type }, INT_TYPE, at,
+      "Arithmetic operator applied to non-numeric operand")){
+      return myNothing;
+   }
+   StepStmt * code = make<StepStmt>();
+   code->run = place.storage == LOCAL ? runStep<LOCAL> : runStep<GLOBAL>;
+   code->slot = place.slot;
+   code->delta = delta;
+   return code;
+}
+
+const StmtCode * ClosureCompiler::read(const Place &place, ASTNode * at)
+{
+   BaseType type = place.type.base;
+   if (type == STRUCT_TYPE){
+      error(at, "Attempt to read a struct variable");
+   }
+   if (type != INT_TYPE && type != BOOL_TYPE){
+      return myNothing;
+   }
+   ReadStmt * code = make<ReadStmt>();
+   code->run = place.storage == LOCAL ? runRead<LOCAL> : runRead<GLOBAL>;
+   code->slot = place.slot;
+   code->boolean = type == BOOL_TYPE;
+   return code;
+}
+
+const StmtCode * ClosureCompiler::write(Typed value, ASTNode * at)
+{
+   switch (value.type.base){
+      case INT_TYPE: case BOOL_TYPE:
+      {
+         WriteStmt * code = make<WriteStmt>();
+         code->run = runWrite;
+         code->value = value.code;
+         return code;
+      }
+      case STRING_TYPE:
+      {
+         WriteText * code = make<WriteText>();
+         code->run = runWriteText;
+         code->text = static_cast<const Text *>(value.code)->text;
+         return code;
+      }
+      case VOID_TYPE:
+         error(at, "Attempt to write void");
+         return myNothing;
+      case STRUCT_TYPE:
+         error(at, "Attempt to write a struct variable");
+         return myNothing;
+      default:
+         return myNothing;
+   }
+}
+
+const StmtCode * ClosureCompiler::branch(Typed cond, const StmtCode * then,
+const StmtCode * otherwise, ASTNode * at)
+{
+   if (!check(cond, BOOL_TYPE, at,
+      "Non-bool expression used as an if condition")){
+      return myNothing;
+   }
+   if (otherwise == nullptr){
+      otherwise = myNothing;
+   }
+   if (isConst(cond.code)){
+      return constValue(cond.code) ? then : otherwise;
+   }
+   IfStmt * code = make<IfStmt>();
+   code->run = otherwise == myNothing ? runIf : runIfElse;
+   code->cond = cond.code;
+   code->then = then;
+   code->otherwise = otherwise;
+   return code;
+}
+
+const StmtCode * ClosureCompiler::loop(Typed cond, const StmtCode * body,
+ASTNode * at)
+{
+   if (!check(cond, BOOL_TYPE, at,
+      "Non-bool expression used as a while condition")){
+      return myNothing;
+   }
+   if (isConst(cond.code) && constValue(cond.code) == 0){
+      return myNothing;
+   }
+   WhileStmt * code = make<WhileStmt>();
+   code->run = runWhile;
+   code->cond = cond.code;
+   code->body = body;
+   return code;
+}
+
+const StmtCode * ClosureCompiler::returnValue(Typed value, ASTNode * at)
+{
+   BaseType result = myFunction->result.base;
+   if (result == VOID_TYPE){
+      error(at, "Return with a value in a void function");
+   } else if (value.type.base != result && value.type.base != ERROR_TYPE
+      && result != ERROR_TYPE){
+      error(at, "Bad return value");
+   }
+   ReturnStmt * code = make<ReturnStmt>();
+   code->run = runReturn;
+   code->value = value.code;
+   return code;
+}
+
+const StmtCode * ClosureCompiler::returnVoid(ASTNode * at)
+{
+   if (myFunction->result.base != VOID_TYPE){
+      error(at, "Missing return value");
+   }
+   StmtCode * code = make<StmtCode>();
+   code->run = runReturnVoid;
+   return code;
+}
+
+const StmtCode * ClosureCompiler::sequence(
+const std::vector<const StmtCode *> &stmts)
+{
+   std::vector<const StmtCode *> kept;
+   for (const StmtCode * stmt : stmts){
+      if (stmt != myNothing){
+         kept.push_back(stmt);
+      }
+   }
+   if (kept.empty()){
+      return myNothing;
+   }
+   if (kept.size() == 1){
+      return kept[0];
+   }
+   Sequence * code = make<Sequence>();
+   code->run = runSequence;
+   code->stmts = std::move(kept);
+   return code;
+}
+
+const FunctionCode * ClosureCompiler::mainFunction()
+{
+   auto found = myScopes.front().find("main");
+   if (found == myScopes.front().end() || found->second.function == nullptr){
+      error((size_t)0, "No main function");
+      return nullptr;
+   }
+   return found->second.function;
+}
+
+Engine::Engine()
+{
+}
+
+Engine::~Engine()
+{
+}
+
+bool Engine::compile(ProgramNode * program, Diagnostics &diagnostics,
+const LineIndex * lines)
+{
+   myCompiler.reset(new ClosureCompiler(diagnostics, lines));
+   myCompiler->setPass(ClosureCompiler::DECLARE);
+   program->compile(*myCompiler);
+   myCompiler->setPass(ClosureCompiler::DEFINE);
+   program->compile(*myCompiler);
+   myMain = myCompiler->mainFunction();
+   if (myCompiler->failed()){
+      myMain = nullptr;
+   }
+   return myMain != nullptr;
+}
+
+int Engine::run(std::istream &in, std::ostream &out)
+{
+   std::unique_ptr<Word[]> stack(new Word[STACK_SLOTS]);
+   std::vector<Word> globals(myCompiler->globalSlots(), 0);
+   Machine m;
+   m.fp = stack.get();
+   m.sp = m.fp + myMain->frameSize;
+   m.limit = m.fp + STACK_SLOTS;
+   m.globals = globals.data();
+   m.ret = 0;
+   m.stackFloor = nativeStackFloor();
+   m.sink = &out;
+   m.in = &in;
+   std::fill(m.fp, m.sp, 0);
+
+   Machine * outer = running;
+   running = &m;
+   if (myMain->body != nullptr){
+      myMain->body->run(myMain->body, m);
+   }
+   running = outer;
+   flushOutput(m);
+   out.flush();
+   return myMain->result.base == VOID_TYPE ? 0 : m.ret;
+}
+
+int runProgram(LilC_Compiler &compiler, const char * filename,
+std::istream &in, std::ostream &out)
+{
+   if (!compiler.buildAST(filename)){
+      return 1;
+   }
+   Engine engine;
+   bool compiled;
+   {
+      SelfProfiler::Phase phase("compile");
+      compiled = engine.compile(compiler.getASTRoot(),
+         compiler.diagnostics(), compiler.lineIndex());
+   }
+   compiler.diagnostics().flush(std::cerr);
+   if (!compiled){
+      return 1;
+   }
+   SelfProfiler::Phase phase("run");
+   return engine.run(in, out);
+}
+
+namespace {
+
+// The benchmark's programs take their sizes from here, so that the C++
+// versions cannot be worked out at compile time
+volatile Word benchSize[] = { 30, 2000, 1000000, 100000 };
+
+int fib(int n)
+{
+   return n < 2 ? n : fib(n - 1) + fib(n - 2);
+}
+
+struct Program{
+   const char * name;
+   const char * source;
+   std::function<std::string()> native;
+};
+
+const Program PROGRAMS[] = {
+   { "fib(30), recursive",
+      "int fib(int n) {\n"
+      "   if (n < 2) {\n"
+      "      return n;\n"
+      "   }\n"
+      "   return fib(n - 1) + fib(n - 2);\n"
+      "}\n"
+      "int main() {\n"
+      "   cout << fib(30);\n"
+      "   return 0;\n"
+      "}\n",
+      [](){ return std::to_string(fib(benchSize[0])); } },
+   { "nested loops, 2000 x 2000",
+      "int main() {\n"
+      "   int i;\n"
+      "   int j;\n"
+      "   int sum;\n"
+      "   i = 0;\n"
+      "   while (i < 2000) {\n"
+      "      j = 0;\n"
+      "      while (j < 2000) {\n"
+      "         sum = sum + i * j - j / 3;\n"
+      "         j++;\n"
+      "      }\n"
+      "      i++;\n"
+      "   }\n"
+      "   cout << sum;\n"
+      "   return 0;\n"
+      "}\n",
+      [](){
+         uint32_t sum = 0;
+         Word n = benchSize[1];
+         for (Word i = 0; i < n; i++){
+            for (Word j = 0; j < n; j++){
+               sum = sum + (uint32_t)i * (uint32_t)j - (uint32_t)(j / 3);
+            }
+         }
+         return std::to_string((Word)sum);
+      } },
+   { "struct fields and calls, 10^6",
+      "struct Point {\n"
+      "   int x;\n"
+      "   int y;\n"
+      "};\n"
+      "struct Box {\n"
+      "   struct Point lo;\n"
+      "   struct Point hi;\n"
+      "};\n"
+      "struct Box b;\n"
+      "void grow(int d) {\n"
+      "   b.hi.x = b.hi.x + d;\n"
+      "   b.lo.y = b.lo.y - d;\n"
+      "}\n"
+      "int main() {\n"
+      "   int i;\n"
+      "   i = 0;\n"
+      "   while (i < 1000000) {\n"
+      "      grow(i / 7);\n"
+      "      if (b.hi.x > 100000) {\n"
+      "         b.hi.x = b.hi.x - 100000;\n"
+      "         b.lo.x++;\n"
+      "      }\n"
+      "      i++;\n"
+      "   }\n"
+      "   cout << b.hi.x;\n"
+      "   cout << \" \";\n"
+      "   cout << b.lo.x;\n"
+      "   cout << \" \";\n"
+      "   cout << b.lo.y;\n"
+      "   return 0;\n"
+      "}\n",
+      [](){
+         struct Point{ Word x, y; };
+         struct Box{ Point lo, hi; } b = {};
+         Word n = benchSize[2];
+         for (Word i = 0; i < n; i++){
+            b.hi.x += i / 7;
+            b.lo.y = Sub::apply(b.lo.y, i / 7);
+            if (b.hi.x > 100000){
+               b.hi.x -= 100000;
+               b.lo.x++;
+            }
+         }
+         return std::to_string(b.hi.x) + " " + std::to_string(b.lo.x)
+            + " " + std::to_string(b.lo.y);
+      } },
+   { "collatz steps below 10^5",
+      "int steps(int n) {\n"
+      "   int count;\n"
+      "   while (n != 1) {\n"
+      "      if ((n / 2) * 2 == n) {\n"
+      "         n = n / 2;\n"
+      "      }\n"
+      "      else {\n"
+      "         n = 3 * n + 1;\n"
+      "      }\n"
+      "      count++;\n"
+      "   }\n"
+      "   return count;\n"
+      "}\n"
+      "int main() {\n"
+      "   int i;\n"
+      "   int total;\n"
+      "   i = 1;\n"
+      "   while (i < 100000) {\n"
+      "      total = total + steps(i);\n"
+      "      i++;\n"
+      "   }\n"
+      "   cout << total;\n"
+      "   return 0;\n"
+      "}\n",
+      [](){
+         Word total = 0;
+         Word n = benchSize[3];
+         for (Word i = 1; i < n; i++){
+            Word k = i;
+            while (k != 1){
+               k = k % 2 == 0 ? k / 2 : 3 * k + 1;
+               total++;
+            }
+         }
+         return std::to_string(total);
+      } },
+};
+
+} /* end anonymous namespace */
+
+int engineBenchmark(std::ostream &report)
+{
+   const int rounds = 5;
+   int failed = 0;
+   for (const Program &program : PROGRAMS){
+      LilC_Compiler compiler;
+      if (!compiler.buildAST(std::string(program.source))){
+         report << program.name << ": does not parse\n";
+         failed++;
+         continue;
+      }
+      Engine engine;
+      Diagnostics diagnostics;
+      double compileMs = medianMs(rounds, [&](){
+         engine.compile(compiler.getASTRoot(), diagnostics, nullptr);
+      });
+      if (!engine.compile(compiler.getASTRoot(), diagnostics, nullptr)){
+         diagnostics.flush(report);
+         failed++;
+         continue;
+      }
+      std::string output;
+      double runMs = medianMs(rounds, [&](){
+         std::istringstream in;
+         std::ostringstream out;
+         engine.run(in, out);
+         output = out.str();
+      });
+      std::string expected;
+      double nativeMs = medianMs(rounds, [&](){
+         expected = program.native();
+      });
+      report << program.name << ": compile " << compileMs << " ms ("
+         << engine.records() << " records), run " << runMs
+         << " ms, C++ " << nativeMs << " ms (" << runMs / nativeMs
+         << "x)\n";
+      if (output != expected){
+         report << "   output " << output << " differs from C++ "
+            << expected << "\n";
+         failed++;
+      }
+   }
+   return failed == 0 ? 0 : 1;
+}
+
+} /* end namespace */
@@ -0,0 +1,223 @@
+#ifndef __LILC_ENGINE_HPP__
+#define __LILC_ENGINE_HPP__ 1
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <istream>
+#include <ostream>
+#include <cstdint>
+#include <unordered_map>
+
+#include "ast.hpp"
+#include "lilc_diagnostics.hpp"
+#include "lilc_source.hpp"
+
+namespace LILC{
+
+// Closure-compiled execution engine (--run). Each expression and
+// statement of a program is turned once into a small record: a pointer
+// to a function specialized for its shape (a load of a local, a compare
+// of a local with a constant, a store to a global, a while loop, ...)
+// and its operands, which are child records, slot indices and
+// constants. Running the program calls main's record; nothing at run
+// time goes through a virtual ASTNode method or looks up a name.
+//
+// Every variable, and every field of a struct variable, has a slot of
+// its own: locals in the frame of their function, globals in one array.
+// A location such as p.q.r is therefore a single slot index, fixed at
+// compile time. Values are 32-bit words; int arithmetic wraps, bools
+// are 0 and 1, and cout writes both as decimal numbers.
+
+typedef int32_t Word;
+
+class Machine;
+class LilC_Compiler;
+struct ExpCode;
+struct StmtCode;
+struct StructLayout;
+
+typedef Word (*EvalFn)(const ExpCode * code, Machine &m);
+// Returns true once a return statement has run
+typedef bool (*RunFn)(const StmtCode * code, Machine &m);
+
+struct ExpCode{
+   EvalFn eval;
+};
+
+struct StmtCode{
+   RunFn run;
+};
+
+enum BaseType { ERROR_TYPE, INT_TYPE, BOOL_TYPE, VOID_TYPE, STRING_TYPE,
+   STRUCT_TYPE };
+
+struct ValueType{
+   BaseType base;
+   const StructLayout * layout;
+};
+
+// An expression's code and static type
+struct Typed{
+   const ExpCode * code;
+   ValueType type;
+};
+
+enum Storage { NOWHERE, LOCAL, GLOBAL };
+
+// A location: the first slot of a variable or field, and its type
+struct Place{
+   Storage storage;
+   int32_t slot;
+   ValueType type;
+};
+
+struct StructLayout{
+   struct Field{
+      int32_t offset;
+      ValueType type;
+   };
+   std::string name;
+   int32_t size = 0;
+   std::unordered_map<std::string, Field> fields;
+};
+
+struct FunctionCode{
+   std::string name;
+   ValueType result;
+   std::vector<ValueType> params;
+   int32_t frameSize = 0;
+   const StmtCode * body = nullptr;
+};
+
+// Builds the records for one program, resolving names and checking
+// types as it goes; owns them. Driven by the nodes' compile methods.
+// Declarations are compiled in two passes, so that a function can call
+// one declared after it: DECLARE records globals, structs and function
+// signatures, DEFINE compiles function bodies.
+class ClosureCompiler{
+public:
+   enum Pass { DECLARE, DEFINE };
+
+   ClosureCompiler(Diagnostics &diagnostics, const LineIndex * lines);
+   ~ClosureCompiler();
+   ClosureCompiler(const ClosureCompiler &) = delete;
+   ClosureCompiler & operator=(const ClosureCompiler &) = delete;
+
+   void setPass(Pass pass){ myPass = pass; }
+   Pass pass() const { return myPass; }
+   // False for the global and struct declarations seen again in DEFINE
+   bool declaring() const;
+
+   void error(ASTNode * at, const std::string &msg);
+   void error(size_t offset, const std::string &msg);
+   bool failed() const { return myErrors > 0; }
+
+   // Declarations. A variable becomes a field inside beginStruct(), a
+   // local inside beginFunction(), and a global otherwise.
+   void declareVariable(IdNode * id, ValueType type);
+   void declareFormal(IdNode * id, ValueType type);
+   ValueType structType(IdNode * id);
+   void beginStruct(IdNode * id);
+   void endStruct();
+   void beginFunction(IdNode * id, ValueType result);
+   void endFunction(const StmtCode * body);
+   void beginScope();
+   // body, run with the locals of the scope zeroed first
+   const StmtCode * endScope(const StmtCode * body);
+
+   // Expressions
+   Typed constant(Word value, BaseType type);
+   Typed string(const std::string &literal);
+   Place variable(IdNode * id);
+   Place field(const Place &base, IdNode * id);
+   Typed load(const Place &place);
+   Typed assign(const Place &place, Typed value, ASTNode * at);
+   Typed call(IdNode * id, std::vector<Typed> &args, ASTNode * at);
+   Typed unary(NodeKind op, Typed operand, ASTNode * at);
+   Typed binary(NodeKind op, Typed left, Typed right, ASTNode * at);
+
+   // Statements
+   const StmtCode * evaluate(Typed exp);
+   const StmtCode * step(const Place &place, Word delta, ASTNode * at);
+   const StmtCode * read(const Place &place, ASTNode * at);
+   const StmtCode * write(Typed value, ASTNode * at);
+   const StmtCode * branch(Typed cond, const StmtCode * then,
+      const StmtCode * otherwise, ASTNode * at);
+   const StmtCode * loop(Typed cond, const StmtCode * body, ASTNode * at);
+   const StmtCode * returnValue(Typed value, ASTNode * at);
+   const StmtCode * returnVoid(ASTNode * at);
+   const StmtCode * sequence(const std::vector<const StmtCode *> &stmts);
+
+   // After both passes: main, or null (reported) if there is none
+   const FunctionCode * mainFunction();
+   int32_t globalSlots() const { return myGlobalSlots; }
+   size_t records() const { return myRecords.size(); }
+private:
+   struct Symbol{
+      Place place;
+      FunctionCode * function;
+   };
+   typedef std::unordered_map<std::string, Symbol> Scope;
+
+   template <typename T> T * make();
+   // left op right, folded or specialized for the operands' shapes
+   template <typename Op>
+   const ExpCode * operation(const ExpCode * left, const ExpCode * right);
+   const Symbol * lookup(const std::string &name) const;
+   Place allocate(ValueType type);
+   void declare(IdNode * id, const Symbol &symbol);
+   bool check(Typed exp, BaseType want, ASTNode * at, const char * what);
+
+   Diagnostics &myDiagnostics;
+   const LineIndex * myLines;
+   size_t myErrors = 0;
+   Pass myPass = DECLARE;
+   std::vector<std::shared_ptr<void> > myRecords;
+   // Code for the operands and statements left by an error
+   const ExpCode * myZero;
+   const StmtCode * myNothing;
+
+   std::unordered_map<std::string, std::unique_ptr<StructLayout> > myStructs;
+   std::unordered_map<IdNode *, std::unique_ptr<FunctionCode> > myFunctions;
+   StructLayout * myStruct = nullptr;
+   FunctionCode * myFunction = nullptr;
+   // Scopes from the globals inwards, and the first slot of each
+   std::vector<Scope> myScopes;
+   std::vector<int32_t> myScopeStarts;
+   int32_t myNextSlot = 0;
+   int32_t myGlobalSlots = 0;
+};
+
+// Compiles a program, then runs it as often as asked.
+class Engine{
+public:
+   Engine();
+   ~Engine();
+   // Reports name and type errors to diagnostics, with positions from
+   // lines if given; returns false if there were any or no main.
+   bool compile(ProgramNode * program, Diagnostics &diagnostics,
+      const LineIndex * lines);
+   // Runs main with cin and cout on in and out; returns main's result,
+   // or 0 for a void main. A division by zero or a call stack overflow
+   // is reported on std::cerr and ends the process.
+   int run(std::istream &in, std::ostream &out);
+   size_t records() const { return myCompiler->records(); }
+private:
+   std::unique_ptr<ClosureCompiler> myCompiler;
+   const FunctionCode * myMain = nullptr;
+};
+
+// Parses filename with compiler, compiles it and runs it (--run); the
+// exit status is main's result, or 1 if the program does not compile.
+int runProgram(LilC_Compiler &compiler, const char * filename,
+   std::istream &in, std::ostream &out);
+
+// Runs recursion- and loop-heavy programs on the engine, checks their
+// output against the same computations written in C++, and reports the
+// compile and run times of each and the ratio to the C++ times. Returns
+// 1 if any output differs.
+int engineBenchmark(std::ostream &report);
+
+} /* end namespace */
+#endif /* END __LILC_ENGINE_HPP__ */
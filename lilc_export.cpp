@@ -0,0 +1,176 @@
+#include "lilc_export.hpp"
+#include "lilc_json.hpp"
+
+namespace LILC{
+
+ASTExporter::ASTExporter(std::ostream &out, Format format)
+: myOut(out), myFormat(format)
+{
+   myBuf.reserve(BUFFER_SIZE);
+   if (myFormat == BINARY){
+      myBuf.append("LILCAST\x01", 8);
+   } else {
+      myBuf += "{\"format\":\"lilc-ast\",\"version\":1}\n";
+   }
+}
+
+ASTExporter::~ASTExporter()
+{
+   flush();
+}
+
+void ASTExporter::exportProgram(ProgramNode * root)
+{
+   root->exportTo(*this, NO_PARENT);
+   flush();
+}
+
+void ASTExporter::flush()
+{
+   myOut.write(myBuf.data(), myBuf.size());
+   myBuf.clear();
+}
+
+size_t ASTExporter::node(NodeKind kind, size_t parent, Span span)
+{
+   return emit(kind, parent, Fields(span));
+}
+
+size_t ASTExporter::name(NodeKind kind, size_t parent,
+const std::string &name, Span span)
+{
+   Fields fields(span);
+   fields.mask |= HAS_NAME;
+   fields.name = intern(name);
+   return emit(kind, parent, fields);
+}
+
+size_t ASTExporter::intValue(NodeKind kind, size_t parent, long long value,
+Span span)
+{
+   Fields fields(span);
+   fields.mask |= HAS_INT;
+   fields.number = value;
+   return emit(kind, parent, fields);
+}
+
+size_t ASTExporter::stringValue(NodeKind kind, size_t parent,
+const std::string &value, Span span)
+{
+   Fields fields(span);
+   fields.mask |= HAS_STRING;
+   fields.text = &value;
+   return emit(kind, parent, fields);
+}
+
+size_t ASTExporter::sized(NodeKind kind, size_t parent, long long size,
+Span span)
+{
+   Fields fields(span);
+   fields.mask |= HAS_SIZE;
+   fields.number = size;
+   return emit(kind, parent, fields);
+}
+
+size_t ASTExporter::intern(const std::string &name)
+{
+   auto found = myNames.find(name);
+   if (found != myNames.end()){
+      return found->second;
+   }
+   size_t id = myNames.size() + 1;
+   myNames.emplace(name, id);
+   myScratch.clear();
+   if (myFormat == BINARY){
+      myScratch += (char)INTERN_RECORD;
+      varint(myScratch, id);
+      myScratch += name;
+      record(myScratch);
+   } else {
+      myScratch += "{\"intern\":";
+      myScratch += std::to_string(id);
+      myScratch += ",\"name\":";
+      appendJSONString(myScratch, name);
+      myScratch += "}\n";
+      reserve(myScratch.size());
+      myBuf += myScratch;
+   }
+   return id;
+}
+
+size_t ASTExporter::emit(NodeKind kind, size_t parent, const Fields &fields)
+{
+   size_t id = myNextId++;
+   myScratch.clear();
+   if (myFormat == BINARY){
+      myScratch += (char)NODE_RECORD;
+      varint(myScratch, kind);
+      varint(myScratch, parent);
+      varint(myScratch, fields.mask);
+      if (fields.mask & HAS_SPAN){
+         varint(myScratch, fields.offset);
+         varint(myScratch, fields.length);
+      }
+      if (fields.mask & HAS_NAME){ varint(myScratch, fields.name); }
+      if (fields.mask & HAS_INT){ varint(myScratch, zigzag(fields.number)); }
+      if (fields.mask & HAS_STRING){
+         varint(myScratch, fields.text->size());
+         myScratch += *fields.text;
+      }
+      if (fields.mask & HAS_SIZE){ varint(myScratch, zigzag(fields.number)); }
+      record(myScratch);
+      return id;
+   }
+
+   myScratch += "{\"id\":";
+   myScratch += std::to_string(id);
+   myScratch += ",\"kind\":\"";
+   myScratch += nodeKindName(kind);
+   myScratch += "\",\"parent\":";
+   myScratch += std::to_string(parent);
+   if (fields.mask & HAS_NAME){
+      myScratch += ",\"name\":";
+      myScratch += std::to_string(fields.name);
+   }
+   if (fields.mask & HAS_INT){
+      myScratch += ",\"value\":";
+      myScratch += std::to_string(fields.number);
+   }
+   if (fields.mask & HAS_STRING){
+      myScratch += ",\"value\":";
+      appendJSONString(myScratch, *fields.text);
+   }
+   if (fields.mask & HAS_SIZE){
+      myScratch += ",\"size\":";
+      myScratch += std::to_string(fields.number);
+   }
+   if (fields.mask & HAS_SPAN){
+      myScratch += ",\"span\":[";
+      myScratch += std::to_string(fields.offset);
+      myScratch += ',';
+      myScratch += std::to_string(fields.length);
+      myScratch += ']';
+   }
+   myScratch += "}\n";
+   reserve(myScratch.size());
+   myBuf += myScratch;
+   return id;
+}
+
+void ASTExporter::record(const std::string &payload)
+{
+   reserve(payload.size() + 10);
+   varint(myBuf, payload.size());
+   myBuf += payload;
+}
+
+void ASTExporter::varint(std::string &buf, uint64_t value)
+{
+   while (value >= 0x80){
+      buf += (char)(value | 0x80);
+      value >>= 7;
+   }
+   buf += (char)value;
+}
+
+} /* end namespace */
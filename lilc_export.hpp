@@ -0,0 +1,96 @@
+#ifndef __LILC_EXPORT_HPP__
+#define __LILC_EXPORT_HPP__ 1
+
+#include <string>
+#include <ostream>
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+
+#include "ast.hpp"
+
+namespace LILC{
+
+// Streams an AST to external tools, either as JSON Lines or as a compact
+// binary format, without building an intermediate document. Nodes are
+// written in pre-order, one record each, and refer to their parent by id,
+// so every record is bounded and the output buffer is flushed as it
+// fills. Identifiers are interned: the first use of a name emits an
+// intern record and nodes refer to it by number.
+//
+// JSON Lines: a header line {"format":"lilc-ast","version":1}, then
+//    {"intern":N,"name":"..."}
+//    {"id":N,"kind":"IdNode","parent":P,"name":N,"span":[offset,length]}
+// with "value" on literals and "size" on struct variable declarations.
+// Every node record has a span, the node's offset and length in bytes of
+// the source. Parent 0 means the root.
+//
+// Binary: the magic "LILCAST" and a version byte, then records of
+// varint payload length followed by the payload. A payload starts with a
+// record type: INTERN_RECORD (varint id, name bytes) or NODE_RECORD
+// (varint kind, varint parent, varint field mask, then the fields named
+// by the mask in bit order: span as two varints, interned name, zigzag
+// integer value, length-prefixed string value, zigzag size). HAS_SPAN is
+// set on every node record.
+class ASTExporter{
+public:
+   enum Format { JSON_LINES, BINARY };
+   enum Record { INTERN_RECORD = 1, NODE_RECORD = 2 };
+   enum Field {
+      HAS_SPAN = 1, HAS_NAME = 2, HAS_INT = 4, HAS_STRING = 8, HAS_SIZE = 16
+   };
+   static const size_t NO_PARENT = 0;
+
+   ASTExporter(std::ostream &out, Format format);
+   ~ASTExporter();
+
+   void exportProgram(ProgramNode * root);
+
+   // Record writers used by the nodes' exportTo methods; each returns the
+   // new node's id for its children to refer to.
+   size_t node(NodeKind kind, size_t parent, Span span);
+   size_t name(NodeKind kind, size_t parent, const std::string &name,
+      Span span);
+   size_t intValue(NodeKind kind, size_t parent, long long value, Span span);
+   size_t stringValue(NodeKind kind, size_t parent, const std::string &value,
+      Span span);
+   size_t sized(NodeKind kind, size_t parent, long long size, Span span);
+
+   void flush();
+
+private:
+   struct Fields{
+      explicit Fields(Span span)
+      : offset(span.offset), length(span.length) { }
+      unsigned mask = HAS_SPAN;
+      size_t offset;
+      size_t length;
+      size_t name = 0;
+      long long number = 0;
+      const std::string * text = nullptr;
+   };
+
+   size_t emit(NodeKind kind, size_t parent, const Fields &fields);
+   size_t intern(const std::string &name);
+   void record(const std::string &payload);
+   void reserve(size_t len){
+      if (myBuf.size() + len > BUFFER_SIZE){ flush(); }
+   }
+
+   static void varint(std::string &buf, uint64_t value);
+   static uint64_t zigzag(long long value){
+      return ((uint64_t)value << 1) ^ (uint64_t)(value >> 63);
+   }
+
+   static const size_t BUFFER_SIZE = 1 << 16;
+
+   std::ostream &myOut;
+   Format myFormat;
+   std::string myBuf;
+   std::string myScratch;
+   std::unordered_map<std::string, size_t> myNames;
+   size_t myNextId = 1;
+};
+
+} /* end namespace */
+#endif /* END __LILC_EXPORT_HPP__ */
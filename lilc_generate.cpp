@@ -0,0 +1,254 @@
+#include <cstring>
+#include <algorithm>
+
+#include "lilc_generate.hpp"
+
+namespace LILC{
+
+namespace {
+
+const char * const BINARY_OPS[] = {
+   " + ", " - ", " * ", " / ", " && ", " || ", " == ", " != ", " < ", " > ",
+   " <= ", " >= "
+};
+
+class Generator{
+public:
+   Generator(uint64_t seed) : myState(seed) { }
+
+   void program(size_t functions){
+      size_t structs = functions / 16 + 1;
+      for (size_t i = 0; i < structs; i++){
+         myOut += "struct S" + std::to_string(i) + " {\n";
+         for (size_t f = 0, n = 1 + below(4); f < n; f++){
+            myOut += "   " + type() + " f" + std::to_string(f) + ";\n";
+         }
+         myOut += "};\n";
+      }
+      for (size_t i = 0, n = functions / 4 + 1; i < n; i++){
+         myOut += type() + " g" + std::to_string(i) + ";\n";
+      }
+      for (size_t i = 0; i < functions; i++){
+         function(i, structs);
+      }
+   }
+
+   std::string take(){ return std::move(myOut); }
+private:
+   // splitmix64
+   uint64_t next(){
+      uint64_t z = (myState += 0x9e3779b97f4a7c15ULL);
+      z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+      z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+      return z ^ (z >> 31);
+   }
+   size_t below(size_t n){ return next() % n; }
+
+   std::string type(){
+      static const char * const TYPES[] = { "int", "bool", "int" };
+      return TYPES[below(3)];
+   }
+
+   std::string name(){
+      static const char * const NAMES[] = {
+         "x", "y", "i", "count", "total", "flag", "a", "b", "value", "n"
+      };
+      return NAMES[below(10)];
+   }
+
+   void function(size_t index, size_t structs){
+      myOut += (below(4) == 0 ? "void" : type()) + " fn"
+         + std::to_string(index) + "(";
+      for (size_t i = 0, n = below(5); i < n; i++){
+         if (i > 0){ myOut += ", "; }
+         myOut += type() + " p" + std::to_string(i);
+      }
+      myOut += "){\n";
+      for (size_t i = 0, n = below(4); i < n; i++){
+         if (below(5) == 0){
+            myOut += "   struct S" + std::to_string(below(structs)) + " "
+               + name() + ";\n";
+         } else {
+            myOut += "   " + type() + " " + name() + ";\n";
+         }
+      }
+      for (size_t i = 0, n = 3 + below(10); i < n; i++){
+         statement(1);
+      }
+      myOut += "   return " + expression(2) + ";\n}\n";
+   }
+
+   void block(int depth){
+      myOut += "{\n";
+      if (below(3) == 0){
+         indent(depth + 1);
+         myOut += type() + " " + name() + ";\n";
+      }
+      for (size_t i = 0, n = 1 + below(3); i < n; i++){
+         statement(depth + 1);
+      }
+      indent(depth);
+      myOut += "}";
+   }
+
+   void indent(int depth){ myOut.append(3 * depth, ' '); }
+
+   void statement(int depth){
+      indent(depth);
+      size_t kind = depth < 4 ? below(11) : below(7);
+      switch (kind){
+      case 0: case 1:
+         myOut += location() + " = " + expression(3) + ";\n";
+         break;
+      case 2:
+         myOut += location() + (below(2) == 0 ? "++;\n" : "--;\n");
+         break;
+      case 3:
+         myOut += "cin >> " + location() + ";\n";
+         break;
+      case 4:
+         myOut += "cout << " + (below(3) == 0 ? string() : expression(2))
+            + ";\n";
+         break;
+      case 5:
+         myOut += call() + ";\n";
+         break;
+      case 6:
+         myOut += below(4) == 0 ? "return;\n"
+            : "return " + expression(2) + ";\n";
+         break;
+      case 7: case 8:
+         myOut += "if (" + expression(3) + ") ";
+         block(depth);
+         if (below(2) == 0){
+            myOut += " else ";
+            block(depth);
+         }
+         myOut += "\n";
+         break;
+      default:
+         myOut += "while (" + expression(3) + ") ";
+         block(depth);
+         myOut += "\n";
+         break;
+      }
+   }
+
+   std::string location(){
+      std::string loc = name();
+      for (size_t i = 0, n = below(4) == 0 ? 1 + below(2) : 0; i < n; i++){
+         loc += ".f" + std::to_string(below(4));
+      }
+      return loc;
+   }
+
+   std::string string(){
+      static const char * const STRINGS[] = {
+         "\"\"", "\"hello\"", "\"a\\tb\\n\"", "\"say \\\"hi\\\"\"",
+         "\"total: \""
+      };
+      return STRINGS[below(5)];
+   }
+
+   std::string call(){
+      std::string text = "fn" + std::to_string(below(64)) + "(";
+      for (size_t i = 0, n = below(4); i < n; i++){
+         if (i > 0){ text += ", "; }
+         text += expression(1);
+      }
+      return text + ")";
+   }
+
+   std::string term(int depth){
+      switch (below(depth > 0 ? 9 : 6)){
+      case 0: case 1: return location();
+      case 2: return std::to_string(below(1000));
+      case 3: return below(2) == 0 ? "true" : "false";
+      case 4: return below(4) == 0 ? string() : name();
+      case 5: return "-" + (below(2) == 0 ? name()
+         : std::to_string(below(100)));
+      case 6: return call();
+      case 7: return "!" + term(depth - 1);
+      default: return "(" + expression(depth - 1) + ")";
+      }
+   }
+
+   std::string expression(int depth){
+      if (depth <= 0 || below(3) == 0){
+         return term(depth);
+      }
+      if (below(8) == 0){
+         return location() + " = " + expression(depth - 1);
+      }
+      // Comparisons do not associate, so they never chain unbracketed.
+      size_t op = below(12);
+      return term(depth - 1) + BINARY_OPS[op]
+         + (op >= 6 ? term(depth - 1) : expression(depth - 1));
+   }
+
+   uint64_t myState;
+   std::string myOut;
+};
+
+// Writes count copies of unit to out, through a buffer of whole units.
+void repeat(std::ostream &out, const char * unit, size_t count)
+{
+   size_t len = strlen(unit);
+   size_t perBlock = std::max<size_t>(1, (1 << 16) / len);
+   std::string block;
+   for (size_t i = 0; i < std::min(count, perBlock); i++){
+      block += unit;
+   }
+   for (; count >= perBlock; count -= perBlock){
+      out.write(block.data(), block.size());
+   }
+   out.write(block.data(), count * len);
+}
+
+} /* end anonymous namespace */
+
+void generateStress(StressShape shape, size_t size, std::ostream &out)
+{
+   switch (shape){
+   case LONG_LINE:
+      out << "int x; void f(){";
+      repeat(out, "x = x + 1; ", size / 11);
+      out << "}\n";
+      break;
+   case NESTED_IF:
+      out << "bool a; int x; void f(){\n";
+      repeat(out, "if (a) {", size);
+      out << "x = 1;";
+      repeat(out, "}", size);
+      out << "\n}\n";
+      break;
+   case ASSIGN_CHAIN:
+      out << "int x; int b; void f(){\nx";
+      repeat(out, " = b", size);
+      out << " = 1;\n}\n";
+      break;
+   case LONG_FORMALS:
+      out << "void f(int p0";
+      for (size_t i = 1; i < size; i++){
+         out << ", int p" << i;
+      }
+      out << "){}\n";
+      break;
+   case ILLEGAL_CHARS:
+      // Lines of 79, so that line bookkeeping is exercised as well
+      repeat(out, "@$%^~`?@$%^~`?@$%^~`?@$%^~`?@$%^~`?@$%^~`?@$%^~`?"
+         "@$%^~`?@$%^~`?@$%^~`?@$%^~`?@$\n", size / 80);
+      break;
+   case STRESS_SHAPE_COUNT:
+      break;
+   }
+}
+
+std::string generateProgram(uint64_t seed, size_t functions)
+{
+   Generator gen(seed);
+   gen.program(functions);
+   return gen.take();
+}
+
+} /* end namespace */
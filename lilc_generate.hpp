@@ -0,0 +1,34 @@
+#ifndef __LILC_GENERATE_HPP__
+#define __LILC_GENERATE_HPP__ 1
+
+#include <string>
+#include <ostream>
+#include <cstddef>
+#include <cstdint>
+
+namespace LILC{
+
+// Writes a random but syntactically valid Lil' C program with the given
+// number of functions, plus a few structs and globals. The same seed
+// always gives the same text, on any platform: the generator uses its
+// own PRNG rather than <random>'s distributions. Every statement and
+// expression form of the grammar appears, nested a few levels deep.
+std::string generateProgram(uint64_t seed, size_t functions);
+
+// Degenerate inputs that each push one part of the front end to its limit.
+enum StressShape{
+   LONG_LINE,      // size bytes of statements on a single line
+   NESTED_IF,      // size if statements, each nested in the last
+   ASSIGN_CHAIN,   // x = b = b = ... with size assignments
+   LONG_FORMALS,   // one function with size formal parameters
+   ILLEGAL_CHARS,  // size bytes of characters no token can start with
+   STRESS_SHAPE_COUNT
+};
+
+// Writes the stress input of the given shape and size to out, a block at
+// a time, so that inputs of gigabytes never have to fit in memory. Every
+// shape but ILLEGAL_CHARS is a valid program.
+void generateStress(StressShape shape, size_t size, std::ostream &out);
+
+} /* end namespace */
+#endif /* END __LILC_GENERATE_HPP__ */
@@ -0,0 +1,410 @@
+#include <sstream>
+#include <iterator>
+#include <algorithm>
+
+#include "lilc_incremental.hpp"
+#include "lilc_compiler.hpp"
+
+using TokenTag = LILC::LilC_Parser::token;
+
+namespace LILC{
+
+int TokenReplayScanner::yylex( LILC::LilC_Parser::semantic_type * const lval)
+{
+   if (cur == last){
+      currentSpan = makeSpan(currentSpan.offset + currentSpan.length, 0);
+      return TokenTag::END;
+   }
+   lval->symbolValue = cur->value;
+   current.line = cur->line + 1;
+   current.col = cur->col + 1;
+   currentSpan = makeSpan(text->lineStart(cur->line) + cur->col, cur->length);
+   return (cur++)->tag;
+}
+
+namespace {
+
+// The scanner allocates a value for every token it returns; a stored
+// token owns it. Literal nodes point at theirs, so a line's tokens are
+// only deleted together with the declarations parsed from them.
+void deleteTokens(std::vector<Token> &tokens)
+{
+   for (Token &tok : tokens){
+      delete(tok.value);
+   }
+   tokens.clear();
+}
+
+// The name a top-level declaration declares
+const std::string & declName(DeclNode * node)
+{
+   switch (node->kind()){
+      case STRUCT_DECL_NODE:
+         return static_cast<StructDeclNode *>(node)->getId()->getName();
+      case FN_DECL_NODE:
+         return static_cast<FnDeclNode *>(node)->getId()->getName();
+      default:
+         return static_cast<VarDeclNode *>(node)->getId()->getName();
+   }
+}
+
+} // end anonymous namespace
+
+IncrementalDocument::IncrementalDocument()
+: myCompiler(new LilC_Compiler())
+{
+   myLines.push_back(Line());
+   std::list<DeclNode *> none;
+   myProgram = new ProgramNode(new DeclListNode(&none));
+}
+
+IncrementalDocument::~IncrementalDocument()
+{
+   // The program's list only points at the declarations
+   delete(myProgram->getDeclList());
+   delete(myProgram);
+   for (Decl &d : myDecls){
+      if (d.node != nullptr){ d.node->deleteTree(); }
+   }
+   for (Line &l : myLines){
+      deleteTokens(l.tokens);
+   }
+   delete(myCompiler);
+}
+
+void IncrementalDocument::setText(const std::string &text)
+{
+   myText.assign(text);
+   for (Line &l : myLines){
+      deleteTokens(l.tokens);
+   }
+   myLines.clear();
+   myLines.resize(myText.lineCount());
+   lexLines(0, myLines.size() - 1);
+   reparse(0, myDecls.size(), 0, myLines.size() - 1);
+}
+
+void IncrementalDocument::lexLines(size_t first, size_t last)
+{
+   for (size_t i = first; i <= last; i++){
+      deleteTokens(myLines[i].tokens);
+      myLines[i].lexErrors.clear();
+   }
+   size_t start = myText.lineStart(first);
+   std::string text = myText.substr(start, myText.lineEnd(last) - start);
+   LineIndex index(text.data(), text.size());
+   for (size_t i = first; i <= last; i++){
+      size_t from = index.lineStart(i - first);
+      size_t to = i < last ? index.lineStart(i - first + 1) : text.size();
+      myLines[i].ascii = std::all_of(text.begin() + from, text.begin() + to,
+         [](char c){ return (c & 0x80) == 0; });
+   }
+
+   std::istringstream in(text);
+   // Copied: std::max takes a reference, and the constant has no
+   // out-of-class definition
+   size_t cap = Diagnostics::DEFAULT_MAX_ENTRIES;
+   Diagnostics diags(std::max(last - first + 1, cap));
+   LilC_Scanner scanner(&in, &diags);
+   scanner.setLineIndex(&index, first + 1);
+   LilC_Parser::semantic_type lval;
+   while (true){
+      int tag = scanner.yylex(&lval);
+      if (tag == TokenTag::END){ break; }
+      Position pos = index.position(scanner.tokenOffset());
+      Token tok;
+      tok.tag = tag;
+      tok.value = lval.symbolValue;
+      tok.line = first + pos.line - 1;
+      tok.col = pos.col - 1;
+      tok.length = scanner.tokenLength();
+      myLines[tok.line].tokens.push_back(tok);
+   }
+   for (const Diagnostics::Entry &e : diags.entries()){
+      size_t lineIdx = std::min(std::max<size_t>(e.line, first + 1) - 1, last);
+      Diagnostics::Entry rel = e;
+      rel.line = 0;
+      myLines[lineIdx].lexErrors.push_back(rel);
+   }
+}
+
+void IncrementalDocument::edit(size_t startLine, size_t startCol,
+size_t endLine, size_t endCol, const std::string &text)
+{
+   size_t lastLine = myLines.size() - 1;
+   startLine = std::min(startLine, lastLine);
+   endLine = std::min(std::max(endLine, startLine), lastLine);
+   size_t startOffset = std::min(myText.lineStart(startLine) + startCol,
+      myText.lineEnd(startLine));
+   size_t endOffset = std::min(myText.lineStart(endLine) + endCol,
+      myText.lineEnd(endLine));
+   endOffset = std::max(endOffset, startOffset);
+
+   // Every declaration that touches an edited line is re-parsed. Two
+   // declarations may share a line, so keep widening until no further
+   // declaration touches the ends of the region.
+   size_t lo = std::lower_bound(myDecls.begin(), myDecls.end(), startLine,
+      [](const Decl &d, size_t line){ return d.lastLine < line; })
+      - myDecls.begin();
+   size_t hi = lo;
+   size_t regionFirst = startLine;
+   size_t regionLast = endLine;
+   while (true){
+      if (lo > 0 && myDecls[lo - 1].lastLine >= regionFirst){
+         lo--;
+         regionFirst = std::min(regionFirst, myDecls[lo].firstLine);
+      } else if (hi < myDecls.size() && myDecls[hi].firstLine <= regionLast){
+         regionFirst = std::min(regionFirst, myDecls[hi].firstLine);
+         regionLast = std::max(regionLast, myDecls[hi].lastLine);
+         hi++;
+      } else {
+         break;
+      }
+   }
+
+   myText.erase(startOffset, endOffset - startOffset);
+   myText.insert(startOffset, text);
+
+   size_t oldCount = endLine - startLine + 1;
+   size_t newCount = countNewlines(text.data(), text.size()) + 1;
+   if (newCount > oldCount){
+      myLines.insert(myLines.begin() + endLine + 1, newCount - oldCount, Line());
+   } else if (newCount < oldCount){
+      for (size_t i = startLine + newCount; i <= endLine; i++){
+         deleteTokens(myLines[i].tokens);
+      }
+      myLines.erase(myLines.begin() + startLine + newCount,
+         myLines.begin() + endLine + 1);
+   }
+   lexLines(startLine, startLine + newCount - 1);
+
+   if (newCount != oldCount){
+      for (size_t i = hi; i < myDecls.size(); i++){
+         myDecls[i].firstLine = myDecls[i].firstLine + newCount - oldCount;
+         myDecls[i].lastLine = myDecls[i].lastLine + newCount - oldCount;
+      }
+   }
+   reparse(lo, hi, regionFirst, regionLast + newCount - oldCount);
+}
+
+// Splits the tokens of lines [firstLine, lastLine] into top-level
+// declarations and parses each of them, replacing (and freeing)
+// myDecls[lo, hi). A declaration left open at the end of the region (an
+// unbalanced brace while typing) pulls in the following declarations
+// until it closes.
+void IncrementalDocument::reparse(size_t lo, size_t hi, size_t firstLine,
+size_t lastLine)
+{
+   std::vector<Decl> fresh;
+   std::vector<Token> cur;
+   size_t curFirst = 0;
+   size_t curLast = 0;
+   size_t depth = 0;
+   bool isStruct = false;
+
+   size_t line = firstLine;
+   while (true){
+      for (; line <= lastLine && line < myLines.size(); line++){
+         for (const Token &stored : myLines[line].tokens){
+            Token tok = stored;
+            tok.line = line;
+            if (cur.empty()){
+               curFirst = line;
+               depth = 0;
+               isStruct = tok.tag == TokenTag::STRUCT;
+            }
+            cur.push_back(tok);
+            curLast = line;
+            bool done = false;
+            if (tok.tag == TokenTag::LCURLY){
+               depth++;
+            } else if (tok.tag == TokenTag::RCURLY){
+               if (depth > 0){ depth--; }
+               done = depth == 0 && !isStruct;
+            } else if (tok.tag == TokenTag::SEMICOLON){
+               done = depth == 0;
+            }
+            if (done){
+               fresh.push_back(parseDecl(cur, curFirst, curLast));
+               cur.clear();
+            }
+         }
+      }
+      if (cur.empty() || hi >= myDecls.size()){
+         break;
+      }
+      lastLine = std::max(lastLine, myDecls[hi].lastLine);
+      hi++;
+      while (hi < myDecls.size() && myDecls[hi].firstLine <= lastLine){
+         lastLine = std::max(lastLine, myDecls[hi].lastLine);
+         hi++;
+      }
+   }
+   if (!cur.empty()){
+      fresh.push_back(parseDecl(cur, curFirst, curLast));
+   }
+
+   // Keep the name index in step: drop the old declarations, move the
+   // ones after them by the change in count and add the new ones
+   for (size_t i = lo; i < hi; i++){
+      if (myDecls[i].node == nullptr){ continue; }
+      auto it = myNames.find(declName(myDecls[i].node));
+      std::vector<size_t> &ids = it->second;
+      ids.erase(std::find(ids.begin(), ids.end(), i));
+      if (ids.empty()){ myNames.erase(it); }
+   }
+   if (fresh.size() != hi - lo){
+      for (auto &entry : myNames){
+         for (size_t &i : entry.second){
+            if (i >= hi){ i = i - (hi - lo) + fresh.size(); }
+         }
+      }
+   }
+   for (size_t k = 0; k < fresh.size(); k++){
+      if (fresh[k].node == nullptr){ continue; }
+      std::vector<size_t> &ids = myNames[declName(fresh[k].node)];
+      ids.insert(std::lower_bound(ids.begin(), ids.end(), lo + k), lo + k);
+   }
+
+   // Splice the new declarations into the program's list in place of
+   // the old ones, before the first declaration after them that parsed
+   std::list<DeclNode *> &list = *myProgram->getDeclList()->getDecls();
+   auto at = list.end();
+   for (size_t i = hi; i < myDecls.size(); i++){
+      if (myDecls[i].node != nullptr){
+         at = myDecls[i].pos;
+         break;
+      }
+   }
+   for (size_t i = lo; i < hi; i++){
+      if (myDecls[i].node != nullptr){
+         list.erase(myDecls[i].pos);
+         myDecls[i].node->deleteTree();
+      }
+   }
+   for (Decl &d : fresh){
+      if (d.node != nullptr){ d.pos = list.insert(at, d.node); }
+   }
+   if (fresh.size() == hi - lo){
+      std::move(fresh.begin(), fresh.end(), myDecls.begin() + lo);
+   } else {
+      myDecls.erase(myDecls.begin() + lo, myDecls.begin() + hi);
+      myDecls.insert(myDecls.begin() + lo,
+         std::make_move_iterator(fresh.begin()),
+         std::make_move_iterator(fresh.end()));
+   }
+   myProgramStale = true;
+}
+
+IncrementalDocument::Decl IncrementalDocument::parseDecl(
+std::vector<Token> &tokens, size_t firstLine, size_t lastLine)
+{
+   Decl decl;
+   decl.firstLine = firstLine;
+   decl.lastLine = lastLine;
+   decl.firstCol = tokens.front().col;
+   decl.lastCol = tokens.back().col;
+   decl.node = nullptr;
+
+   Diagnostics &diags = myCompiler->diagnostics();
+   diags.clear();
+   myCompiler->setASTRoot(nullptr);
+   TokenReplayScanner scanner(tokens.data(), tokens.data() + tokens.size(),
+      &diags, &myText);
+   LilC_Parser parser(scanner, *myCompiler);
+   const int accept( 0 );
+   bool accepted = parser.parse() == accept;
+   ProgramNode * root = myCompiler->getASTRoot();
+   if (root != nullptr){
+      // Keep the declaration and free the program around it
+      for (DeclNode * parsed : *root->getDeclList()->getDecls()){
+         if (accepted && decl.node == nullptr){
+            decl.node = parsed;
+         } else {
+            parsed->deleteTree();
+         }
+      }
+      delete(root->getDeclList());
+      delete(root);
+      myCompiler->setASTRoot(nullptr);
+   }
+   for (const Diagnostics::Entry &e : diags.entries()){
+      Diagnostics::Entry rel = e;
+      rel.line = e.line - 1 - firstLine;
+      decl.parseErrors.push_back(rel);
+   }
+   diags.clear();
+   return decl;
+}
+
+size_t IncrementalDocument::declAt(size_t line, size_t col) const
+{
+   // First declaration that ends at or after the position.
+   size_t idx = std::lower_bound(myDecls.begin(), myDecls.end(),
+      std::make_pair(line, col),
+      [](const Decl &d, const std::pair<size_t, size_t> &pos){
+         return d.lastLine < pos.first
+            || (d.lastLine == pos.first && d.lastCol < pos.second);
+      }) - myDecls.begin();
+   if (idx == myDecls.size()){ return idx; }
+   const Decl &d = myDecls[idx];
+   if (d.firstLine > line || (d.firstLine == line && d.firstCol > col)){
+      return myDecls.size();
+   }
+   return idx;
+}
+
+const Token * IncrementalDocument::idTokenAt(size_t line, size_t col) const
+{
+   if (line >= myLines.size()){ return nullptr; }
+   for (const Token &tok : myLines[line].tokens){
+      if (tok.tag == TokenTag::ID && tok.col <= col
+         && col <= tok.col + ((IDToken *)tok.value)->value().size()){
+         return &tok;
+      }
+      if (tok.col > col){ break; }
+   }
+   return nullptr;
+}
+
+size_t IncrementalDocument::declNamed(const std::string &name,
+bool isStruct) const
+{
+   auto it = myNames.find(name);
+   if (it == myNames.end()){ return myDecls.size(); }
+   for (size_t i : it->second){
+      if (isStruct == (myDecls[i].node->kind() == STRUCT_DECL_NODE)){
+         return i;
+      }
+   }
+   return myDecls.size();
+}
+
+ProgramNode * IncrementalDocument::program() const
+{
+   if (myProgramStale){
+      // Rehashes the list and the program, and makes the list the
+      // parent of the declarations spliced into it
+      myProgram->getDeclList()->modified();
+      myProgramStale = false;
+   }
+   return myProgram;
+}
+
+void IncrementalDocument::collectDiagnostics(Diagnostics &out) const
+{
+   for (size_t i = 0; i < myLines.size(); i++){
+      for (Diagnostics::Entry e : myLines[i].lexErrors){
+         e.line = i + 1;
+         out.report(e);
+      }
+   }
+   for (const Decl &d : myDecls){
+      for (Diagnostics::Entry e : d.parseErrors){
+         e.line += d.firstLine + 1;
+         out.report(e);
+      }
+   }
+}
+
+} /* end namespace */
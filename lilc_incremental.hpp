@@ -0,0 +1,145 @@
+#ifndef __LILC_INCREMENTAL_HPP__
+#define __LILC_INCREMENTAL_HPP__ 1
+
+#include <string>
+#include <list>
+#include <unordered_map>
+#include <vector>
+#include <cstddef>
+
+#include "lilc_scanner.hpp"
+#include "lilc_diagnostics.hpp"
+#include "lilc_source.hpp"
+#include "ast.hpp"
+
+namespace LILC{
+
+class LilC_Compiler;
+
+// A token as stored between parses: the tag returned by the scanner,
+// the semantic value it produced, where it started and its length.
+struct Token{
+   int tag;
+   SynSymbol * value;
+   size_t line;
+   size_t col;
+   size_t length;
+};
+
+// Feeds an already lexed token sequence to LilC_Parser in place of the
+// flex scanner. Spans are offsets into text, found from the tokens'
+// lines and columns.
+class TokenReplayScanner : public LilC_Scanner{
+public:
+   TokenReplayScanner(const Token * begin, const Token * end,
+      Diagnostics * diagnostics, const RopeSource * text)
+   : LilC_Scanner(nullptr, diagnostics), cur(begin), last(end), text(text)
+   {
+      current.line = begin != end ? begin->line + 1 : 1;
+      current.col = 1;
+   };
+
+   using LilC_Scanner::yylex;
+   int yylex( LILC::LilC_Parser::semantic_type * const lval) override;
+   Position position() const override { return current; }
+   Span tokenSpan(int tag) const override { return currentSpan; }
+
+private:
+   const Token * cur;
+   const Token * last;
+   const RopeSource * text;
+   Position current;
+   Span currentSpan;
+};
+
+// An editor buffer that keeps the tokens of every line and the AST of
+// every top-level declaration between edits. Lil' C has no token that
+// spans a newline, so an edit only re-lexes the lines it touches; only
+// the top-level declarations overlapping those lines are re-parsed and
+// every other DeclNode is reused as is. The text itself lives in a
+// RopeSource. Lines and columns are 0-based.
+class IncrementalDocument{
+public:
+   struct Line{
+      std::vector<Token> tokens;
+      std::vector<Diagnostics::Entry> lexErrors;
+      // No byte of the line is outside 7-bit ASCII, so byte and
+      // character columns agree.
+      bool ascii = true;
+   };
+
+   // One top-level declaration, from the column of its first token on
+   // firstLine to the column of its last token on lastLine. node is null
+   // when its tokens failed to parse; the errors are kept in parseErrors.
+   // The spans in node are offsets into the text as it was when the
+   // declaration was last parsed. The document owns node, and frees it
+   // when an edit replaces the declaration; pos is where node is in the
+   // list of program(), when node is not null.
+   struct Decl{
+      size_t firstLine;
+      size_t lastLine;
+      size_t firstCol;
+      size_t lastCol;
+      DeclNode * node;
+      std::list<DeclNode *>::iterator pos;
+      std::vector<Diagnostics::Entry> parseErrors;
+   };
+
+   IncrementalDocument();
+   ~IncrementalDocument();
+   IncrementalDocument(const IncrementalDocument &) = delete;
+   IncrementalDocument & operator=(const IncrementalDocument &) = delete;
+
+   void setText(const std::string &text);
+   void edit(size_t startLine, size_t startCol, size_t endLine,
+      size_t endCol, const std::string &text);
+
+   std::string text() const { return myText.str(); }
+   std::string lineText(size_t i) const {
+      size_t start = myText.lineStart(i);
+      return myText.substr(start, myText.lineEnd(i) - start);
+   }
+   const RopeSource & source() const { return myText; }
+   size_t lineCount() const { return myLines.size(); }
+   const Line & line(size_t i) const { return myLines[i]; }
+   const std::vector<Decl> & decls() const { return myDecls; }
+   // Index of the declaration containing the given position, or
+   // decls().size() if it lies between declarations.
+   size_t declAt(size_t line, size_t col) const;
+   // The identifier token covering (or ending at) the given position, or
+   // null.
+   const Token * idTokenAt(size_t line, size_t col) const;
+   // Index of the first declaration that declares name and is a struct
+   // (or, if !isStruct, is not one), or decls().size() if there is none.
+   // A name declared again is an error, and the first declaration is the
+   // one that stands.
+   size_t declNamed(const std::string &name, bool isStruct) const;
+
+   // The document's ProgramNode over its current declarations; it
+   // belongs to the document. An edit only splices the declarations it
+   // re-parsed into the program's list, and the hashes of the list and
+   // the program are brought up to date here, on the next call.
+   ProgramNode * program() const;
+
+   // Reports every lexical and syntax error of the document.
+   void collectDiagnostics(Diagnostics &out) const;
+
+private:
+   void lexLines(size_t first, size_t last);
+   void reparse(size_t firstDecl, size_t lastDecl, size_t firstLine,
+      size_t lastLine);
+   Decl parseDecl(std::vector<Token> &tokens, size_t firstLine,
+      size_t lastLine);
+
+   RopeSource myText;
+   std::vector<Line> myLines;
+   std::vector<Decl> myDecls;
+   ProgramNode * myProgram = nullptr;
+   mutable bool myProgramStale = false;
+   // The declarations that parsed, by the name they declare, in order
+   std::unordered_map<std::string, std::vector<size_t> > myNames;
+   LilC_Compiler * myCompiler;
+};
+
+} /* end namespace */
+#endif /* END __LILC_INCREMENTAL_HPP__ */
@@ -0,0 +1,279 @@
+#include <cstdio>
+#include <cstdlib>
+#include <cmath>
+#include <cstring>
+
+#include "lilc_json.hpp"
+
+namespace LILC{
+
+void appendJSONString(std::string &buf, const std::string &str){
+   buf += '"';
+   for (unsigned char c : str){
+      switch (c){
+         case '"': buf += "\\\""; break;
+         case '\\': buf += "\\\\"; break;
+         case '\n': buf += "\\n"; break;
+         case '\r': buf += "\\r"; break;
+         case '\t': buf += "\\t"; break;
+         default:
+            if (c < 0x20){
+               char esc[8];
+               snprintf(esc, sizeof(esc), "\\u%04x", c);
+               buf += esc;
+            } else {
+               buf += (char)c;
+            }
+      }
+   }
+   buf += '"';
+}
+
+namespace {
+
+class JSONReader{
+public:
+   JSONReader(const std::string &text) : text(text) { }
+
+   bool value(JSONValue &out, int depth){
+      skipSpace();
+      if (pos >= text.size() || depth > MAX_DEPTH){ return false; }
+      char c = text[pos];
+      if (c == '{'){ return object(out, depth); }
+      if (c == '['){ return array(out, depth); }
+      if (c == '"'){
+         std::string s;
+         if (!string(s)){ return false; }
+         out = JSONValue(s);
+         return true;
+      }
+      if (literal("true")){ out = JSONValue(true); return true; }
+      if (literal("false")){ out = JSONValue(false); return true; }
+      if (literal("null")){ out = JSONValue(); return true; }
+      return number(out);
+   }
+
+   bool atEnd(){
+      skipSpace();
+      return pos == text.size();
+   }
+
+private:
+   static const int MAX_DEPTH = 512;
+
+   void skipSpace(){
+      while (pos < text.size() && (text[pos] == ' ' || text[pos] == '\t'
+         || text[pos] == '\n' || text[pos] == '\r')){
+         pos++;
+      }
+   }
+
+   bool literal(const char * word){
+      size_t len = strlen(word);
+      if (text.compare(pos, len, word) != 0){ return false; }
+      pos += len;
+      return true;
+   }
+
+   bool number(JSONValue &out){
+      const char * start = text.c_str() + pos;
+      char * end = nullptr;
+      double n = strtod(start, &end);
+      if (end == start){ return false; }
+      pos += end - start;
+      out = JSONValue(n);
+      return true;
+   }
+
+   static void appendUTF8(std::string &s, unsigned cp){
+      if (cp < 0x80){
+         s += (char)cp;
+      } else if (cp < 0x800){
+         s += (char)(0xC0 | (cp >> 6));
+         s += (char)(0x80 | (cp & 0x3F));
+      } else if (cp < 0x10000){
+         s += (char)(0xE0 | (cp >> 12));
+         s += (char)(0x80 | ((cp >> 6) & 0x3F));
+         s += (char)(0x80 | (cp & 0x3F));
+      } else {
+         s += (char)(0xF0 | (cp >> 18));
+         s += (char)(0x80 | ((cp >> 12) & 0x3F));
+         s += (char)(0x80 | ((cp >> 6) & 0x3F));
+         s += (char)(0x80 | (cp & 0x3F));
+      }
+   }
+
+   bool hex4(unsigned &cp){
+      if (pos + 4 > text.size()){ return false; }
+      cp = (unsigned)strtoul(text.substr(pos, 4).c_str(), nullptr, 16);
+      pos += 4;
+      return true;
+   }
+
+   bool string(std::string &s){
+      pos++; // opening quote
+      while (pos < text.size()){
+         char c = text[pos++];
+         if (c == '"'){ return true; }
+         if (c != '\\'){
+            s += c;
+            continue;
+         }
+         if (pos >= text.size()){ return false; }
+         char esc = text[pos++];
+         switch (esc){
+            case 'n': s += '\n'; break;
+            case 't': s += '\t'; break;
+            case 'r': s += '\r'; break;
+            case 'b': s += '\b'; break;
+            case 'f': s += '\f'; break;
+            case 'u': {
+               unsigned cp;
+               if (!hex4(cp)){ return false; }
+               if (cp >= 0xD800 && cp < 0xDC00 && text.compare(pos, 2, "\\u") == 0){
+                  pos += 2;
+                  unsigned low;
+                  if (!hex4(low)){ return false; }
+                  cp = 0x10000 + ((cp - 0xD800) << 10) + (low - 0xDC00);
+               }
+               appendUTF8(s, cp);
+               break;
+            }
+            default: s += esc; break;
+         }
+      }
+      return false;
+   }
+
+   bool array(JSONValue &out, int depth){
+      pos++;
+      out = JSONValue::array();
+      skipSpace();
+      if (pos < text.size() && text[pos] == ']'){ pos++; return true; }
+      while (true){
+         JSONValue item;
+         if (!value(item, depth + 1)){ return false; }
+         out.push(std::move(item));
+         skipSpace();
+         if (pos >= text.size()){ return false; }
+         char c = text[pos++];
+         if (c == ']'){ return true; }
+         if (c != ','){ return false; }
+      }
+   }
+
+   bool object(JSONValue &out, int depth){
+      pos++;
+      out = JSONValue::object();
+      skipSpace();
+      if (pos < text.size() && text[pos] == '}'){ pos++; return true; }
+      while (true){
+         skipSpace();
+         std::string key;
+         if (pos >= text.size() || text[pos] != '"' || !string(key)){
+            return false;
+         }
+         skipSpace();
+         if (pos >= text.size() || text[pos++] != ':'){ return false; }
+         JSONValue member;
+         if (!value(member, depth + 1)){ return false; }
+         out.set(key, std::move(member));
+         skipSpace();
+         if (pos >= text.size()){ return false; }
+         char c = text[pos++];
+         if (c == '}'){ return true; }
+         if (c != ','){ return false; }
+      }
+   }
+
+   const std::string &text;
+   size_t pos = 0;
+};
+
+} /* end anonymous namespace */
+
+JSONValue JSONValue::parse(const std::string &text, bool &ok){
+   JSONReader reader(text);
+   JSONValue result;
+   ok = reader.value(result, 0) && reader.atEnd();
+   if (!ok){
+      return JSONValue();
+   }
+   return result;
+}
+
+bool JSONValue::has(const std::string &key) const {
+   for (const auto &member : myMembers){
+      if (member.first == key){ return true; }
+   }
+   return false;
+}
+
+const JSONValue & JSONValue::operator[](const std::string &key) const {
+   static const JSONValue null;
+   for (const auto &member : myMembers){
+      if (member.first == key){ return member.second; }
+   }
+   return null;
+}
+
+const JSONValue & JSONValue::operator[](size_t idx) const {
+   static const JSONValue null;
+   return idx < myItems.size() ? myItems[idx] : null;
+}
+
+JSONValue & JSONValue::set(const std::string &key, JSONValue value){
+   for (auto &member : myMembers){
+      if (member.first == key){
+         member.second = std::move(value);
+         return *this;
+      }
+   }
+   myMembers.emplace_back(key, std::move(value));
+   return *this;
+}
+
+JSONValue & JSONValue::push(JSONValue value){
+   myItems.push_back(std::move(value));
+   return *this;
+}
+
+void JSONValue::write(std::string &out) const {
+   switch (myType){
+      case NUL: out += "null"; break;
+      case BOOLEAN: out += myBool ? "true" : "false"; break;
+      case NUMBER: {
+         char num[32];
+         if (std::fabs(myNumber) < 9e15 && myNumber == std::floor(myNumber)){
+            snprintf(num, sizeof(num), "%lld", (long long)myNumber);
+         } else if (std::isfinite(myNumber)){
+            snprintf(num, sizeof(num), "%.17g", myNumber);
+         } else {
+            snprintf(num, sizeof(num), "null");
+         }
+         out += num;
+         break;
+      }
+      case STRING: appendJSONString(out, myString); break;
+      case ARRAY:
+         out += '[';
+         for (size_t i = 0; i < myItems.size(); i++){
+            if (i > 0){ out += ','; }
+            myItems[i].write(out);
+         }
+         out += ']';
+         break;
+      case OBJECT:
+         out += '{';
+         for (size_t i = 0; i < myMembers.size(); i++){
+            if (i > 0){ out += ','; }
+            appendJSONString(out, myMembers[i].first);
+            out += ':';
+            myMembers[i].second.write(out);
+         }
+         out += '}';
+         break;
+   }
+}
+
+} /* end namespace */
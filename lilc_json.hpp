@@ -0,0 +1,70 @@
+#ifndef __LILC_JSON_HPP__
+#define __LILC_JSON_HPP__ 1
+
+#include <string>
+#include <vector>
+#include <utility>
+#include <cstddef>
+
+namespace LILC{
+
+// Appends str to buf as a quoted, escaped JSON string.
+void appendJSONString(std::string &buf, const std::string &str);
+
+// A small JSON document model for the language server protocol and the
+// benchmark baselines. Object members keep their insertion order.
+class JSONValue{
+public:
+   enum Type { NUL, BOOLEAN, NUMBER, STRING, ARRAY, OBJECT };
+
+   JSONValue() : myType(NUL) { }
+   JSONValue(bool b) : myType(BOOLEAN), myBool(b) { }
+   JSONValue(int n) : myType(NUMBER), myNumber(n) { }
+   JSONValue(long long n) : myType(NUMBER), myNumber((double)n) { }
+   JSONValue(size_t n) : myType(NUMBER), myNumber((double)n) { }
+   JSONValue(double n) : myType(NUMBER), myNumber(n) { }
+   JSONValue(const char * s) : myType(STRING), myString(s) { }
+   JSONValue(const std::string &s) : myType(STRING), myString(s) { }
+
+   static JSONValue array(){ JSONValue v; v.myType = ARRAY; return v; }
+   static JSONValue object(){ JSONValue v; v.myType = OBJECT; return v; }
+
+   // Parses text; on malformed input ok is set to false and null is
+   // returned.
+   static JSONValue parse(const std::string &text, bool &ok);
+
+   Type type() const { return myType; }
+   bool isNull() const { return myType == NUL; }
+   bool boolean() const { return myType == BOOLEAN && myBool; }
+   double number() const { return myType == NUMBER ? myNumber : 0; }
+   const std::string & string() const { return myString; }
+
+   size_t size() const {
+      return myType == OBJECT ? myMembers.size() : myItems.size();
+   }
+   const std::vector<JSONValue> & items() const { return myItems; }
+   const std::vector<std::pair<std::string, JSONValue> > & members() const {
+      return myMembers;
+   }
+   bool has(const std::string &key) const;
+   // Missing keys and out of range indices yield null.
+   const JSONValue & operator[](const std::string &key) const;
+   const JSONValue & operator[](size_t idx) const;
+
+   JSONValue & set(const std::string &key, JSONValue value);
+   JSONValue & push(JSONValue value);
+
+   void write(std::string &out) const;
+   std::string str() const { std::string out; write(out); return out; }
+
+private:
+   Type myType;
+   bool myBool = false;
+   double myNumber = 0;
+   std::string myString;
+   std::vector<JSONValue> myItems;
+   std::vector<std::pair<std::string, JSONValue> > myMembers;
+};
+
+} /* end namespace */
+#endif /* END __LILC_JSON_HPP__ */
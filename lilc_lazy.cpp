@@ -0,0 +1,234 @@
+#include <fstream>
+#include <algorithm>
+
+#include "lilc_lazy.hpp"
+#include "lilc_timing.hpp"
+#include "lilc_compiler.hpp"
+
+using TokenTag = LILC::LilC_Parser::token;
+
+namespace LILC{
+
+LazyProgram::LazyProgram()
+: myCompiler(new LilC_Compiler())
+{
+}
+
+LazyProgram::~LazyProgram()
+{
+   clear();
+   delete(myCompiler);
+}
+
+// Frees the program and every parsed declaration
+void LazyProgram::clear()
+{
+   if (myProgram != nullptr){
+      delete(myProgram->getDeclList());
+      delete(myProgram);
+      myProgram = nullptr;
+   }
+   for (DeclNode * node : myNodes){
+      if (node != nullptr){ node->deleteTree(); }
+   }
+   myNodes.clear();
+}
+
+void LazyProgram::load(const std::string &text)
+{
+   clear();
+   myIndex = LineIndex(text.data(), text.size());
+   MemoryStreamBuf buf(text.data(), text.size());
+   std::istream in(&buf);
+   Diagnostics diags;
+   myTokens.lex(in, &diags, &myIndex);
+   myLexErrors = diags.entries();
+
+   myRanges.clear();
+   size_t first = 0;
+   size_t depth = 0;
+   bool open = false;
+   bool isStruct = false;
+   for (size_t i = 0; i + 1 < myTokens.size(); i++){
+      int tag = myTokens[i].tag;
+      if (!open){
+         open = true;
+         first = i;
+         depth = 0;
+         isStruct = tag == TokenTag::STRUCT;
+      }
+      bool done = false;
+      if (tag == TokenTag::LCURLY){
+         depth++;
+      } else if (tag == TokenTag::RCURLY){
+         if (depth > 0){ depth--; }
+         done = depth == 0 && !isStruct;
+      } else if (tag == TokenTag::SEMICOLON){
+         done = depth == 0;
+      }
+      if (done){
+         myRanges.push_back(DeclRange{ (uint32_t)first, (uint32_t)i + 1 });
+         open = false;
+      }
+   }
+   if (open){
+      myRanges.push_back(DeclRange{ (uint32_t)first,
+         (uint32_t)myTokens.size() - 1 });
+   }
+
+   myNodes.assign(myRanges.size(), nullptr);
+   myParsed.assign(myRanges.size(), false);
+   myErrors.clear();
+   myMaterialized = 0;
+}
+
+size_t LazyProgram::declAt(size_t offset) const
+{
+   // Last declaration starting at or before the offset
+   size_t idx = std::upper_bound(myRanges.begin(), myRanges.end(), offset,
+      [this](size_t off, const DeclRange &e){
+         return off < myTokens[e.firstToken].offset;
+      }) - myRanges.begin();
+   if (idx == 0){ return myRanges.size(); }
+   const TokenRecord &last = myTokens[myRanges[idx - 1].endToken - 1];
+   return offset <= last.offset + last.length ? idx - 1 : myRanges.size();
+}
+
+DeclNode * LazyProgram::decl(size_t i)
+{
+   if (myParsed[i]){
+      return myNodes[i];
+   }
+   Diagnostics &diags = myCompiler->diagnostics();
+   diags.clear();
+   myCompiler->setASTRoot(nullptr);
+   TokenArrayScanner scanner(myTokens, &diags, &myIndex,
+      myRanges[i].firstToken, myRanges[i].endToken);
+   LilC_Parser parser(scanner, *myCompiler);
+   const int accept( 0 );
+   bool accepted = parser.parse() == accept;
+   ProgramNode * root = myCompiler->getASTRoot();
+   if (root != nullptr){
+      // Keep the declaration and free the program around it
+      for (DeclNode * parsed : *root->getDeclList()->getDecls()){
+         if (accepted && myNodes[i] == nullptr){
+            myNodes[i] = parsed;
+         } else {
+            parsed->deleteTree();
+         }
+      }
+      delete(root->getDeclList());
+      delete(root);
+      myCompiler->setASTRoot(nullptr);
+   }
+   if (!diags.empty()){
+      myErrors[i] = diags.entries();
+   }
+   diags.clear();
+   myParsed[i] = true;
+   myMaterialized++;
+   return myNodes[i];
+}
+
+ProgramNode * LazyProgram::program()
+{
+   if (myProgram != nullptr){
+      delete(myProgram->getDeclList());
+      delete(myProgram);
+   }
+   std::list<DeclNode *> nodes;
+   for (size_t i = 0; i < myRanges.size(); i++){
+      if (DeclNode * node = decl(i)){
+         nodes.push_back(node);
+      }
+   }
+   DeclListNode * list = new DeclListNode(&nodes);
+   myProgram = new ProgramNode(list);
+   if (!myRanges.empty()){
+      // As parsed whole, the program starts with an empty declList at
+      // the start of input.
+      const TokenRecord &last = myTokens[myRanges.back().endToken - 1];
+      Span span = makeSpan(0, last.offset + last.length);
+      list->setSpan(span);
+      myProgram->setSpan(span);
+   }
+   return myProgram;
+}
+
+void LazyProgram::collectDiagnostics(Diagnostics &out)
+{
+   for (const Diagnostics::Entry &e : myLexErrors){
+      out.report(e);
+   }
+   for (size_t i = 0; i < myRanges.size(); i++){
+      decl(i);
+      auto found = myErrors.find(i);
+      if (found == myErrors.end()){ continue; }
+      for (const Diagnostics::Entry &e : found->second){
+         out.report(e);
+      }
+   }
+}
+
+int lazyBenchmark(const char * filename, std::ostream &report)
+{
+   std::ifstream in(filename);
+   if (!in.good()){
+      report << "cannot open " << filename << "\n";
+      return 1;
+   }
+   std::string text((std::istreambuf_iterator<char>(in)),
+      std::istreambuf_iterator<char>());
+   const int rounds = 9;
+
+   LilC_Compiler eager;
+   if (!eager.buildAST(text)){
+      return 1;
+   }
+   LazyProgram lazy;
+   lazy.load(text);
+   report << text.size() << " bytes, " << lazy.declCount()
+      << " declarations, "
+      << lazy.ranges().size() * sizeof(LazyProgram::DeclRange)
+      << " bytes of index\n";
+
+   struct Pass{
+      const char * name;
+      double median;
+   };
+   const Pass passes[] = {
+      { "eager parse", medianMs(rounds, [&](){
+         LilC_Compiler compiler;
+         compiler.buildAST(text);
+      }) },
+      { "lazy load", medianMs(rounds, [&](){
+         LazyProgram program;
+         program.load(text);
+      }) },
+      { "lazy load + one decl", medianMs(rounds, [&](){
+         LazyProgram program;
+         program.load(text);
+         if (program.declCount() > 0){
+            program.decl(program.declCount() / 2);
+         }
+      }) },
+      { "lazy load + all decls", medianMs(rounds, [&](){
+         LazyProgram program;
+         program.load(text);
+         program.program();
+      }) },
+   };
+   for (const Pass &pass : passes){
+      report << pass.name << ": median " << pass.median << " ms ("
+         << rounds << " rounds)\n";
+   }
+
+   if (!lazy.program()->equals(eager.getASTRoot())){
+      report << "lazy program differs from the eager AST\n";
+      return 1;
+   }
+   report << "lazy program equals the eager AST\n";
+   return 0;
+}
+
+} /* end namespace */
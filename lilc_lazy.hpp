@@ -0,0 +1,85 @@
+#ifndef __LILC_LAZY_HPP__
+#define __LILC_LAZY_HPP__ 1
+
+#include <string>
+#include <vector>
+#include <ostream>
+#include <cstdint>
+#include <unordered_map>
+
+#include "lilc_tokens.hpp"
+#include "lilc_diagnostics.hpp"
+#include "lilc_source.hpp"
+#include "ast.hpp"
+
+namespace LILC{
+
+class LilC_Compiler;
+
+// A program whose AST is built one top-level declaration at a time, on
+// demand. Loading only lexes the text into a TokenArray and appends one
+// 8-byte entry per top-level declaration to a flat index: the token
+// range of the declaration, found by matching braces and semicolons as
+// IncrementalDocument does rather than by running the parser. No AST
+// node is allocated until decl() asks for one; the declaration's tokens
+// are then parsed on their own and the node is kept. Spans in the nodes
+// are offsets into the loaded text.
+//
+// Syntax errors are found only as declarations are parsed, so a consumer
+// that needs all of them calls program() or collectDiagnostics().
+class LazyProgram{
+public:
+   struct DeclRange{
+      uint32_t firstToken;
+      uint32_t endToken;
+   };
+
+   LazyProgram();
+   ~LazyProgram();
+   LazyProgram(const LazyProgram &) = delete;
+   LazyProgram & operator=(const LazyProgram &) = delete;
+
+   void load(const std::string &text);
+
+   const TokenArray & tokens() const { return myTokens; }
+   const std::vector<DeclRange> & ranges() const { return myRanges; }
+   size_t declCount() const { return myRanges.size(); }
+   // Index of the declaration whose tokens cover byte offset, or
+   // declCount() if it lies between declarations.
+   size_t declAt(size_t offset) const;
+
+   // The AST of declaration i, parsed on first request; null if its
+   // tokens do not parse. The node belongs to this object.
+   DeclNode * decl(size_t i);
+   size_t materialized() const { return myMaterialized; }
+
+   // A ProgramNode over every declaration, parsing those not yet parsed.
+   // It belongs to this object and is valid until the next call.
+   ProgramNode * program();
+
+   // Reports the lexical errors and those of every declaration, parsing
+   // the ones not yet parsed.
+   void collectDiagnostics(Diagnostics &out);
+
+private:
+   void clear();
+
+   LineIndex myIndex;
+   TokenArray myTokens;
+   std::vector<Diagnostics::Entry> myLexErrors;
+   std::vector<DeclRange> myRanges;
+   std::vector<DeclNode *> myNodes;
+   std::vector<bool> myParsed;
+   std::unordered_map<size_t, std::vector<Diagnostics::Entry> > myErrors;
+   size_t myMaterialized = 0;
+   ProgramNode * myProgram = nullptr;
+   LilC_Compiler * myCompiler;
+};
+
+// Times loading filename lazily against parsing it eagerly, then
+// touching one declaration and all of them, and checks that the lazily
+// built program equals the eager one. Returns 1 if it does not.
+int lazyBenchmark(const char * filename, std::ostream &report);
+
+} /* end namespace */
+#endif /* END __LILC_LAZY_HPP__ */
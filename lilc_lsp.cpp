@@ -0,0 +1,710 @@
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iterator>
+#include <map>
+#include <sstream>
+#include <strings.h>
+#include <unordered_map>
+
+#include "lilc_lsp.hpp"
+#include "lilc_unparse.hpp"
+
+using TokenTag = LILC::LilC_Parser::token;
+
+namespace LILC{
+
+namespace {
+
+// LSP symbol kinds
+const int SYMBOL_FIELD = 8;
+const int SYMBOL_FUNCTION = 12;
+const int SYMBOL_VARIABLE = 13;
+const int SYMBOL_STRUCT = 23;
+
+struct Located{
+   size_t line;
+   const Token * tok;
+};
+
+size_t utf16ToByte(const std::string &text, size_t units){
+   size_t i = 0;
+   while (i < text.size() && units > 0){
+      unsigned char c = text[i];
+      size_t len = c < 0x80 ? 1 : c < 0xE0 ? 2 : c < 0xF0 ? 3 : 4;
+      units -= std::min<size_t>(units, len == 4 ? 2 : 1);
+      i += len;
+   }
+   return std::min(i, text.size());
+}
+
+size_t byteToUTF16(const std::string &text, size_t bytes){
+   size_t units = 0;
+   for (size_t i = 0; i < bytes && i < text.size(); i++){
+      unsigned char c = text[i];
+      if ((c & 0xC0) != 0x80){
+         units += c >= 0xF0 ? 2 : 1;
+      }
+   }
+   return units;
+}
+
+JSONValue position(const IncrementalDocument &doc, size_t line, size_t col){
+   JSONValue pos = JSONValue::object();
+   pos.set("line", line);
+   pos.set("character", doc.line(line).ascii ? col
+      : byteToUTF16(doc.lineText(line), col));
+   return pos;
+}
+
+JSONValue range(const IncrementalDocument &doc, size_t line1, size_t col1,
+size_t line2, size_t col2){
+   JSONValue r = JSONValue::object();
+   r.set("start", position(doc, line1, col1));
+   r.set("end", position(doc, line2, col2));
+   return r;
+}
+
+JSONValue tokenRange(const IncrementalDocument &doc, const Located &loc){
+   size_t len = ((IDToken *)loc.tok->value)->value().size();
+   return range(doc, loc.line, loc.tok->col, loc.line, loc.tok->col + len);
+}
+
+std::string idName(const Token * tok){
+   if (tok->tag != TokenTag::ID){ return std::string(); }
+   return ((IDToken *)tok->value)->value();
+}
+
+// The identifier tokens of a declaration, in order. Every ID token the
+// parser accepts becomes one IdNode, and a pre-order walk of the tree
+// (see ASTNode::children) meets them in the order of the text, so the
+// n-th IdNode of a declaration is its n-th identifier. Unlike the spans
+// in the tree, the tokens move with the edits made since the parse.
+void declIds(const IncrementalDocument &doc,
+const IncrementalDocument::Decl &d, std::vector<Located> &out){
+   for (size_t line = d.firstLine; line <= d.lastLine; line++){
+      for (const Token &tok : doc.line(line).tokens){
+         if (line == d.firstLine && tok.col < d.firstCol){ continue; }
+         if (line == d.lastLine && tok.col > d.lastCol){ break; }
+         if (tok.tag == TokenTag::ID){ out.push_back(Located{line, &tok}); }
+      }
+   }
+}
+
+// The children of a node, appended to one buffer that every view shares
+// and dropped from it again when the view goes, so a walk allocates
+// nothing once the buffer is as deep as the tree. Views nest like the
+// calls that make them; index one rather than iterate over it, as a
+// walk under it may grow the buffer.
+class Kids{
+public:
+   explicit Kids(ASTNode * node) : myMark(buffer().size()) {
+      node->children(buffer());
+   }
+   ~Kids(){ buffer().resize(myMark); }
+   Kids(const Kids &) = delete;
+   Kids & operator=(const Kids &) = delete;
+   size_t size() const { return buffer().size() - myMark; }
+   ASTNode * operator[](size_t i) const { return buffer()[myMark + i]; }
+private:
+   static std::vector<ASTNode *> & buffer(){
+      static thread_local std::vector<ASTNode *> buf;
+      return buf;
+   }
+   size_t myMark;
+};
+
+// The IdNodes under node, in pre-order
+void idNodes(ASTNode * node, std::vector<ASTNode *> &out){
+   if (node->kind() == ID_NODE){ out.push_back(node); }
+   Kids k(node);
+   for (size_t i = 0; i < k.size(); i++){ idNodes(k[i], out); }
+}
+
+// The identifier a variable, formal, function or struct declaration
+// declares
+IdNode * declaredId(ASTNode * decl){
+   Kids k(decl);
+   return static_cast<IdNode *>(k[decl->kind() == STRUCT_DECL_NODE ? 0 : 1]);
+}
+
+// A declaration found for a name: the top-level declaration it is in,
+// and the variable, formal, function or struct declaration itself.
+struct Site{
+   size_t decl;
+   ASTNode * node;
+};
+
+// Resolves the identifiers of one top-level declaration by walking its
+// tree with the scopes Lil' C has: a function's formals and the locals at
+// the top of its body share a scope, the body of an if, else or while
+// opens another, and a name not declared in any of them is a top-level
+// declaration. A field after '.' is looked up in the struct type of the
+// expression before it.
+class ScopeWalk{
+public:
+   ScopeWalk(const IncrementalDocument &doc, size_t decl)
+   : myDoc(doc), myDecl(decl) { }
+
+   // The declaration of the target-th identifier of the declaration
+   bool resolve(size_t target, Site &found){
+      myTarget = target;
+      myFound = false;
+      myNext = 0;
+      walk(myDoc.decls()[myDecl].node);
+      found = myResult;
+      return myFound;
+   }
+
+   // The top-level declaration of name (a struct if wantStruct)
+   bool global(const std::string &name, bool wantStruct, Site &found) const {
+      size_t i = myDoc.declNamed(name, wantStruct);
+      if (i == myDoc.decls().size()){ return false; }
+      found = Site{ i, myDoc.decls()[i].node };
+      return true;
+   }
+
+private:
+   // The struct a variable or formal holds, or "" if it is not one
+   static std::string structOf(const Site &site){
+      NodeKind kind = site.node->kind();
+      if (kind != VAR_DECL_NODE && kind != FORMAL_DECL_NODE){
+         return std::string();
+      }
+      ASTNode * type = Kids(site.node)[0];
+      if (type->kind() != STRUCT_NODE){ return std::string(); }
+      return static_cast<IdNode *>(Kids(type)[0])->getName();
+   }
+
+   bool field(const std::string &structName, const std::string &name,
+   Site &found) const {
+      Site type;
+      if (structName.empty() || !global(structName, true, type)){
+         return false;
+      }
+      ASTNode * fields = Kids(type.node)[1];
+      Kids k(fields);
+      for (size_t i = 0; i < k.size(); i++){
+         if (declaredId(k[i])->getName() == name){
+            found = Site{ type.decl, k[i] };
+            return true;
+         }
+      }
+      return false;
+   }
+
+   // Numbers an identifier and notes what it resolved to
+   void id(bool resolved, const Site &site){
+      if (myNext++ == myTarget && resolved){
+         myFound = true;
+         myResult = site;
+      }
+   }
+
+   void declare(ASTNode * decl){
+      Site site{ myDecl, decl };
+      if (!myScopes.empty()){
+         myScopes.back()[declaredId(decl)->getName()] = site;
+      }
+      id(true, site);
+   }
+
+   // Walks node; for an expression, returns the struct its value is
+   std::string walk(ASTNode * node){
+      Kids k(node);
+      switch (node->kind()){
+         case ID_NODE: {
+            const std::string &name = static_cast<IdNode *>(node)->getName();
+            Site site;
+            bool resolved = false;
+            for (size_t i = myScopes.size(); i > 0 && !resolved; i--){
+               auto it = myScopes[i - 1].find(name);
+               if (it != myScopes[i - 1].end()){
+                  site = it->second;
+                  resolved = true;
+               }
+            }
+            if (!resolved){ resolved = global(name, false, site); }
+            id(resolved, site);
+            return resolved ? structOf(site) : std::string();
+         }
+         case STRUCT_NODE: {
+            Site site;
+            id(global(static_cast<IdNode *>(k[0])->getName(), true, site),
+               site);
+            return std::string();
+         }
+         case VAR_DECL_NODE: case FORMAL_DECL_NODE:
+            walk(k[0]);
+            declare(node);
+            return std::string();
+         case FN_DECL_NODE:
+            walk(k[0]);
+            declare(node);
+            myScopes.emplace_back();
+            walk(k[2]);
+            walk(k[3]);
+            myScopes.pop_back();
+            return std::string();
+         case STRUCT_DECL_NODE:
+            declare(node);
+            myScopes.emplace_back();
+            walk(k[1]);
+            myScopes.pop_back();
+            return std::string();
+         case IF_STMT_NODE: case IF_ELSE_STMT_NODE: case WHILE_STMT_NODE:
+            walk(k[0]);
+            for (size_t i = 1; i + 1 < k.size(); i += 2){
+               myScopes.emplace_back();
+               walk(k[i]);
+               walk(k[i + 1]);
+               myScopes.pop_back();
+            }
+            return std::string();
+         case DOT_ACCESS_NODE: {
+            std::string base = walk(k[0]);
+            Site site;
+            bool resolved = field(base,
+               static_cast<IdNode *>(k[1])->getName(), site);
+            id(resolved, site);
+            return resolved ? structOf(site) : std::string();
+         }
+         default:
+            for (size_t i = 0; i < k.size(); i++){ walk(k[i]); }
+            return std::string();
+      }
+   }
+
+   const IncrementalDocument &myDoc;
+   size_t myDecl;
+   size_t myTarget = 0;
+   size_t myNext = 0;
+   bool myFound = false;
+   Site myResult{ 0, nullptr };
+   std::vector<std::unordered_map<std::string, Site> > myScopes;
+};
+
+// The identifiers of one top-level declaration, as IdNodes and as
+// tokens. The token of the identifier a declaration (or the top-level
+// declaration's own node) declares is found by its place among them.
+class DeclIds{
+public:
+   DeclIds(const IncrementalDocument &doc, size_t decl){
+      const IncrementalDocument::Decl &d = doc.decls()[decl];
+      if (d.node != nullptr){ idNodes(d.node, myNodes); }
+      declIds(doc, d, myTokens);
+   }
+
+   bool declared(ASTNode * decl, Located &out) const {
+      size_t n = std::find(myNodes.begin(), myNodes.end(), declaredId(decl))
+         - myNodes.begin();
+      if (n >= myTokens.size()){ return false; }
+      out = myTokens[n];
+      return true;
+   }
+   const std::vector<Located> & tokens() const { return myTokens; }
+private:
+   std::vector<ASTNode *> myNodes;
+   std::vector<Located> myTokens;
+};
+
+// Numbers the IdNodes under node in pre-order, from count on, and notes
+// the number of the identifier that node declares (if top) and that
+// each formal and local of a function or field of a struct declares.
+// These are the places of their tokens among the declaration's
+// identifiers, as with DeclIds, found in one walk.
+void memberIds(ASTNode * node, bool top, size_t &count,
+std::vector<size_t> &out){
+   NodeKind kind = node->kind();
+   if (kind == ID_NODE){
+      count++;
+      return;
+   }
+   bool declares = top
+      || kind == VAR_DECL_NODE || kind == FORMAL_DECL_NODE;
+   size_t id = kind == STRUCT_DECL_NODE ? 0 : 1;
+   Kids k(node);
+   for (size_t i = 0; i < k.size(); i++){
+      if (declares && i == id){ out.push_back(count); }
+      memberIds(k[i], false, count, out);
+   }
+}
+
+JSONValue errorReply(const JSONValue &id, int code, const char * msg){
+   JSONValue err = JSONValue::object();
+   err.set("code", code);
+   err.set("message", msg);
+   JSONValue reply = JSONValue::object();
+   reply.set("jsonrpc", "2.0");
+   reply.set("id", id);
+   reply.set("error", err);
+   return reply;
+}
+
+} /* end anonymous namespace */
+
+JSONValue LanguageServer::initialize()
+{
+   JSONValue sync = JSONValue::object();
+   sync.set("openClose", true);
+   sync.set("change", 2); // incremental
+   JSONValue caps = JSONValue::object();
+   caps.set("textDocumentSync", sync);
+   caps.set("documentSymbolProvider", true);
+   caps.set("definitionProvider", true);
+   caps.set("documentFormattingProvider", true);
+   JSONValue info = JSONValue::object();
+   info.set("name", "lilc");
+   JSONValue result = JSONValue::object();
+   result.set("capabilities", caps);
+   result.set("serverInfo", info);
+   return result;
+}
+
+IncrementalDocument * LanguageServer::document(const JSONValue &params)
+{
+   auto it = myDocuments.find(params["textDocument"]["uri"].string());
+   return it == myDocuments.end() ? nullptr : it->second.get();
+}
+
+void LanguageServer::publishDiagnostics(const std::string &uri,
+std::vector<JSONValue> &replies)
+{
+   JSONValue list = JSONValue::array();
+   auto it = myDocuments.find(uri);
+   if (it != myDocuments.end()){
+      const IncrementalDocument &doc = *it->second;
+      Diagnostics diags(1000);
+      doc.collectDiagnostics(diags);
+      for (const Diagnostics::Entry &e : diags.entries()){
+         size_t line = e.line - 1;
+         size_t col = e.col - 1;
+         JSONValue diag = JSONValue::object();
+         diag.set("range", range(doc, line, col, line, col + 1));
+         diag.set("severity", e.severity == Diagnostics::ERROR ? 1 : 2);
+         diag.set("source", "lilc");
+         diag.set("message", e.count > 1 ? e.msg + " (repeated "
+            + std::to_string(e.count) + " times)" : e.msg);
+         list.push(std::move(diag));
+      }
+   }
+   JSONValue params = JSONValue::object();
+   params.set("uri", uri);
+   params.set("diagnostics", std::move(list));
+   JSONValue note = JSONValue::object();
+   note.set("jsonrpc", "2.0");
+   note.set("method", "textDocument/publishDiagnostics");
+   note.set("params", std::move(params));
+   replies.push_back(std::move(note));
+}
+
+JSONValue LanguageServer::documentSymbols(const IncrementalDocument &doc)
+{
+   JSONValue symbols = JSONValue::array();
+   std::vector<Located> toks;
+   std::vector<size_t> sites;
+   for (const IncrementalDocument::Decl &d : doc.decls()){
+      if (d.node == nullptr){ continue; }
+      toks.clear();
+      sites.clear();
+      declIds(doc, d, toks);
+      size_t count = 0;
+      memberIds(d.node, true, count, sites);
+      if (sites[0] >= toks.size()){ continue; }
+      const Located &name = toks[sites[0]];
+      NodeKind kind = d.node->kind();
+      int symbolKind = kind == FN_DECL_NODE ? SYMBOL_FUNCTION
+         : kind == STRUCT_DECL_NODE ? SYMBOL_STRUCT : SYMBOL_VARIABLE;
+      JSONValue children = JSONValue::array();
+      for (size_t i = 1; i < sites.size() && sites[i] < toks.size(); i++){
+         const Located &loc = toks[sites[i]];
+         JSONValue child = JSONValue::object();
+         child.set("name", idName(loc.tok));
+         child.set("kind", symbolKind == SYMBOL_STRUCT ? SYMBOL_FIELD
+            : SYMBOL_VARIABLE);
+         child.set("range", tokenRange(doc, loc));
+         child.set("selectionRange", tokenRange(doc, loc));
+         children.push(std::move(child));
+      }
+      JSONValue sym = JSONValue::object();
+      sym.set("name", idName(name.tok));
+      sym.set("kind", symbolKind);
+      sym.set("range", range(doc, d.firstLine, d.firstCol, d.lastLine,
+         d.lastCol + 1));
+      sym.set("selectionRange", tokenRange(doc, name));
+      sym.set("children", std::move(children));
+      symbols.push(std::move(sym));
+   }
+   return symbols;
+}
+
+// Resolves an identifier to its declaration with a ScopeWalk of the
+// top-level declaration it is in. In a declaration that does not parse,
+// only top-level names can be found.
+JSONValue LanguageServer::definition(const std::string &uri,
+const IncrementalDocument &doc, const JSONValue &pos)
+{
+   size_t line = (size_t)pos["line"].number();
+   if (line >= doc.lineCount()){ return JSONValue(); }
+   size_t col = utf16ToByte(doc.lineText(line),
+      (size_t)pos["character"].number());
+   const Token * target = doc.idTokenAt(line, col);
+   if (target == nullptr){ return JSONValue(); }
+   size_t declIdx = doc.declAt(line, target->col);
+   if (declIdx == doc.decls().size()){ return JSONValue(); }
+
+   ScopeWalk scopes(doc, declIdx);
+   Site site;
+   bool resolved;
+   if (doc.decls()[declIdx].node != nullptr){
+      DeclIds ids(doc, declIdx);
+      const std::vector<Located> &toks = ids.tokens();
+      size_t at = 0;
+      while (at < toks.size() && toks[at].tok != target){ at++; }
+      resolved = scopes.resolve(at, site);
+   } else {
+      resolved = scopes.global(idName(target), false, site)
+         || scopes.global(idName(target), true, site);
+   }
+   Located loc;
+   if (!resolved || !DeclIds(doc, site.decl).declared(site.node, loc)){
+      return JSONValue();
+   }
+   JSONValue location = JSONValue::object();
+   location.set("uri", uri);
+   location.set("range", tokenRange(doc, loc));
+   return location;
+}
+
+// The whole document as unparse prints it, as one edit; none while it
+// has errors. Declarations the edits since the last formatting left
+// alone copy the text they cached then.
+JSONValue LanguageServer::formatting(const IncrementalDocument &doc)
+{
+   JSONValue edits = JSONValue::array();
+   Diagnostics diags;
+   doc.collectDiagnostics(diags);
+   if (!diags.empty() || doc.lineCount() == 0){ return edits; }
+   std::ostringstream text;
+   unparseCached(doc.program(), text);
+   size_t last = doc.lineCount() - 1;
+   JSONValue edit = JSONValue::object();
+   edit.set("range", range(doc, 0, 0, last, doc.lineText(last).size()));
+   edit.set("newText", text.str());
+   edits.push(std::move(edit));
+   return edits;
+}
+
+void LanguageServer::handle(const JSONValue &message,
+std::vector<JSONValue> &replies)
+{
+   const std::string &method = message["method"].string();
+   const JSONValue &params = message["params"];
+   const JSONValue &id = message["id"];
+   bool isRequest = message.has("id");
+   JSONValue result;
+
+   if (method == "exit"){
+      myExited = true;
+      return;
+   }
+   if (myShutdown){
+      if (isRequest){
+         replies.push_back(errorReply(id, -32600, "server is shut down"));
+      }
+      return;
+   }
+
+   if (method == "initialize"){
+      result = initialize();
+   } else if (method == "shutdown"){
+      myShutdown = true;
+   } else if (method == "textDocument/didOpen"){
+      const std::string &uri = params["textDocument"]["uri"].string();
+      std::unique_ptr<IncrementalDocument> &doc = myDocuments[uri];
+      doc.reset(new IncrementalDocument());
+      doc->setText(params["textDocument"]["text"].string());
+      publishDiagnostics(uri, replies);
+   } else if (method == "textDocument/didChange"){
+      IncrementalDocument * doc = document(params);
+      if (doc == nullptr){ return; }
+      for (const JSONValue &change : params["contentChanges"].items()){
+         if (!change.has("range")){
+            doc->setText(change["text"].string());
+            continue;
+         }
+         const JSONValue &start = change["range"]["start"];
+         const JSONValue &end = change["range"]["end"];
+         size_t startLine = (size_t)start["line"].number();
+         size_t endLine = (size_t)end["line"].number();
+         startLine = std::min(startLine, doc->lineCount() - 1);
+         endLine = std::min(endLine, doc->lineCount() - 1);
+         doc->edit(startLine, utf16ToByte(doc->lineText(startLine),
+               (size_t)start["character"].number()),
+            endLine, utf16ToByte(doc->lineText(endLine),
+               (size_t)end["character"].number()),
+            change["text"].string());
+      }
+      publishDiagnostics(params["textDocument"]["uri"].string(), replies);
+   } else if (method == "textDocument/didClose"){
+      const std::string &uri = params["textDocument"]["uri"].string();
+      myDocuments.erase(uri);
+      publishDiagnostics(uri, replies);
+   } else if (method == "textDocument/documentSymbol"){
+      IncrementalDocument * doc = document(params);
+      if (doc != nullptr){ result = documentSymbols(*doc); }
+   } else if (method == "textDocument/definition"){
+      IncrementalDocument * doc = document(params);
+      if (doc != nullptr){
+         result = definition(params["textDocument"]["uri"].string(), *doc,
+            params["position"]);
+      }
+   } else if (method == "textDocument/formatting"){
+      IncrementalDocument * doc = document(params);
+      if (doc != nullptr){ result = formatting(*doc); }
+   } else if (isRequest){
+      replies.push_back(errorReply(id, -32601, "method not found"));
+      return;
+   }
+
+   if (isRequest){
+      JSONValue reply = JSONValue::object();
+      reply.set("jsonrpc", "2.0");
+      reply.set("id", id);
+      reply.set("result", std::move(result));
+      replies.push_back(std::move(reply));
+   }
+}
+
+int LanguageServer::run(std::istream &in, std::ostream &out)
+{
+   std::string header;
+   std::vector<JSONValue> replies;
+   while (!myExited){
+      size_t length = 0;
+      bool sawLength = false;
+      while (std::getline(in, header)){
+         if (!header.empty() && header.back() == '\r'){ header.pop_back(); }
+         if (header.empty()){ break; }
+         if (strncasecmp(header.c_str(), "Content-Length:", 15) == 0){
+            length = strtoul(header.c_str() + 15, nullptr, 10);
+            sawLength = true;
+         }
+      }
+      if (!in){ break; }
+      if (!sawLength){ continue; }
+      std::string body(length, '\0');
+      if (!in.read(&body[0], length)){ break; }
+
+      bool ok;
+      JSONValue message = JSONValue::parse(body, ok);
+      replies.clear();
+      if (!ok){
+         replies.push_back(errorReply(JSONValue(), -32700, "parse error"));
+      } else {
+         handle(message, replies);
+      }
+      for (const JSONValue &reply : replies){
+         std::string text = reply.str();
+         out << "Content-Length: " << text.size() << "\r\n\r\n" << text;
+      }
+      out.flush();
+   }
+   return myShutdown ? 0 : 1;
+}
+
+int lspBenchmark(const char * filename, std::ostream &report)
+{
+   std::ifstream in(filename);
+   if (!in.good()){
+      report << "cannot open " << filename << "\n";
+      return 1;
+   }
+   std::string text((std::istreambuf_iterator<char>(in)),
+      std::istreambuf_iterator<char>());
+   const std::string uri = "file://bench.lilc";
+   LanguageServer server;
+   std::map<std::string, std::vector<double> > times;
+   std::vector<JSONValue> replies;
+
+   auto send = [&](const std::string &kind, const std::string &body){
+      auto start = std::chrono::steady_clock::now();
+      bool ok;
+      JSONValue message = JSONValue::parse(body, ok);
+      replies.clear();
+      server.handle(message, replies);
+      size_t bytes = 0;
+      for (const JSONValue &reply : replies){ bytes += reply.str().size(); }
+      auto end = std::chrono::steady_clock::now();
+      times[kind].push_back(
+         std::chrono::duration<double, std::milli>(end - start).count());
+      return bytes;
+   };
+
+   JSONValue open = JSONValue::object();
+   JSONValue openDoc = JSONValue::object();
+   openDoc.set("uri", uri);
+   openDoc.set("languageId", "lilc");
+   openDoc.set("version", 1);
+   openDoc.set("text", text);
+   JSONValue openParams = JSONValue::object();
+   openParams.set("textDocument", openDoc);
+   open.set("jsonrpc", "2.0");
+   open.set("method", "textDocument/didOpen");
+   open.set("params", openParams);
+   send("didOpen", open.str());
+
+   // Pick an identifier near the middle of the file for definition
+   // requests; edits go on the line just before it.
+   IncrementalDocument probe;
+   probe.setText(text);
+   size_t target = probe.lineCount() / 2;
+   size_t targetCol = 0;
+   for (; target < probe.lineCount(); target++){
+      const std::vector<Token> &toks = probe.line(target).tokens;
+      auto it = std::find_if(toks.begin(), toks.end(),
+         [](const Token &t){ return t.tag == TokenTag::ID; });
+      if (it != toks.end()){
+         targetCol = it->col;
+         break;
+      }
+   }
+   if (target == probe.lineCount()){ target = 0; }
+   std::string line = std::to_string(target);
+   std::string col = std::to_string(targetCol);
+   std::string docId = "{\"uri\":\"" + uri + "\"}";
+
+   const int rounds = 200;
+   for (int i = 0; i < rounds; i++){
+      std::string at = "{\"line\":" + line + ",\"character\":0}";
+      std::string after = "{\"line\":" + line + ",\"character\":1}";
+      send("didChange", "{\"jsonrpc\":\"2.0\",\"method\":\"textDocument/didChange\","
+         "\"params\":{\"textDocument\":" + docId + ",\"contentChanges\":"
+         "[{\"range\":{\"start\":" + at + ",\"end\":" + at + "},\"text\":\" \"}]}}");
+      send("didChange", "{\"jsonrpc\":\"2.0\",\"method\":\"textDocument/didChange\","
+         "\"params\":{\"textDocument\":" + docId + ",\"contentChanges\":"
+         "[{\"range\":{\"start\":" + at + ",\"end\":" + after + "},\"text\":\"\"}]}}");
+      send("definition", "{\"jsonrpc\":\"2.0\",\"id\":" + std::to_string(i)
+         + ",\"method\":\"textDocument/definition\",\"params\":{\"textDocument\":"
+         + docId + ",\"position\":{\"line\":" + line + ",\"character\":" + col + "}}}");
+      if (i % 20 == 0){
+         send("documentSymbol", "{\"jsonrpc\":\"2.0\",\"id\":" + std::to_string(i)
+            + ",\"method\":\"textDocument/documentSymbol\",\"params\":"
+            "{\"textDocument\":" + docId + "}}");
+      }
+   }
+
+   report << "lines: " << probe.lineCount() << ", declarations: "
+      << probe.decls().size() << "\n";
+   for (auto &entry : times){
+      std::vector<double> &t = entry.second;
+      std::sort(t.begin(), t.end());
+      report << entry.first << ": n=" << t.size()
+         << " median=" << t[t.size() / 2] << "ms"
+         << " p95=" << t[std::min(t.size() - 1, t.size() * 95 / 100)] << "ms"
+         << " max=" << t.back() << "ms\n";
+   }
+   return 0;
+}
+
+} /* end namespace */
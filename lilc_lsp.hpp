@@ -0,0 +1,55 @@
+#ifndef __LILC_LSP_HPP__
+#define __LILC_LSP_HPP__ 1
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <istream>
+#include <ostream>
+#include <unordered_map>
+
+#include "lilc_json.hpp"
+#include "lilc_incremental.hpp"
+
+namespace LILC{
+
+// A language server speaking JSON-RPC over stdio. Every open document is
+// an IncrementalDocument, so an edit only re-lexes the changed lines and
+// re-parses the enclosing top-level declarations. Supports diagnostics,
+// document symbols and go-to-definition. Positions on the wire are
+// UTF-16 based as the protocol requires; they are converted to byte
+// columns at the boundary.
+class LanguageServer{
+public:
+   // Serves Content-Length framed messages until "exit" or end of input.
+   // Returns the process exit status.
+   int run(std::istream &in, std::ostream &out);
+
+   // Handles one decoded message, appending any responses and
+   // notifications to replies.
+   void handle(const JSONValue &message, std::vector<JSONValue> &replies);
+
+   bool exited() const { return myExited; }
+
+private:
+   JSONValue initialize();
+   void publishDiagnostics(const std::string &uri,
+      std::vector<JSONValue> &replies);
+   JSONValue documentSymbols(const IncrementalDocument &doc);
+   JSONValue definition(const std::string &uri,
+      const IncrementalDocument &doc, const JSONValue &position);
+   JSONValue formatting(const IncrementalDocument &doc);
+   IncrementalDocument * document(const JSONValue &params);
+
+   std::unordered_map<std::string, std::unique_ptr<IncrementalDocument> >
+      myDocuments;
+   bool myShutdown = false;
+   bool myExited = false;
+};
+
+// Replays an editing session on the given file through
+// LanguageServer::handle and reports per-request latencies.
+int lspBenchmark(const char * filename, std::ostream &report);
+
+} /* end namespace */
+#endif /* END __LILC_LSP_HPP__ */
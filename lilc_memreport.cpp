@@ -0,0 +1,117 @@
+#include <iomanip>
+#include <list>
+
+#include "lilc_memreport.hpp"
+#include "grammar.hh"
+
+using TokenTag = LILC::LilC_Parser::token;
+
+namespace LILC{
+
+namespace {
+
+// A std::list element holding a pointer: two links and the pointer
+const size_t LIST_ELEMENT_BYTES = 3 * sizeof(void *);
+
+const char * const TOKEN_CLASS_NAMES[] = {
+   "NullaryToken", "IDToken", "IntLitToken", "StringLitToken"
+};
+
+void printRow(std::ostream &out, const char * name, size_t count,
+size_t objects, size_t lists, size_t strings)
+{
+   out << std::left << std::setw(18) << name << std::right
+      << std::setw(10) << count << std::setw(12) << objects
+      << std::setw(12) << lists << std::setw(12) << strings
+      << std::setw(12) << objects + lists + strings << "\n";
+}
+
+void printHeader(std::ostream &out, const char * what)
+{
+   out << std::left << std::setw(18) << what << std::right
+      << std::setw(10) << "count" << std::setw(12) << "objects"
+      << std::setw(12) << "lists" << std::setw(12) << "strings"
+      << std::setw(12) << "total" << "\n";
+}
+
+} /* end anonymous namespace */
+
+size_t MemoryReport::stringBytes(const std::string &str)
+{
+   static const size_t inlineCapacity = std::string().capacity();
+   return str.capacity() > inlineCapacity ? str.capacity() + 1 : 0;
+}
+
+void MemoryReport::node(NodeKind kind, size_t bytes)
+{
+   myNodes[kind].count++;
+   myNodes[kind].objects += bytes;
+}
+
+void MemoryReport::list(NodeKind kind, size_t elements)
+{
+   myNodes[kind].lists += elements * LIST_ELEMENT_BYTES;
+}
+
+void MemoryReport::string(NodeKind kind, const std::string &str)
+{
+   myNodes[kind].strings += stringBytes(str);
+}
+
+void MemoryReport::token(int tag, SynSymbol * token)
+{
+   Row * row;
+   if (tag == TokenTag::ID){
+      row = &myTokens[ID_TOKEN];
+      row->objects += sizeof(IDToken);
+      row->strings += stringBytes(((IDToken *)token)->value());
+   } else if (tag == TokenTag::INTLITERAL){
+      row = &myTokens[INT_LIT_TOKEN];
+      row->objects += sizeof(IntLitToken);
+   } else if (tag == TokenTag::STRINGLITERAL){
+      row = &myTokens[STRING_LIT_TOKEN];
+      row->objects += sizeof(StringLitToken);
+      row->strings += stringBytes(((StringLitToken *)token)->value());
+   } else {
+      row = &myTokens[NULLARY_TOKEN];
+      row->objects += sizeof(NullaryToken);
+   }
+   row->strings += stringBytes(token->name);
+   row->count++;
+}
+
+void MemoryReport::print(std::ostream &out) const
+{
+   Row nodes;
+   printHeader(out, "node");
+   for (int k = 0; k < NODE_KIND_COUNT; k++){
+      const Row &row = myNodes[k];
+      if (row.count == 0){ continue; }
+      printRow(out, nodeKindName((NodeKind)k), row.count, row.objects,
+         row.lists, row.strings);
+      nodes.count += row.count;
+      nodes.objects += row.objects;
+      nodes.lists += row.lists;
+      nodes.strings += row.strings;
+   }
+   printRow(out, "all nodes", nodes.count, nodes.objects, nodes.lists,
+      nodes.strings);
+
+   Row tokens;
+   out << "\n";
+   printHeader(out, "token");
+   for (int c = 0; c < TOKEN_CLASS_COUNT; c++){
+      const Row &row = myTokens[c];
+      printRow(out, TOKEN_CLASS_NAMES[c], row.count, row.objects, row.lists,
+         row.strings);
+      tokens.count += row.count;
+      tokens.objects += row.objects;
+      tokens.strings += row.strings;
+   }
+   printRow(out, "all tokens", tokens.count, tokens.objects, tokens.lists,
+      tokens.strings);
+
+   out << "\ntotal: " << nodes.total() + tokens.total() << " bytes\n";
+}
+
+} /* end namespace */
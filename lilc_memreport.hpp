@@ -0,0 +1,50 @@
+#ifndef __LILC_MEMREPORT_HPP__
+#define __LILC_MEMREPORT_HPP__ 1
+
+#include <string>
+#include <ostream>
+#include <cstddef>
+
+#include "ast.hpp"
+#include "symbols.hpp"
+
+namespace LILC{
+
+// Where the heap goes for one input (--mem-report). Each node kind gets
+// its count, the size of its objects, of the std::list elements it owns
+// and of the string storage it owns; tokens are tallied by class the same
+// way. A node counts as sizeof its class, a list element as its two links
+// plus the pointer it holds, and a string only once it has outgrown its
+// inline buffer. malloc headers and rounding are not included.
+class MemoryReport{
+public:
+   // Called by the nodes' measure methods.
+   void node(NodeKind kind, size_t bytes);
+   void list(NodeKind kind, size_t elements);
+   void string(NodeKind kind, const std::string &str);
+
+   // A token as produced by the scanner, with the tag it returned.
+   void token(int tag, SynSymbol * token);
+
+   void print(std::ostream &out) const;
+   size_t count(NodeKind kind) const { return myNodes[kind].count; }
+
+   // Heap bytes behind a string's characters, 0 while they fit inline.
+   static size_t stringBytes(const std::string &str);
+private:
+   struct Row{
+      size_t count = 0;
+      size_t objects = 0;
+      size_t lists = 0;
+      size_t strings = 0;
+      size_t total() const { return objects + lists + strings; }
+   };
+   enum TokenClass{ NULLARY_TOKEN, ID_TOKEN, INT_LIT_TOKEN, STRING_LIT_TOKEN,
+      TOKEN_CLASS_COUNT };
+
+   Row myNodes[NODE_KIND_COUNT];
+   Row myTokens[TOKEN_CLASS_COUNT];
+};
+
+} /* end namespace */
+#endif /* END __LILC_MEMREPORT_HPP__ */
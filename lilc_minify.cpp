@@ -0,0 +1,172 @@
+#include <cctype>
+#include <cstring>
+
+#include "lilc_minify.hpp"
+
+namespace LILC{
+
+namespace {
+
+const char * const KEYWORDS[] = {
+   "bool", "void", "int", "true", "false", "struct", "cin", "cout", "if",
+   "else", "while", "return"
+};
+
+// Two-character tokens (and comment openers) that adjacent single
+// characters of two different tokens must not be allowed to form.
+const char * const JOINS[] = {
+   "++", "--", "<<", ">>", "<=", ">=", "==", "!=", "&&", "||", "//", "/*"
+};
+
+bool isWordChar(char c)
+{
+   return isalnum((unsigned char)c) || c == '_';
+}
+
+bool needsSpace(char last, char next)
+{
+   if (isWordChar(last)){
+      return isWordChar(next);
+   }
+   if (strchr("+-<>=!&|/", last) == nullptr){
+      return false;
+   }
+   for (const char * join : JOINS){
+      if (join[0] == last && join[1] == next){ return true; }
+   }
+   return false;
+}
+
+} /* end anonymous namespace */
+
+Minifier::Minifier(std::ostream &out, bool renameLocals)
+: myOut(out), myRename(renameLocals)
+{
+   myBuf.reserve(BUFFER_SIZE);
+   for (const char * keyword : KEYWORDS){
+      myReserved.insert(keyword);
+   }
+}
+
+Minifier::~Minifier()
+{
+   flush();
+}
+
+void Minifier::minifyProgram(ProgramNode * root)
+{
+   // Globals keep their names, so locals must not be renamed onto them.
+   for (DeclNode * decl : *root->getDeclList()->getDecls()){
+      if (VarDeclNode * var = dynamic_cast<VarDeclNode *>(decl)){
+         myReserved.insert(var->getId()->getName());
+      } else if (FnDeclNode * fn = dynamic_cast<FnDeclNode *>(decl)){
+         myReserved.insert(fn->getId()->getName());
+      } else if (StructDeclNode * st = dynamic_cast<StructDeclNode *>(decl)){
+         myReserved.insert(st->getId()->getName());
+      }
+   }
+   if (myRename){
+      // A dry run first, to also reserve every name a function uses
+      // without declaring it locally.
+      myCollecting = true;
+      root->minify(*this);
+      myCollecting = false;
+   }
+   root->minify(*this);
+   append("\n", 1);
+   flush();
+}
+
+void Minifier::flush()
+{
+   myOut.write(myBuf.data(), myBuf.size());
+   myBuf.clear();
+}
+
+void Minifier::append(const char * text, size_t len)
+{
+   if (len == 0 || myCollecting){ return; }
+   if (needsSpace(myLast, text[0])){
+      myBuf += ' ';
+   }
+   myBuf.append(text, len);
+   myLast = text[len - 1];
+   if (myBuf.size() >= BUFFER_SIZE){ flush(); }
+}
+
+void Minifier::word(const std::string &text)
+{
+   append(text.data(), text.size());
+}
+
+void Minifier::punct(const char * text)
+{
+   append(text, strlen(text));
+}
+
+void Minifier::operand(NodeKind parent, ExpNode * child, bool rightOperand)
+{
+   bool parens = needsParens(parent, child->kind(), rightOperand);
+   if (parens){ punct("("); }
+   child->minify(*this);
+   if (parens){ punct(")"); }
+}
+
+const std::string & Minifier::use(const std::string &id)
+{
+   for (size_t i = myScopes.size(); i-- > 0; ){
+      auto found = myScopes[i].find(id);
+      if (found != myScopes[i].end()){
+         return found->second;
+      }
+   }
+   if (myCollecting){
+      myReserved.insert(id);
+   }
+   return id;
+}
+
+const std::string & Minifier::declare(const std::string &id)
+{
+   if (!myRename || myInStruct || myScopes.empty()){
+      return id;
+   }
+   std::string &name = myScopes.back()[id];
+   name = myCollecting ? id : nextName();
+   return name;
+}
+
+void Minifier::beginFunction()
+{
+   myNextName = 0;
+   beginScope();
+}
+
+void Minifier::endFunction()
+{
+   endScope();
+}
+
+// Enumerates a, b, ..., _, aa, ba, ... skipping reserved names.
+std::string Minifier::nextName()
+{
+   static const char FIRST[] =
+      "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ_";
+   static const char REST[] =
+      "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ_0123456789";
+   while (true){
+      size_t n = myNextName++;
+      std::string name(1, FIRST[n % (sizeof(FIRST) - 1)]);
+      n /= sizeof(FIRST) - 1;
+      while (n > 0){
+         n--;
+         name += REST[n % (sizeof(REST) - 1)];
+         n /= sizeof(REST) - 1;
+      }
+      if (myReserved.count(name) == 0){
+         return name;
+      }
+   }
+}
+
+} /* end namespace */
@@ -0,0 +1,63 @@
+#ifndef __LILC_MINIFY_HPP__
+#define __LILC_MINIFY_HPP__ 1
+
+#include <string>
+#include <vector>
+#include <ostream>
+#include <unordered_map>
+#include <unordered_set>
+
+#include "ast.hpp"
+
+namespace LILC{
+
+// Writes a program in as few bytes as will parse back into the same
+// tree: a space only where two tokens would otherwise run together, and
+// parentheses only where needsParens() asks for them. With renameLocals,
+// formals and local variables get the shortest names that collide with
+// no keyword, global, or name used without a local declaration. Each name
+// within a function is used only once, so inner scopes never shadow outer
+// ones. Struct fields and globals keep their names.
+class Minifier{
+public:
+   Minifier(std::ostream &out, bool renameLocals);
+   ~Minifier();
+
+   void minifyProgram(ProgramNode * root);
+
+   // Emitters used by the nodes' minify methods.
+   void word(const std::string &text);
+   void punct(const char * text);
+   void operand(NodeKind parent, ExpNode * child, bool rightOperand);
+
+   // Name to emit for a use of id, and for a declaration of it.
+   const std::string & use(const std::string &id);
+   const std::string & declare(const std::string &id);
+
+   void beginFunction();
+   void endFunction();
+   void beginScope(){ myScopes.emplace_back(); }
+   void endScope(){ myScopes.pop_back(); }
+   void beginStruct(){ myInStruct = true; }
+   void endStruct(){ myInStruct = false; }
+
+   void flush();
+private:
+   void append(const char * text, size_t len);
+   std::string nextName();
+
+   static const size_t BUFFER_SIZE = 1 << 16;
+
+   std::ostream &myOut;
+   std::string myBuf;
+   char myLast = '\n';
+   bool myRename;
+   bool myInStruct = false;
+   bool myCollecting = false;
+   size_t myNextName = 0;
+   std::unordered_set<std::string> myReserved;
+   std::vector<std::unordered_map<std::string, std::string> > myScopes;
+};
+
+} /* end namespace */
+#endif /* END __LILC_MINIFY_HPP__ */
@@ -0,0 +1,68 @@
+#ifndef __LILC_PROBES_HPP__
+#define __LILC_PROBES_HPP__ 1
+
+// Static tracepoints (USDT) for tracing P3 in production with bpftrace,
+// perf or SystemTap, without rebuilding it. Each probe compiles to a
+// single NOP plus a note in the ELF .note.stapsdt section saying where
+// its arguments are; a tracer attaching replaces the NOP with a trap,
+// and detaching puts it back. The arguments are values already at hand
+// (registers, or a pointer to a name), so an unattached probe costs the
+// NOP alone.
+//
+// Provider lilc. The names are as tracers show them: <sys/sdt.h> keeps
+// them verbatim (only dtrace(1)-generated headers turn "__" into "-"),
+// so they are single words or joined with "_". Offsets and lengths are
+// in bytes of the (decompressed) input text:
+//
+//   token(int tag, size_t offset, size_t length)
+//      a token handed to the parser; tag is a LilC_Parser::token value
+//      (END at the end of input). Fires in token-array mode too.
+//   decl(int kind, size_t offset, size_t length)
+//      a top-level declaration reduced by the parser; kind is the
+//      NodeKind of ast.hpp (VAR_DECL_NODE, FN_DECL_NODE or
+//      STRUCT_DECL_NODE)
+//   unparse_fn_start(const char * name, size_t offset, int sizing)
+//   unparse_fn_end(const char * name, size_t offset, int sizing)
+//      around the rendering of one function declaration's text. sizing
+//      is 1 for the pass that only counts the output's bytes (see
+//      lilc_unparse.hpp), which precedes the one that writes them; text
+//      reused from a declaration's cache is not rendered and fires
+//      neither.
+//   file_open(const char * path, size_t bytes)
+//   file_close(const char * path)
+//      an input file mapped (or read) by LilC_Compiler, and released;
+//      bytes is its size on disk, compressed or not
+//
+// For example, tokens per kind, and the time spent unparsing each
+// function:
+//
+//   bpftrace -e 'usdt:./P3:lilc:token { @[arg0] = count(); }' -c ...
+//   bpftrace -e 'usdt:./P3:lilc:unparse_fn_start /arg2 == 0/ {
+//         @start[tid] = nsecs; }
+//      usdt:./P3:lilc:unparse_fn_end /@start[tid]/ {
+//         @ns[str(arg0)] = sum(nsecs - @start[tid]); delete(@start[tid]); }'
+//
+// and `perf list sdt_lilc:*` after `perf buildid-cache --add ./P3`.
+//
+// The probes need <sys/sdt.h> (systemtap-sdt-dev or systemtap-sdt-devel)
+// when P3 is built; without it, or with -DLILC_NO_PROBES, they compile
+// to nothing.
+
+#if !defined(LILC_NO_PROBES) && defined(__has_include)
+#if __has_include(<sys/sdt.h>)
+#include <sys/sdt.h>
+#define LILC_PROBES 1
+#endif
+#endif
+
+#if defined(LILC_PROBES)
+#define LILC_PROBE1(name, a) DTRACE_PROBE1(lilc, name, a)
+#define LILC_PROBE2(name, a, b) DTRACE_PROBE2(lilc, name, a, b)
+#define LILC_PROBE3(name, a, b, c) DTRACE_PROBE3(lilc, name, a, b, c)
+#else
+#define LILC_PROBE1(name, a) do { } while (0)
+#define LILC_PROBE2(name, a, b) do { } while (0)
+#define LILC_PROBE3(name, a, b, c) do { } while (0)
+#endif
+
+#endif /* END __LILC_PROBES_HPP__ */
@@ -0,0 +1,118 @@
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <iomanip>
+#include <algorithm>
+
+#include "lilc_profile.hpp"
+
+namespace LILC{
+
+Profile * Profile::theActive = nullptr;
+
+void Profile::enable(const char * filename)
+{
+   if (theActive != nullptr){
+      theActive->myFilename = filename;
+      return;
+   }
+   theActive = new Profile();
+   theActive->myFilename = filename;
+   atexit(writeAtExit);
+}
+
+void Profile::writeAtExit()
+{
+   std::ofstream out(theActive->myFilename);
+   if (!out){
+      std::cerr << "Could not write profile " << theActive->myFilename
+         << "\n";
+      return;
+   }
+   theActive->print(out);
+}
+
+void Profile::count(std::vector<Counter> &counters, int index, int line,
+const char * name)
+{
+   if ((size_t)index >= counters.size()){
+      counters.resize(index + 1);
+   }
+   Counter &counter = counters[index];
+   counter.line = line;
+   counter.name = name;
+   counter.count++;
+}
+
+void Profile::lexRule(int rule, int line)
+{
+   count(myLexRules, rule, line, nullptr);
+}
+
+void Profile::reduction(int rule, int line, const char * lhs)
+{
+   count(myReductions, rule, line, lhs);
+}
+
+void Profile::printCounters(std::ostream &out, const char * title,
+const char * file, const std::vector<Counter> &counters)
+{
+   std::vector<Counter> used;
+   size_t total = 0;
+   for (const Counter &counter : counters){
+      if (counter.count == 0){ continue; }
+      used.push_back(counter);
+      total += counter.count;
+   }
+   std::stable_sort(used.begin(), used.end(),
+      [](const Counter &a, const Counter &b){ return a.count > b.count; });
+   out << title << " (" << total << ")\n";
+   for (const Counter &counter : used){
+      out << "  " << file << ":" << std::left << std::setw(6)
+         << counter.line << std::right << std::setw(12) << counter.count
+         << std::setw(8) << std::fixed << std::setprecision(2)
+         << 100.0 * counter.count / total << "%";
+      if (counter.name != nullptr){
+         out << "  " << counter.name;
+      }
+      out << "\n";
+   }
+}
+
+void Profile::printHistogram(std::ostream &out, const char * title,
+const std::vector<size_t> &histogram)
+{
+   size_t total = 0;
+   size_t sum = 0;
+   for (size_t len = 0; len < histogram.size(); len++){
+      total += histogram[len];
+      sum += len * histogram[len];
+   }
+   out << title << " (" << total << ")";
+   if (total > 0){
+      out << ", mean " << std::fixed << std::setprecision(2)
+         << (double)sum / total;
+   }
+   out << "\n";
+   for (size_t len = 0; len < histogram.size(); len++){
+      if (histogram[len] == 0){ continue; }
+      out << "  " << std::setw(3) << len << (len == LONGEST ? "+" : " ")
+         << std::setw(12) << histogram[len] << "\n";
+   }
+}
+
+void Profile::print(std::ostream &out) const
+{
+   printCounters(out, "flex rule matches", "lilc.l", myLexRules);
+   out << "\n";
+   printCounters(out, "grammar reductions", "lilc.yy", myReductions);
+   out << "\n";
+   printHistogram(out, "identifier lengths", myIdLengths);
+   out << "\n";
+   printHistogram(out, "integer literal digits", myIntDigits);
+   out << "\n";
+   printHistogram(out, "string literal lengths (with quotes)",
+      myStringLengths);
+}
+
+} /* end namespace */
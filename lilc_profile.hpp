@@ -0,0 +1,61 @@
+#ifndef __LILC_PROFILE_HPP__
+#define __LILC_PROFILE_HPP__ 1
+
+#include <string>
+#include <vector>
+#include <ostream>
+#include <cstddef>
+
+namespace LILC{
+
+// Opt-in counters for tuning the scanner and the grammar (--profile):
+// matches per flex rule in lilc.l, reductions per production in lilc.yy,
+// and histograms of identifier lengths and literal sizes. Rules are
+// named by their line in lilc.l or lilc.yy. While no profile is enabled
+// each hook costs one pointer test. The report is written at exit.
+class Profile{
+public:
+   static Profile * active(){ return theActive; }
+   // Starts counting for the rest of the run; the report goes to
+   // filename when the program exits.
+   static void enable(const char * filename);
+
+   void lexRule(int rule, int line);
+   void reduction(int rule, int line, const char * lhs);
+   void identifier(size_t length){ bucket(myIdLengths, length); }
+   void intLiteral(size_t digits){ bucket(myIntDigits, digits); }
+   void stringLiteral(size_t length){ bucket(myStringLengths, length); }
+
+   void print(std::ostream &out) const;
+private:
+   struct Counter{
+      int line = 0;
+      const char * name = nullptr;
+      size_t count = 0;
+   };
+   // Lengths from LONGEST on share the last bucket
+   static const size_t LONGEST = 64;
+
+   static void count(std::vector<Counter> &counters, int index, int line,
+      const char * name);
+   static void bucket(std::vector<size_t> &histogram, size_t length){
+      histogram[length < LONGEST ? length : LONGEST]++;
+   }
+   static void printCounters(std::ostream &out, const char * title,
+      const char * file, const std::vector<Counter> &counters);
+   static void printHistogram(std::ostream &out, const char * title,
+      const std::vector<size_t> &histogram);
+   static void writeAtExit();
+
+   static Profile * theActive;
+
+   std::string myFilename;
+   std::vector<Counter> myLexRules;
+   std::vector<Counter> myReductions;
+   std::vector<size_t> myIdLengths = std::vector<size_t>(LONGEST + 1);
+   std::vector<size_t> myIntDigits = std::vector<size_t>(LONGEST + 1);
+   std::vector<size_t> myStringLengths = std::vector<size_t>(LONGEST + 1);
+};
+
+} /* end namespace */
+#endif /* END __LILC_PROFILE_HPP__ */
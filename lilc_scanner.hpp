@@ -6,13 +6,18 @@
 #endif
 
 #include "grammar.hh"
+#include "lilc_diagnostics.hpp"
+#include "lilc_source.hpp"
+#include "lilc_probes.hpp"
 
 namespace LILC{
 
 class LilC_Scanner : public yyFlexLexer{
 public:
    
-   LilC_Scanner(std::istream *in) : yyFlexLexer(in)
+   LilC_Scanner(std::istream *in, Diagnostics * diagnostics,
+      const LineIndex * lines = nullptr)
+   : yyFlexLexer(in), diagnostics(diagnostics), lines(lines)
    {
    };
    virtual ~LilC_Scanner() {
@@ -25,26 +30,75 @@ public:
    virtual
    int yylex( LILC::LilC_Parser::semantic_type * const lval);
 
-   void warn(int lineNum, int charNum, std::string msg){
-	std::cerr << lineNum << ":" << charNum << " ***WARNING*** " << msg << std::endl;
+   // The parser's entry point: the next token, and in span the bytes it
+   // covers (an empty span at the end of input).
+   int yylex( LILC::LilC_Parser::semantic_type * const lval,
+      LILC::LilC_Parser::location_type * const span){
+	int tag = yylex(lval);
+	*span = tokenSpan(tag);
+	LILC_PROBE3(token, tag, (size_t)span->offset, (size_t)span->length);
+	return tag;
+   }
+
+   void warn(std::string msg){
+	Position pos = position();
+	diagnostics->warn(pos.line, pos.col, msg);
+   }
+
+   void error(std::string msg){
+	Position pos = position();
+	diagnostics->error(pos.line, pos.col, msg);
+   }
+
+   // Reports msg and then detail, which a run of adjacent reports of the
+   // same msg may differ in and still merge into one entry
+   void error(const std::string &msg, const std::string &detail){
+	Position pos = position();
+	diagnostics->report(Diagnostics::ERROR, pos.line, pos.col,
+		msg + " " + detail, msg.size());
+   }
+
+   // Byte offset and length of the most recently matched token
+   size_t tokenOffset() const { return tokenStart; }
+   size_t tokenLength() const { return offset - tokenStart; }
+
+   virtual Span tokenSpan(int tag) const {
+	if (tag == LILC::LilC_Parser::token::END){
+		return makeSpan(offset, 0);
+	}
+	return makeSpan(tokenStart, offset - tokenStart);
+   }
+
+   // Line and column of the most recently matched token
+   virtual Position position() const {
+	Position pos = lines != nullptr ? lines->position(tokenStart)
+		: Position{1, tokenStart + 1};
+	pos.line += firstLine - 1;
+	return pos;
    }
 
-   void error(int lineNum, int charNum, std::string msg){
-	std::cerr << lineNum << ":" << charNum << " ***ERROR*** " << msg << std::endl;
+   // The scanner only tracks byte offsets; lines resolves them to
+   // positions, numbered from firstLine when the input is a slice of a
+   // larger buffer.
+   void setLineIndex(const LineIndex * lines, size_t firstLine = 1){
+	this->lines = lines;
+	this->firstLine = firstLine;
    }
 
    int produceNullaryToken(int tag){
-	this->yylval->symbolValue = new NullaryToken(lineNum, charNum, tag);
-	charNum += yyleng;
+	this->yylval->symbolValue = new NullaryToken(tokenStart, tag);
 	return tag;
    }
 
 
-private:
+protected:
    /* yyval ptr */
    LILC::LilC_Parser::semantic_type *yylval = nullptr;
-   size_t lineNum;
-   size_t charNum;
+   Diagnostics * diagnostics;
+   const LineIndex * lines;
+   size_t firstLine = 1;
+   size_t offset = 0;
+   size_t tokenStart = 0;
 };
 
 } /* end namespace */
@@ -0,0 +1,374 @@
+#include <map>
+#include <memory>
+#include <string>
+#include <cerrno>
+#include <cstdio>
+#include <csignal>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <algorithm>
+#include <unordered_map>
+#include <vector>
+#include <elf.h>
+#include <link.h>
+#include <dlfcn.h>
+#include <cxxabi.h>
+#include <unistd.h>
+#include <execinfo.h>
+#include <sys/mman.h>
+#include <sys/time.h>
+
+#include "lilc_selfprofile.hpp"
+#include "lilc_source.hpp"
+
+namespace LILC{
+
+std::atomic<const char *> SelfProfiler::thePhase(nullptr);
+std::atomic<const char *> SelfProfiler::theInput(nullptr);
+std::atomic<size_t> SelfProfiler::theOffset(SelfProfiler::NO_OFFSET);
+
+namespace {
+
+// Deeper stacks keep their innermost frames
+const int MAX_DEPTH = 128;
+// The handler's own frame and the signal trampoline's
+const int SKIPPED = 2;
+// A sample is its phase, input, offset and depth, then its frames from
+// the innermost out
+const size_t HEADER = 4;
+// 64 MB of address space, of which only the pages used are committed:
+// minutes of samples at the default rate
+const size_t WORDS = size_t(1) << 23;
+
+std::string theFilename;
+int theRate = 1000;
+pid_t theOwner = 0;
+uintptr_t * theWords = nullptr;
+// Written by the handler only, read once the timer is stopped
+size_t theUsed = 0;
+size_t theDropped = 0;
+
+void setTimer(int hz)
+{
+   struct itimerval timer;
+   timer.it_interval.tv_sec = 0;
+   timer.it_interval.tv_usec = hz > 0 ? std::max(1, 1000000 / hz) : 0;
+   timer.it_value = timer.it_interval;
+   setitimer(ITIMER_PROF, &timer, nullptr);
+}
+
+struct Symbol{
+   uintptr_t start;
+   uintptr_t size;
+   const char * name;
+};
+
+// Function symbols of the running executable, from the .symtab of
+// /proc/self/exe; empty if it has been stripped.
+class ExecutableSymbols{
+public:
+   ExecutableSymbols(){
+      std::ifstream in("/proc/self/exe", std::ios::binary);
+      myImage.assign(std::istreambuf_iterator<char>(in),
+         std::istreambuf_iterator<char>());
+      dl_iterate_phdr(findBias, &myBias);
+      readSymbols();
+   }
+
+   // The name of the function containing addr, or null
+   const char * find(uintptr_t addr) const {
+      addr -= myBias;
+      auto it = std::upper_bound(mySymbols.begin(), mySymbols.end(), addr,
+         [](uintptr_t a, const Symbol &s){ return a < s.start; });
+      if (it == mySymbols.begin()){
+         return nullptr;
+      }
+      --it;
+      return addr < it->start + it->size ? it->name : nullptr;
+   }
+private:
+   // The executable is the first object reported
+   static int findBias(struct dl_phdr_info * info, size_t, void * data){
+      *(uintptr_t *)data = info->dlpi_addr;
+      return 1;
+   }
+
+   void readSymbols(){
+      const char * image = myImage.data();
+      if (myImage.size() < sizeof(Elf64_Ehdr)
+         || memcmp(image, ELFMAG, SELFMAG) != 0
+         || image[EI_CLASS] != ELFCLASS64){
+         return;
+      }
+      const Elf64_Ehdr * header = (const Elf64_Ehdr *)image;
+      if (header->e_shoff == 0 || header->e_shoff
+         + header->e_shnum * sizeof(Elf64_Shdr) > myImage.size()){
+         return;
+      }
+      const Elf64_Shdr * sections = (const Elf64_Shdr *)(image
+         + header->e_shoff);
+      for (int i = 0; i < header->e_shnum; i++){
+         const Elf64_Shdr &symtab = sections[i];
+         if (symtab.sh_type != SHT_SYMTAB || symtab.sh_link
+            >= header->e_shnum){
+            continue;
+         }
+         const Elf64_Shdr &strtab = sections[symtab.sh_link];
+         if (symtab.sh_offset + symtab.sh_size > myImage.size()
+            || strtab.sh_offset + strtab.sh_size > myImage.size()){
+            continue;
+         }
+         const Elf64_Sym * syms = (const Elf64_Sym *)(image
+            + symtab.sh_offset);
+         size_t count = symtab.sh_size / sizeof(Elf64_Sym);
+         for (size_t s = 0; s < count; s++){
+            if (ELF64_ST_TYPE(syms[s].st_info) == STT_FUNC
+               && syms[s].st_value != 0 && syms[s].st_size != 0
+               && syms[s].st_name < strtab.sh_size){
+               mySymbols.push_back(Symbol{ syms[s].st_value,
+                  syms[s].st_size,
+                  image + strtab.sh_offset + syms[s].st_name });
+            }
+         }
+      }
+      std::sort(mySymbols.begin(), mySymbols.end(),
+         [](const Symbol &a, const Symbol &b){ return a.start < b.start; });
+   }
+
+   std::vector<char> myImage;
+   uintptr_t myBias = 0;
+   std::vector<Symbol> mySymbols;
+};
+
+std::string demangle(const char * name)
+{
+   int status = 0;
+   char * plain = abi::__cxa_demangle(name, nullptr, nullptr, &status);
+   if (status != 0){
+      return name;
+   }
+   std::string result(plain);
+   free(plain);
+   return result;
+}
+
+// Frame names, cached since a hot function is in most samples
+class Symbolizer{
+public:
+   const std::string & name(uintptr_t addr){
+      auto found = myNames.find(addr);
+      if (found != myNames.end()){
+         return found->second;
+      }
+      std::string &name = myNames[addr];
+      Dl_info info;
+      bool shared = false;
+      if (const char * symbol = myExecutable.find(addr)){
+         name = demangle(symbol);
+      } else if ((shared = dladdr((void *)addr, &info) != 0)
+         && info.dli_sname != nullptr){
+         name = demangle(info.dli_sname);
+      } else if (shared && info.dli_fname != nullptr){
+         const char * base = strrchr(info.dli_fname, '/');
+         name = base != nullptr ? base + 1 : info.dli_fname;
+      } else {
+         char hex[2 + 2 * sizeof(uintptr_t) + 1];
+         snprintf(hex, sizeof(hex), "0x%lx", (unsigned long)addr);
+         name = hex;
+      }
+      // Separators of the folded format
+      std::replace(name.begin(), name.end(), ';', ':');
+      std::replace(name.begin(), name.end(), '\n', ' ');
+      return name;
+   }
+private:
+   ExecutableSymbols myExecutable;
+   std::unordered_map<uintptr_t, std::string> myNames;
+};
+
+// Lines of the inputs samples were taken in, read again at exit
+class InputLines{
+public:
+   // 1-based line of offset in filename, or 0 if it cannot be read
+   size_t line(const char * filename, size_t offset){
+      auto found = mySources.find(filename);
+      if (found == mySources.end()){
+         std::unique_ptr<MappedSource> &source = mySources[filename];
+         source.reset(new MappedSource());
+         if (!source->open(filename)){
+            source.reset();
+         } else {
+            // Compressed sources index their lines as they are read
+            std::istream in(source->streamBuf());
+            char buffer[1 << 16];
+            while (in.read(buffer, sizeof(buffer)) || in.gcount() > 0){ }
+         }
+         found = mySources.find(filename);
+      }
+      if (found->second == nullptr){
+         return 0;
+      }
+      return found->second->position(offset).line;
+   }
+private:
+   std::map<std::string, std::unique_ptr<MappedSource> > mySources;
+};
+
+void writeFolded(const char * filename,
+const std::map<std::string, size_t> &stacks)
+{
+   std::ofstream out(filename);
+   if (!out){
+      std::cerr << "Could not write profile " << filename << "\n";
+      return;
+   }
+   for (const auto &stack : stacks){
+      out << stack.first << " " << stack.second << "\n";
+   }
+}
+
+} // end anonymous namespace
+
+void SelfProfiler::enable(const char * filename)
+{
+   bool started = theWords != nullptr;
+   theFilename = filename;
+   if (started){
+      return;
+   }
+   void * words = mmap(nullptr, WORDS * sizeof(uintptr_t),
+      PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE,
+      -1, 0);
+   if (words == MAP_FAILED){
+      std::cerr << "Could not allocate the self-profile's samples\n";
+      exit(EXIT_FAILURE);
+   }
+   theWords = (uintptr_t *)words;
+   theOwner = getpid();
+   atexit(writeAtExit);
+   start();
+}
+
+void SelfProfiler::setRate(int hz)
+{
+   theRate = std::max(1, hz);
+   if (theWords != nullptr){
+      setTimer(theRate);
+   }
+}
+
+void SelfProfiler::start()
+{
+   // The first backtrace() loads the unwinder, which must not happen in
+   // the handler
+   void * warm[1];
+   backtrace(warm, 1);
+   struct sigaction action;
+   memset(&action, 0, sizeof(action));
+   action.sa_handler = handler;
+   action.sa_flags = SA_RESTART;
+   sigemptyset(&action.sa_mask);
+   sigaction(SIGPROF, &action, nullptr);
+   setTimer(theRate);
+}
+
+void SelfProfiler::handler(int)
+{
+   int savedErrno = errno;
+   if (theUsed + HEADER + MAX_DEPTH > WORDS){
+      theDropped++;
+      errno = savedErrno;
+      return;
+   }
+   void * frames[SKIPPED + MAX_DEPTH];
+   int depth = backtrace(frames, SKIPPED + MAX_DEPTH) - SKIPPED;
+   if (depth < 0){
+      depth = 0;
+   }
+   uintptr_t * sample = theWords + theUsed;
+   sample[0] = (uintptr_t)thePhase.load(std::memory_order_relaxed);
+   sample[1] = (uintptr_t)theInput.load(std::memory_order_relaxed);
+   sample[2] = theOffset.load(std::memory_order_relaxed);
+   sample[3] = depth;
+   for (int i = 0; i < depth; i++){
+      sample[HEADER + i] = (uintptr_t)frames[SKIPPED + i];
+   }
+   theUsed += HEADER + depth;
+   errno = savedErrno;
+}
+
+SelfProfiler::Phase::Phase(const char * name, const char * input)
+   : myOuterName(thePhase.load(std::memory_order_relaxed)),
+     myOuterInput(theInput.load(std::memory_order_relaxed)),
+     myOuterOffset(theOffset.load(std::memory_order_relaxed))
+{
+   if (input != nullptr){
+      theInput.store(input, std::memory_order_relaxed);
+   }
+   theOffset.store(NO_OFFSET, std::memory_order_relaxed);
+   thePhase.store(name, std::memory_order_relaxed);
+}
+
+SelfProfiler::Phase::~Phase()
+{
+   thePhase.store(myOuterName, std::memory_order_relaxed);
+   theInput.store(myOuterInput, std::memory_order_relaxed);
+   theOffset.store(myOuterOffset, std::memory_order_relaxed);
+}
+
+void SelfProfiler::writeAtExit()
+{
+   // Children forked after enable() exit without their own samples
+   if (getpid() != theOwner){
+      return;
+   }
+   setTimer(0);
+   signal(SIGPROF, SIG_IGN);
+
+   Symbolizer symbols;
+   InputLines lines;
+   std::map<std::string, size_t> stacks;
+   std::map<std::string, size_t> inputs;
+   size_t samples = 0;
+   for (size_t at = 0; at < theUsed; samples++){
+      const uintptr_t * sample = theWords + at;
+      const char * phase = (const char *)sample[0];
+      const char * input = (const char *)sample[1];
+      size_t offset = sample[2];
+      size_t depth = sample[3];
+      at += HEADER + depth;
+
+      std::string key = phase != nullptr ? phase : "other";
+      std::string inputKey = key;
+      // Outermost first. Return addresses point after their call, which
+      // may be the start of the next function; the innermost frame is
+      // the interrupted instruction itself.
+      for (size_t i = depth; i-- > 0; ){
+         uintptr_t addr = sample[HEADER + i];
+         key += ';';
+         key += symbols.name(i == 0 ? addr : addr - 1);
+      }
+      stacks[key]++;
+
+      if (input != nullptr && offset != NO_OFFSET){
+         size_t line = lines.line(input, offset);
+         inputKey += ';';
+         inputKey += input;
+         if (line != 0){
+            inputKey += ";line " + std::to_string(line);
+         }
+      }
+      inputs[inputKey]++;
+   }
+   writeFolded(theFilename.c_str(), stacks);
+   writeFolded((theFilename + ".input").c_str(), inputs);
+   if (theDropped > 0){
+      std::cerr << "Self-profile: " << theDropped << " of "
+         << samples + theDropped << " samples dropped, the buffer was full\n";
+   }
+}
+
+} /* end namespace */
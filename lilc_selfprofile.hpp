@@ -0,0 +1,67 @@
+#ifndef __LILC_SELFPROFILE_HPP__
+#define __LILC_SELFPROFILE_HPP__ 1
+
+#include <atomic>
+#include <string>
+#include <cstddef>
+#include <cstdint>
+
+namespace LILC{
+
+// Sampling profiler for P3 itself (--self-profile). SIGPROF interrupts
+// the process every 1/rate seconds of CPU time, and the handler records
+// the call stack together with the phase P3 is in (parse, unparse, run,
+// ...) and the input offset that phase has reached: the parser notes the
+// offset of each reduction, and unparsing that of each declaration and
+// statement it writes. At exit the samples are written as folded stacks,
+// one "phase;outer;...;inner count" line per distinct stack, which
+// flamegraph.pl, speedscope and inferno read as they are. A second
+// folded file, FILE.input, has "phase;file;line N count" lines instead,
+// to show which parts of the input the time went to; a single giant
+// expression shows up there as one wide line.
+//
+// Frames are named from the executable's own symbol table and, for
+// shared libraries, with dladdr(), so no -rdynamic is needed. Sharded
+// workers are not sampled: a forked child does not inherit the timer.
+// The kernel samples CPU time at its tick, which caps the useful rate.
+class SelfProfiler{
+public:
+   // Starts sampling for the rest of the run; the folded stacks go to
+   // filename when the program exits.
+   static void enable(const char * filename);
+   // Samples per second of CPU time, 1000 unless set; may be set before
+   // or after enable().
+   static void setRate(int hz);
+
+   // Tags the samples taken during its lifetime with a phase and the
+   // input file being read, if any. Phases nest; the innermost wins.
+   class Phase{
+   public:
+      Phase(const char * name, const char * input = nullptr);
+      ~Phase();
+      Phase(const Phase &) = delete;
+      Phase & operator=(const Phase &) = delete;
+   private:
+      const char * myOuterName;
+      const char * myOuterInput;
+      size_t myOuterOffset;
+   };
+
+   // Notes that the current phase has reached offset in its input. A
+   // plain store, so cheap enough for the parser's every reduction.
+   static void at(size_t offset){
+      theOffset.store(offset, std::memory_order_relaxed);
+   }
+   static const size_t NO_OFFSET = SIZE_MAX;
+private:
+   static void start();
+   static void handler(int signal);
+   static void writeAtExit();
+
+   static std::atomic<const char *> thePhase;
+   static std::atomic<const char *> theInput;
+   static std::atomic<size_t> theOffset;
+};
+
+} /* end namespace */
+#endif /* END __LILC_SELFPROFILE_HPP__ */
@@ -0,0 +1,457 @@
+#include <new>
+#include <atomic>
+#include <vector>
+#include <sstream>
+#include <cstring>
+#include <cstdint>
+#include <iostream>
+#include <algorithm>
+#include <sched.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+
+#include "lilc_shard.hpp"
+#include "lilc_compiler.hpp"
+#include "lilc_compress.hpp"
+#include "lilc_unparse.hpp"
+#include "lilc_timing.hpp"
+
+namespace LILC{
+
+namespace {
+
+const size_t CACHE_LINE = 64;
+
+// Head of the shared mapping
+struct Queue{
+   std::atomic<uint32_t> next;
+};
+
+// Head of a worker's ring; its data follows. head is advanced only by
+// the worker and tail only by the coordinator, each on its own line.
+struct RingHeader{
+   alignas(CACHE_LINE) std::atomic<uint64_t> head;
+   alignas(CACHE_LINE) std::atomic<uint64_t> tail;
+   // Input the worker is on, or -1 between inputs
+   alignas(CACHE_LINE) std::atomic<int32_t> current;
+};
+
+// What follows a record header in a ring. A file's records are its
+// output, its diagnostics, then PARSED or FAILED with no bytes.
+enum Channel : uint32_t { OUTPUT, DIAGNOSTICS, PARSED, FAILED };
+
+struct Record{
+   uint32_t file;
+   uint32_t channel;
+   uint64_t length;
+};
+
+size_t roundUp(size_t n, size_t to)
+{
+   return (n + to - 1) / to * to;
+}
+
+// Waiting for the other side of a ring: yield for a while, then sleep.
+class Backoff{
+public:
+   void reset(){ myRounds = 0; }
+   void pause(){
+      if (myRounds++ < 64){
+         sched_yield();
+      } else {
+         usleep(50);
+      }
+   }
+private:
+   unsigned myRounds = 0;
+};
+
+class Ring{
+public:
+   Ring(RingHeader * header, size_t capacity)
+   : myHeader(header), myData((char *)(header + 1)), myMask(capacity - 1) { }
+
+   RingHeader * header() const { return myHeader; }
+
+   // Worker side: blocks while the ring is full. Gives up, ending the
+   // process, if the coordinator has gone.
+   void put(const void * bytes, size_t length, pid_t coordinator){
+      const char * from = (const char *)bytes;
+      uint64_t head = myHeader->head.load(std::memory_order_relaxed);
+      Backoff backoff;
+      while (length > 0){
+         uint64_t room = myMask + 1
+            - (head - myHeader->tail.load(std::memory_order_acquire));
+         if (room == 0){
+            backoff.pause();
+            if (getppid() != coordinator){ _exit(EXIT_FAILURE); }
+            continue;
+         }
+         backoff.reset();
+         size_t n = std::min<uint64_t>(room, length);
+         copyIn(head, from, n);
+         head += n;
+         from += n;
+         length -= n;
+         myHeader->head.store(head, std::memory_order_release);
+      }
+   }
+
+   // Coordinator side: up to length bytes that are ready, without
+   // blocking; returns how many.
+   size_t take(void * bytes, size_t length){
+      uint64_t tail = myHeader->tail.load(std::memory_order_relaxed);
+      size_t n = std::min<uint64_t>(length,
+         myHeader->head.load(std::memory_order_acquire) - tail);
+      copyOut(tail, (char *)bytes, n);
+      myHeader->tail.store(tail + n, std::memory_order_release);
+      return n;
+   }
+   size_t ready() const {
+      return myHeader->head.load(std::memory_order_acquire)
+         - myHeader->tail.load(std::memory_order_relaxed);
+   }
+   // Drops whatever is in the ring, e.g. a record a dead worker left
+   // half written.
+   void discard(){
+      myHeader->tail.store(myHeader->head.load(std::memory_order_acquire),
+         std::memory_order_release);
+   }
+private:
+   void copyIn(uint64_t at, const char * from, size_t n){
+      size_t start = at & myMask;
+      size_t first = std::min(n, myMask + 1 - start);
+      memcpy(myData + start, from, first);
+      memcpy(myData, from + first, n - first);
+   }
+   void copyOut(uint64_t at, char * to, size_t n){
+      size_t start = at & myMask;
+      size_t first = std::min(n, myMask + 1 - start);
+      memcpy(to, myData + start, first);
+      memcpy(to + first, myData, n - first);
+   }
+
+   RingHeader * myHeader;
+   char * myData;
+   size_t myMask;
+};
+
+struct Job{
+   const char * const * inputs;
+   const char * const * outputs;
+   uint32_t count;
+   const ShardSettings * settings;
+   Queue * queue;
+};
+
+void send(Ring &ring, uint32_t file, Channel channel, const std::string &bytes,
+pid_t coordinator)
+{
+   Record rec{ file, channel, bytes.size() };
+   ring.put(&rec, sizeof(rec), coordinator);
+   ring.put(bytes.data(), bytes.size(), coordinator);
+}
+
+// Compiles inputs from the queue until it is empty; never returns.
+void worker(const Job &job, Ring ring, pid_t coordinator)
+{
+   const std::string none;
+   while (true){
+      uint32_t i = job.queue->next.fetch_add(1);
+      if (i >= job.count){ break; }
+      ring.header()->current.store(i);
+      std::ostringstream diagnostics;
+      std::string text;
+      bool parsed;
+      {
+         LilC_Compiler compiler;
+         compiler.diagnostics().setFormat(job.settings->format);
+         compiler.diagnostics().setMaxEntries(job.settings->maxDiagnostics);
+         compiler.setTokenArrayMode(job.settings->tokenArray);
+         compiler.setDiagnosticsStream(&diagnostics);
+         parsed = compiler.buildAST(job.inputs[i]);
+         if (parsed){
+            text = unparseExact(compiler.getASTRoot());
+         }
+      }
+      send(ring, i, OUTPUT, text, coordinator);
+      send(ring, i, DIAGNOSTICS, diagnostics.str(), coordinator);
+      send(ring, i, parsed ? PARSED : FAILED, none, coordinator);
+      ring.header()->current.store(-1);
+   }
+   // Not exit(): that would flush stdio buffers copied from the
+   // coordinator.
+   _exit(0);
+}
+
+struct FileResult{
+   std::string output;
+   std::string diagnostics;
+   std::string failure;
+   bool done = false;
+};
+
+struct WorkerSlot{
+   pid_t pid = -1;
+   // The record being read and how many of its bytes are still to come
+   Record record;
+   uint64_t left = 0;
+   bool inRecord = false;
+};
+
+class Coordinator{
+public:
+   Coordinator(const Job &job, std::vector<Ring> &rings, std::ostream &report)
+   : myJob(job), myRings(rings), mySlots(rings.size()),
+     myFiles(job.count), myReport(report) { }
+
+   int run();
+private:
+   void spawn(size_t w);
+   bool drain(size_t w);
+   void finish(uint32_t file, bool parsed);
+   void reap(pid_t pid, int status);
+   void writeDiagnostics();
+
+   const Job &myJob;
+   std::vector<Ring> &myRings;
+   std::vector<WorkerSlot> mySlots;
+   std::vector<FileResult> myFiles;
+   std::ostream &myReport;
+   size_t myReported = 0;
+   size_t myLive = 0;
+   int myFailed = 0;
+};
+
+void Coordinator::spawn(size_t w)
+{
+   std::cout.flush();
+   std::cerr.flush();
+   myReport.flush();
+   myRings[w].discard();
+   myRings[w].header()->current.store(-1);
+   mySlots[w] = WorkerSlot();
+   pid_t coordinator = getpid();
+   pid_t pid = fork();
+   if (pid == 0){
+      worker(myJob, myRings[w], coordinator);
+   }
+   if (pid < 0){
+      return;
+   }
+   mySlots[w].pid = pid;
+   myLive++;
+}
+
+// Reads what worker w has written so far; returns whether there was
+// anything.
+bool Coordinator::drain(size_t w)
+{
+   Ring &ring = myRings[w];
+   WorkerSlot &slot = mySlots[w];
+   bool progress = false;
+   while (true){
+      if (!slot.inRecord){
+         if (ring.ready() < sizeof(Record)){ break; }
+         ring.take(&slot.record, sizeof(Record));
+         slot.left = slot.record.length;
+         slot.inRecord = true;
+         progress = true;
+      }
+      FileResult &file = myFiles[slot.record.file];
+      if (slot.left > 0){
+         std::string &to = slot.record.channel == OUTPUT ? file.output
+            : file.diagnostics;
+         size_t have = to.size();
+         size_t n = std::min<uint64_t>(slot.left, ring.ready());
+         if (n == 0){ break; }
+         to.resize(have + n);
+         ring.take(&to[have], n);
+         slot.left -= n;
+         progress = true;
+      }
+      if (slot.left == 0){
+         slot.inRecord = false;
+         if (slot.record.channel == PARSED || slot.record.channel == FAILED){
+            finish(slot.record.file, slot.record.channel == PARSED);
+         }
+      }
+   }
+   return progress;
+}
+
+void Coordinator::finish(uint32_t file, bool parsed)
+{
+   FileResult &result = myFiles[file];
+   if (!myJob.settings->discard){
+      // A file that does not parse gets an empty output, as with P3
+      // <infile> <outfile>
+      OutputFile out(myJob.outputs[file]);
+      if (parsed){
+         out.stream().write(result.output.data(), result.output.size());
+      }
+   }
+   std::string().swap(result.output);
+   result.done = true;
+   if (!parsed){ myFailed++; }
+}
+
+void Coordinator::reap(pid_t pid, int status)
+{
+   size_t w = 0;
+   while (w < mySlots.size() && mySlots[w].pid != pid){ w++; }
+   if (w == mySlots.size()){ return; }
+   drain(w);
+   int32_t current = myRings[w].header()->current.load();
+   if (current >= 0 && !myFiles[current].done){
+      std::ostringstream why;
+      if (WIFSIGNALED(status)){
+         why << "worker killed by signal " << WTERMSIG(status) << " ("
+            << strsignal(WTERMSIG(status)) << ")\n";
+      } else {
+         why << "worker exited with status " << WEXITSTATUS(status) << "\n";
+      }
+      myFiles[current].diagnostics.clear();
+      myFiles[current].failure = why.str();
+      finish(current, false);
+   }
+   mySlots[w].pid = -1;
+   myLive--;
+   if (myJob.queue->next.load() < myJob.count){
+      spawn(w);
+   }
+}
+
+// Diagnostics of the files done so far, in input order
+void Coordinator::writeDiagnostics()
+{
+   for (; myReported < myFiles.size() && myFiles[myReported].done;
+      myReported++){
+      FileResult &file = myFiles[myReported];
+      if (file.diagnostics.empty() && file.failure.empty()){ continue; }
+      myReport << "==> " << myJob.inputs[myReported] << " <==\n"
+         << file.diagnostics << file.failure;
+      std::string().swap(file.diagnostics);
+   }
+   myReport.flush();
+}
+
+int Coordinator::run()
+{
+   for (size_t w = 0; w < mySlots.size(); w++){
+      spawn(w);
+   }
+   Backoff backoff;
+   while (myLive > 0){
+      bool progress = false;
+      for (size_t w = 0; w < mySlots.size(); w++){
+         if (mySlots[w].pid > 0 && drain(w)){ progress = true; }
+      }
+      int status;
+      pid_t pid;
+      while ((pid = waitpid(-1, &status, WNOHANG)) > 0){
+         reap(pid, status);
+         progress = true;
+      }
+      if (progress){
+         writeDiagnostics();
+         backoff.reset();
+      } else {
+         backoff.pause();
+      }
+   }
+   // Inputs no worker got to the end of, because none could be started
+   // or one died between taking an input and saying so
+   for (uint32_t i = 0; i < myJob.count; i++){
+      if (!myFiles[i].done){
+         myFiles[i].failure = "no worker finished this input\n";
+         finish(i, false);
+      }
+   }
+   writeDiagnostics();
+   return myFailed;
+}
+
+} /* end anonymous namespace */
+
+int shardedCompile(const char * const * inputs, const char * const * outputs,
+int count, const ShardSettings &settings, std::ostream &report)
+{
+   if (count <= 0){ return 0; }
+   long cores = sysconf(_SC_NPROCESSORS_ONLN);
+   size_t workers = settings.workers > 0 ? settings.workers
+      : std::max(1L, cores);
+   workers = std::min<size_t>(workers, count);
+   size_t capacity = 64;
+   while (capacity < settings.ringBytes){ capacity *= 2; }
+
+   size_t queueBytes = roundUp(sizeof(Queue), CACHE_LINE);
+   size_t ringBytes = roundUp(sizeof(RingHeader) + capacity, CACHE_LINE);
+   size_t bytes = queueBytes + workers * ringBytes;
+   char * shared = (char *)mmap(nullptr, bytes, PROT_READ | PROT_WRITE,
+      MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+   if (shared == MAP_FAILED){
+      std::cerr << "Cannot map memory for the workers, exiting!!\n";
+      exit(EXIT_FAILURE);
+   }
+   Queue * queue = new (shared) Queue();
+   queue->next.store(0);
+   std::vector<Ring> rings;
+   for (size_t w = 0; w < workers; w++){
+      RingHeader * header = new (shared + queueBytes + w * ringBytes)
+         RingHeader();
+      header->head.store(0);
+      header->tail.store(0);
+      header->current.store(-1);
+      rings.push_back(Ring(header, capacity));
+   }
+
+   Job job{ inputs, outputs, (uint32_t)count, &settings, queue };
+   int failed = Coordinator(job, rings, report).run();
+   munmap(shared, bytes);
+   return failed;
+}
+
+int shardBenchmark(const char * const * inputs, int count,
+const ShardSettings &settings, std::ostream &report)
+{
+   long cores = sysconf(_SC_NPROCESSORS_ONLN);
+   int most = settings.workers > 0 ? settings.workers : std::max(1L, cores);
+   double inputBytes = 0;
+   for (int i = 0; i < count; i++){
+      struct stat st;
+      if (stat(inputs[i], &st) != 0){
+         report << "cannot open " << inputs[i] << "\n";
+         return 1;
+      }
+      inputBytes += st.st_size;
+   }
+   report << count << " files, " << inputBytes / 1e6 << " MB, " << cores
+      << " cores online\n";
+
+   std::vector<int> counts;
+   for (int n = 1; n < most; n *= 2){ counts.push_back(n); }
+   counts.push_back(most);
+
+   const int rounds = 3;
+   ShardSettings run = settings;
+   run.discard = true;
+   std::ostream quiet(nullptr);
+   double single = 0;
+   for (int n : counts){
+      run.workers = n;
+      double median = medianMs(rounds, [&](){
+         shardedCompile(inputs, nullptr, count, run, quiet);
+      }) / 1e3;
+      if (n == 1){ single = median; }
+      report << n << " worker" << (n == 1 ? "" : "s") << ": median "
+         << median * 1e3 << " ms, " << (inputBytes / 1e6) / median
+         << " MB/s, speedup " << single / median << " (" << rounds
+         << " rounds)\n";
+   }
+   return 0;
+}
+
+} /* end namespace */
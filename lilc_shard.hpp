@@ -0,0 +1,48 @@
+#ifndef __LILC_SHARD_HPP__
+#define __LILC_SHARD_HPP__ 1
+
+#include <cstddef>
+#include <ostream>
+
+#include "lilc_diagnostics.hpp"
+
+namespace LILC{
+
+struct ShardSettings{
+   // Worker processes; 0 for one per online core
+   int workers = 0;
+   // Bytes of each worker's result ring (rounded up to a power of two)
+   size_t ringBytes = (size_t)1 << 20;
+   Diagnostics::Format format = Diagnostics::TEXT;
+   size_t maxDiagnostics = Diagnostics::DEFAULT_MAX_ENTRIES;
+   bool tokenArray = false;
+   // Collect the outputs but do not write them (for benchmarks)
+   bool discard = false;
+};
+
+// Sharded compilation (--shards=N). Unparses inputs[i] to outputs[i] for
+// every i, as P3 <infile> <outfile> would, in N forked worker processes.
+// The coordinator and its workers share one anonymous mapping made
+// before the fork: a queue that workers take the index of their next
+// input from with an atomic increment, and one single-producer ring
+// buffer per worker that it streams each file's output and diagnostics
+// into. The coordinator drains the rings, writes each output when its
+// file is done, and writes the diagnostics to report in input order,
+// each file's under a "==> infile <==" line. No pipe or temporary file
+// is involved and the parser's global state is private to each worker.
+//
+// A worker that crashes or is killed fails the file it was on (which
+// gets an empty output, as a file that does not parse) and is replaced
+// by a fresh one while inputs remain. Returns the number of files that
+// failed to parse or were lost to a crashed worker.
+int shardedCompile(const char * const * inputs, const char * const * outputs,
+   int count, const ShardSettings &settings, std::ostream &report);
+
+// Compiles inputs with 1, 2, 4, ... workers up to settings.workers (one
+// per online core by default) and reports the median wall time, the
+// throughput and the speedup over one worker of each count.
+int shardBenchmark(const char * const * inputs, int count,
+   const ShardSettings &settings, std::ostream &report);
+
+} /* end namespace */
+#endif /* END __LILC_SHARD_HPP__ */
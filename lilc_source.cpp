@@ -0,0 +1,311 @@
+#include <algorithm>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include "lilc_source.hpp"
+#include "lilc_compress.hpp"
+
+namespace LILC{
+
+size_t countNewlines(const char * data, size_t len)
+{
+   size_t count = 0;
+   size_t i = 0;
+#if defined(__SSE2__)
+   const __m128i newline = _mm_set1_epi8('\n');
+   for (; i + 16 <= len; i += 16){
+      __m128i bytes = _mm_loadu_si128((const __m128i *)(data + i));
+      unsigned mask = _mm_movemask_epi8(_mm_cmpeq_epi8(bytes, newline));
+      count += __builtin_popcount(mask);
+   }
+#endif
+   for (; i < len; i++){
+      count += data[i] == '\n';
+   }
+   return count;
+}
+
+LineIndex::LineIndex(const char * data, size_t len)
+: myStarts(1, 0)
+{
+   myStarts.reserve(len / 32 + 1);
+   append(data, len);
+}
+
+void LineIndex::append(const char * data, size_t len)
+{
+   size_t base = myLength;
+   size_t i = 0;
+#if defined(__SSE2__)
+   const __m128i newline = _mm_set1_epi8('\n');
+   for (; i + 16 <= len; i += 16){
+      __m128i bytes = _mm_loadu_si128((const __m128i *)(data + i));
+      unsigned mask = _mm_movemask_epi8(_mm_cmpeq_epi8(bytes, newline));
+      while (mask != 0){
+         myStarts.push_back(base + i + __builtin_ctz(mask) + 1);
+         mask &= mask - 1;
+      }
+   }
+#endif
+   for (; i < len; i++){
+      if (data[i] == '\n'){ myStarts.push_back(base + i + 1); }
+   }
+   myLength += len;
+}
+
+Position LineIndex::position(size_t offset) const
+{
+   size_t line = std::upper_bound(myStarts.begin(), myStarts.end(), offset)
+      - myStarts.begin();
+   return Position{line, offset - myStarts[line - 1] + 1};
+}
+
+MappedSource::~MappedSource()
+{
+   if (myMapped){
+      munmap(const_cast<char *>(myData), mySize);
+   }
+}
+
+// Inputs up to this size are read rather than mapped: for a short file
+// the mmap, the page fault and the munmap cost more than one read().
+static const off_t SMALL_INPUT = 64 << 10;
+
+bool MappedSource::open(const char * filename)
+{
+   int fd = ::open(filename, O_RDONLY);
+   if (fd < 0){
+      return false;
+   }
+   struct stat st;
+   if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode)
+      && st.st_size > SMALL_INPUT){
+      void * addr = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+      if (addr != MAP_FAILED){
+         madvise(addr, st.st_size, MADV_SEQUENTIAL);
+         myData = (const char *)addr;
+         mySize = st.st_size;
+         myMapped = true;
+      }
+   }
+   if (!myMapped){
+      char buf[65536];
+      ssize_t n;
+      while ((n = read(fd, buf, sizeof(buf))) > 0){
+         myCopy.append(buf, n);
+      }
+      myData = myCopy.data();
+      mySize = myCopy.size();
+   }
+   close(fd);
+   Compression kind = detectCompression(myData, mySize);
+   if (kind == NO_COMPRESSION){
+      myIndex = LineIndex(myData, mySize);
+      myStreamBuf.reset(new MemoryStreamBuf(myData, mySize));
+   } else {
+      myIndex = LineIndex();
+      myStreamBuf.reset(new DecompressStreamBuf(myData, mySize, kind,
+         &myIndex));
+   }
+   return true;
+}
+
+// Fenwick tree helpers; tree[0] is unused and tree[i] covers the chunks
+// (i - lowbit(i), i].
+size_t RopeSource::prefix(const std::vector<size_t> &tree, size_t count)
+{
+   size_t sum = 0;
+   for (size_t i = count; i > 0; i -= i & (~i + 1)){
+      sum += tree[i];
+   }
+   return sum;
+}
+
+void RopeSource::add(std::vector<size_t> &tree, size_t idx, long delta)
+{
+   for (size_t i = idx + 1; i < tree.size(); i += i & (~i + 1)){
+      tree[i] += delta;
+   }
+}
+
+// Largest k such that the first k chunks hold at most target units.
+size_t RopeSource::search(const std::vector<size_t> &tree, size_t target)
+{
+   size_t pos = 0;
+   size_t step = 1;
+   while (step * 2 < tree.size()){ step *= 2; }
+   for (; step > 0; step /= 2){
+      if (pos + step < tree.size() && tree[pos + step] <= target){
+         pos += step;
+         target -= tree[pos];
+      }
+   }
+   return pos;
+}
+
+void RopeSource::rebuild()
+{
+   size_t n = myChunks.size();
+   myBytes.assign(n + 1, 0);
+   myNewlines.assign(n + 1, 0);
+   for (size_t i = 1; i <= n; i++){
+      myBytes[i] += myChunks[i - 1].size();
+      myNewlines[i] += countNewlines(myChunks[i - 1].data(),
+         myChunks[i - 1].size());
+      size_t parent = i + (i & (~i + 1));
+      if (parent <= n){
+         myBytes[parent] += myBytes[i];
+         myNewlines[parent] += myNewlines[i];
+      }
+   }
+}
+
+void RopeSource::setChunk(size_t idx, std::string text)
+{
+   std::string &chunk = myChunks[idx];
+   add(myBytes, idx, (long)text.size() - (long)chunk.size());
+   add(myNewlines, idx, (long)countNewlines(text.data(), text.size())
+      - (long)countNewlines(chunk.data(), chunk.size()));
+   chunk.swap(text);
+}
+
+// Cuts text into pieces of equal size, CHUNK_SIZE at most; each is at
+// least half of CHUNK_SIZE unless text is shorter than that.
+static void splitChunks(const std::string &text, std::vector<std::string> &out)
+{
+   const size_t chunkSize = RopeSource::CHUNK_SIZE;
+   size_t count = (text.size() + chunkSize - 1) / chunkSize;
+   for (size_t i = 0; i < count; i++){
+      size_t from = text.size() * i / count;
+      size_t to = text.size() * (i + 1) / count;
+      out.push_back(text.substr(from, to - from));
+   }
+}
+
+// Puts the pieces of text in place of chunks [first, end)
+void RopeSource::replaceChunks(size_t first, size_t end,
+const std::string &text)
+{
+   std::vector<std::string> pieces;
+   splitChunks(text, pieces);
+   myChunks.erase(myChunks.begin() + first, myChunks.begin() + end);
+   myChunks.insert(myChunks.begin() + first, pieces.begin(), pieces.end());
+   rebuild();
+}
+
+void RopeSource::assign(const std::string &text)
+{
+   myChunks.clear();
+   splitChunks(text, myChunks);
+   rebuild();
+}
+
+size_t RopeSource::chunkFor(size_t offset, size_t &inChunk) const
+{
+   size_t idx = search(myBytes, offset);
+   if (idx >= myChunks.size()){
+      idx = myChunks.size() - 1;
+   }
+   inChunk = offset - prefix(myBytes, idx);
+   return idx;
+}
+
+void RopeSource::insert(size_t offset, const std::string &text)
+{
+   if (text.empty()){ return; }
+   if (myChunks.empty()){
+      assign(text);
+      return;
+   }
+   size_t in;
+   size_t idx = chunkFor(std::min(offset, size()), in);
+   std::string merged = myChunks[idx];
+   merged.insert(in, text);
+   if (merged.size() <= 2 * CHUNK_SIZE){
+      setChunk(idx, std::move(merged));
+      return;
+   }
+   replaceChunks(idx, idx + 1, merged);
+}
+
+void RopeSource::erase(size_t offset, size_t len)
+{
+   size_t total = size();
+   if (offset >= total || len == 0){ return; }
+   len = std::min(len, total - offset);
+   size_t firstIn, lastIn;
+   size_t first = chunkFor(offset, firstIn);
+   size_t last = chunkFor(offset + len - 1, lastIn);
+   std::string merged = myChunks[first].substr(0, firstIn)
+      + myChunks[last].substr(lastIn + 1);
+   size_t end = last + 1;
+   if (merged.size() < CHUNK_SIZE / 2){
+      // Keep chunks at least half full: take in a neighbour
+      if (end < myChunks.size()){
+         merged += myChunks[end++];
+      } else if (first > 0){
+         first--;
+         merged.insert(0, myChunks[first]);
+      }
+   }
+   if (end - first == 1 && !merged.empty() && merged.size() <= 2 * CHUNK_SIZE){
+      setChunk(first, std::move(merged));
+      return;
+   }
+   replaceChunks(first, end, merged);
+}
+
+size_t RopeSource::lineStart(size_t line) const
+{
+   if (line == 0 || myChunks.empty()){ return 0; }
+   // Find the chunk holding the line'th newline, then scan it.
+   size_t idx = search(myNewlines, line - 1);
+   if (idx >= myChunks.size()){ return size(); }
+   size_t want = line - prefix(myNewlines, idx);
+   const std::string &chunk = myChunks[idx];
+   size_t pos = 0;
+   while (true){
+      pos = chunk.find('\n', pos);
+      if (--want == 0){ break; }
+      pos++;
+   }
+   return prefix(myBytes, idx) + pos + 1;
+}
+
+size_t RopeSource::lineEnd(size_t line) const
+{
+   if (line + 1 >= lineCount()){ return size(); }
+   return lineStart(line + 1) - 1;
+}
+
+Position RopeSource::position(size_t offset) const
+{
+   if (myChunks.empty()){ return Position{1, 1}; }
+   size_t in;
+   size_t idx = chunkFor(std::min(offset, size()), in);
+   size_t line = prefix(myNewlines, idx)
+      + countNewlines(myChunks[idx].data(), in);
+   return Position{line + 1, offset - lineStart(line) + 1};
+}
+
+std::string RopeSource::substr(size_t offset, size_t len) const
+{
+   std::string result;
+   if (myChunks.empty() || offset >= size()){ return result; }
+   result.reserve(len);
+   size_t in;
+   size_t idx = chunkFor(offset, in);
+   for (; idx < myChunks.size() && result.size() < len; idx++){
+      result.append(myChunks[idx], in, len - result.size());
+      in = 0;
+   }
+   return result;
+}
+
+} /* end namespace */
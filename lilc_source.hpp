@@ -0,0 +1,134 @@
+#ifndef __LILC_SOURCE_HPP__
+#define __LILC_SOURCE_HPP__ 1
+
+#include <string>
+#include <vector>
+#include <cstddef>
+#include <streambuf>
+#include <memory>
+
+namespace LILC{
+
+// 1-based line and column of a byte offset.
+struct Position{
+   size_t line;
+   size_t col;
+};
+
+// Counts '\n' bytes in [data, data + len); vectorized where SSE2 is
+// available.
+size_t countNewlines(const char * data, size_t len);
+
+// Byte offsets of the start of every line of a flat buffer, built with
+// one vectorized pass over the text. Offset to line/column lookups are a
+// binary search, so the scanner only has to remember where each token
+// starts.
+class LineIndex{
+public:
+   LineIndex() : myStarts(1, 0) { }
+   LineIndex(const char * data, size_t len);
+
+   // Extends the index with the next len bytes of the text, for sources
+   // that arrive in pieces (e.g. while being decompressed).
+   void append(const char * data, size_t len);
+
+   Position position(size_t offset) const;
+   size_t lineCount() const { return myStarts.size(); }
+   size_t lineStart(size_t line) const { return myStarts[line]; }
+private:
+   std::vector<size_t> myStarts;
+   size_t myLength = 0;
+};
+
+class SourceBuffer{
+public:
+   virtual ~SourceBuffer() { }
+   virtual size_t size() const = 0;
+   virtual Position position(size_t offset) const = 0;
+};
+
+// Batch-mode input: the whole file mapped read-only (or read into memory
+// when it cannot be mapped, e.g. a pipe), with a LineIndex built once.
+// gzip and zstd files are recognized by their magic bytes and inflated
+// as the scanner reads them through streamBuf(); their line index grows
+// as they go, and data()/size() are the compressed bytes.
+class MappedSource : public SourceBuffer{
+public:
+   MappedSource() = default;
+   ~MappedSource();
+   MappedSource(const MappedSource &) = delete;
+   MappedSource & operator=(const MappedSource &) = delete;
+
+   bool open(const char * filename);
+   const char * data() const { return myData; }
+   size_t size() const override { return mySize; }
+   Position position(size_t offset) const override {
+      return myIndex.position(offset);
+   }
+   const LineIndex & lineIndex() const { return myIndex; }
+   // The text for the scanner, decompressed if need be
+   std::streambuf * streamBuf(){ return myStreamBuf.get(); }
+private:
+   const char * myData = nullptr;
+   size_t mySize = 0;
+   bool myMapped = false;
+   std::string myCopy;
+   LineIndex myIndex;
+   std::unique_ptr<std::streambuf> myStreamBuf;
+};
+
+// Editor-mode text: a sequence of chunks with Fenwick trees over their
+// byte and newline counts. Every chunk but the last holds CHUNK_SIZE/2 to
+// 2*CHUNK_SIZE bytes (an erase that leaves less merges with a neighbour),
+// so there are O(n / CHUNK_SIZE) of them. Offset and line lookups are
+// O(log n) plus a scan inside one chunk, and so is an edit that stays
+// within one chunk, as most typing does. An edit that splits, merges or
+// spans chunks shifts the chunk vector and rebuilds the trees, which is
+// O(n / CHUNK_SIZE).
+class RopeSource : public SourceBuffer{
+public:
+   RopeSource() = default;
+   explicit RopeSource(const std::string &text){ assign(text); }
+
+   void assign(const std::string &text);
+   void insert(size_t offset, const std::string &text);
+   void erase(size_t offset, size_t len);
+
+   size_t size() const override { return prefix(myBytes, myChunks.size()); }
+   Position position(size_t offset) const override;
+   size_t lineCount() const { return prefix(myNewlines, myChunks.size()) + 1; }
+   // Offset of the first byte of 0-based line, and of its terminating
+   // newline (or the end of the text).
+   size_t lineStart(size_t line) const;
+   size_t lineEnd(size_t line) const;
+
+   std::string substr(size_t offset, size_t len) const;
+   std::string str() const { return substr(0, size()); }
+
+   static const size_t CHUNK_SIZE = 4096;
+private:
+   static size_t prefix(const std::vector<size_t> &tree, size_t count);
+   static void add(std::vector<size_t> &tree, size_t idx, long delta);
+   static size_t search(const std::vector<size_t> &tree, size_t target);
+   size_t chunkFor(size_t offset, size_t &inChunk) const;
+   void setChunk(size_t idx, std::string text);
+   void replaceChunks(size_t first, size_t end, const std::string &text);
+   void rebuild();
+
+   std::vector<std::string> myChunks;
+   std::vector<size_t> myBytes;
+   std::vector<size_t> myNewlines;
+};
+
+// Lets the flex scanner read straight out of a memory buffer (e.g. a
+// MappedSource) through its std::istream interface.
+class MemoryStreamBuf : public std::streambuf{
+public:
+   MemoryStreamBuf(const char * data, size_t len){
+      char * p = const_cast<char *>(data);
+      setg(p, p, p + len);
+   }
+};
+
+} /* end namespace */
+#endif /* END __LILC_SOURCE_HPP__ */
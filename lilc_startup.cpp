@@ -0,0 +1,119 @@
+#include <chrono>
+#include <string>
+#include <vector>
+#include <cstdlib>
+#include <algorithm>
+#include <spawn.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/wait.h>
+#include <sys/resource.h>
+
+#include "lilc_startup.hpp"
+#include "lilc_timing.hpp"
+
+extern char ** environ;
+
+namespace LILC{
+
+namespace {
+
+const int RUNS = 400;
+const char ONE_LINE[] = "int x;\n";
+
+struct Samples{
+   std::vector<double> micros;
+   long faults = 0;
+   int failures = 0;
+};
+
+// One run of program, its stdout and stderr sent to /dev/null
+void runOnce(const char * program, const std::string &in,
+const std::string &out, Samples &samples)
+{
+   posix_spawn_file_actions_t actions;
+   posix_spawn_file_actions_init(&actions);
+   posix_spawn_file_actions_addopen(&actions, STDOUT_FILENO, "/dev/null",
+      O_WRONLY, 0);
+   posix_spawn_file_actions_addopen(&actions, STDERR_FILENO, "/dev/null",
+      O_WRONLY, 0);
+   char * argv[] = { (char *)program, (char *)in.c_str(),
+      (char *)out.c_str(), nullptr };
+   pid_t pid;
+   int status = 0;
+   rusage usage;
+   auto start = std::chrono::steady_clock::now();
+   bool ran = posix_spawn(&pid, program, &actions, nullptr, argv,
+      environ) == 0 && wait4(pid, &status, 0, &usage) == pid;
+   auto end = std::chrono::steady_clock::now();
+   posix_spawn_file_actions_destroy(&actions);
+   if (!ran || !WIFEXITED(status) || WEXITSTATUS(status) != 0){
+      samples.failures++;
+      return;
+   }
+   samples.micros.push_back(
+      std::chrono::duration<double, std::micro>(end - start).count());
+   samples.faults += usage.ru_minflt + usage.ru_majflt;
+}
+
+double percentile(const std::vector<double> &sorted, double p)
+{
+   return sorted[std::min(sorted.size() - 1, (size_t)(p * sorted.size()))];
+}
+
+} /* end anonymous namespace */
+
+int startupBenchmark(const char * const * programs, int count,
+std::ostream &report)
+{
+   const char * self[] = { "/proc/self/exe" };
+   if (count == 0){
+      programs = self;
+      count = 1;
+   }
+   std::string in = std::string(tempDir()) + "/lilc-startup-XXXXXX";
+   int fd = mkstemp(&in[0]);
+   if (fd < 0 || write(fd, ONE_LINE, sizeof(ONE_LINE) - 1)
+      != (ssize_t)sizeof(ONE_LINE) - 1){
+      report << "cannot write a temporary input\n";
+      return 1;
+   }
+   close(fd);
+   std::string out = in + ".out";
+
+   // In turn rather than one program after another, so that drift in the
+   // machine's load is shared out evenly
+   std::vector<Samples> samples(count);
+   for (int run = 0; run < RUNS; run++){
+      for (int i = 0; i < count; i++){
+         runOnce(programs[i], in, out, samples[i]);
+      }
+   }
+   unlink(in.c_str());
+   unlink(out.c_str());
+
+   int failed = 0;
+   for (int i = 0; i < count; i++){
+      Samples &s = samples[i];
+      report << programs[i] << ": ";
+      if (s.micros.empty()){
+         report << "does not run\n";
+         failed++;
+         continue;
+      }
+      std::sort(s.micros.begin(), s.micros.end());
+      report << "median " << percentile(s.micros, 0.5) << " us (p10 "
+         << percentile(s.micros, 0.1) << ", p90 "
+         << percentile(s.micros, 0.9) << "), "
+         << s.faults / (long)s.micros.size() << " page faults, "
+         << s.micros.size() << " runs";
+      if (s.failures > 0){
+         report << ", " << s.failures << " failed";
+         failed++;
+      }
+      report << "\n";
+   }
+   return failed == 0 ? 0 : 1;
+}
+
+} /* end namespace */
@@ -0,0 +1,18 @@
+#ifndef __LILC_STARTUP_HPP__
+#define __LILC_STARTUP_HPP__ 1
+
+#include <ostream>
+
+namespace LILC{
+
+// Startup latency (--startup-bench). Runs each of programs as
+// "program <in> <out>" on a one-line input, many times and in turn, and
+// reports the median and spread of the wall time from posix_spawn (the
+// execve) to the child's exit being reaped, with its page faults. With
+// no programs, runs this executable. For comparing a dynamically linked
+// P3 with the static one the Makefile builds as P3-static.
+int startupBenchmark(const char * const * programs, int count,
+   std::ostream &report);
+
+} /* end namespace */
+#endif /* END __LILC_STARTUP_HPP__ */
@@ -0,0 +1,188 @@
+#include <cmath>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <csignal>
+#include <fstream>
+#include <iomanip>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/wait.h>
+#include <sys/resource.h>
+
+#include "lilc_stress.hpp"
+#include "lilc_timing.hpp"
+#include "lilc_generate.hpp"
+#include "lilc_compiler.hpp"
+
+namespace LILC{
+
+namespace {
+
+struct ShapeInfo{
+   const char * name;
+   StressShape shape;
+   // Full size, in the shape's own unit
+   size_t size;
+   const char * unit;
+   // Time budget per MB of input, on top of FIXED_SECONDS
+   double secondsPerMB;
+   // Memory budget per byte of input, on top of FIXED_BYTES
+   double bytesPerByte;
+};
+
+// The rates are about twice the time and one and a half times the peak
+// RSS per byte measured on an -O2 build at full size (long-line at a
+// tenth of it): 0.38 s/MB and 85 B/B for long-line, 0.31 and 104 for
+// nested-if, 0.30 and 90 for assign-chain, 0.13 and 41 for long-formals,
+// 0.48 and 3.1 for illegal-chars.
+const ShapeInfo SHAPES[] = {
+   { "long-line", LONG_LINE, (size_t)100 << 20, "bytes", 0.8, 128 },
+   { "nested-if", NESTED_IF, 1000000, "levels", 0.6, 160 },
+   { "assign-chain", ASSIGN_CHAIN, 1000000, "assignments", 0.6, 136 },
+   { "long-formals", LONG_FORMALS, 1000000, "formals", 0.3, 64 },
+   { "illegal-chars", ILLEGAL_CHARS, (size_t)1 << 30, "bytes", 1.0, 5 },
+};
+
+const double FIXED_SECONDS = 1;
+const double FIXED_BYTES = 64 << 20;
+const double MAX_GROWTH = 8;
+
+struct Run{
+   size_t inputBytes = 0;
+   double seconds = 0;
+   double peakBytes = 0;
+   double secondsBudget = 0;
+   double bytesBudget = 0;
+   const char * failure = nullptr;
+};
+
+// Parses the file in a child process; never returns.
+void child(const std::string &path, const Run &run)
+{
+   int null = open("/dev/null", O_WRONLY);
+   if (null >= 0){
+      dup2(null, STDOUT_FILENO);
+      dup2(null, STDERR_FILENO);
+   }
+   rlimit limit;
+   limit.rlim_cur = limit.rlim_max =
+      (rlim_t)(2 * run.bytesBudget) + ((rlim_t)256 << 20);
+   setrlimit(RLIMIT_AS, &limit);
+   alarm((unsigned)std::ceil(run.secondsBudget));
+   bool parsed;
+   {
+      LilC_Compiler compiler;
+      parsed = compiler.buildAST(path.c_str());
+   }
+   _exit(parsed ? 0 : 1);
+}
+
+Run runShape(const ShapeInfo &info, size_t size)
+{
+   Run run;
+   std::string path = std::string(tempDir()) + "/lilc-stress-XXXXXX";
+   int fd = mkstemp(&path[0]);
+   if (fd < 0){
+      run.failure = "cannot create a temporary file";
+      return run;
+   }
+   close(fd);
+   {
+      std::ofstream out(path, std::ios::binary);
+      generateStress(info.shape, size, out);
+      run.inputBytes = out.tellp();
+      if (!out.good()){
+         unlink(path.c_str());
+         run.failure = "cannot write the input";
+         return run;
+      }
+   }
+   run.secondsBudget = FIXED_SECONDS
+      + run.inputBytes / 1e6 * info.secondsPerMB;
+   run.bytesBudget = FIXED_BYTES + run.inputBytes * info.bytesPerByte;
+
+   auto start = std::chrono::steady_clock::now();
+   pid_t pid = fork();
+   if (pid == 0){
+      child(path, run);
+   }
+   int status = 0;
+   rusage usage;
+   bool waited = pid > 0 && wait4(pid, &status, 0, &usage) == pid;
+   auto end = std::chrono::steady_clock::now();
+   unlink(path.c_str());
+   if (!waited){
+      run.failure = "cannot run the parser";
+      return run;
+   }
+   run.seconds = std::chrono::duration<double>(end - start).count();
+   run.peakBytes = usage.ru_maxrss * 1024.0;
+
+   if (WIFSIGNALED(status)){
+      switch (WTERMSIG(status)){
+      case SIGALRM: run.failure = "timed out"; break;
+      case SIGSEGV: run.failure = "crashed (stack overflow?)"; break;
+      case SIGABRT: run.failure = "aborted (out of memory?)"; break;
+      default: run.failure = "killed by a signal"; break;
+      }
+   } else if (WEXITSTATUS(status) != 0 && info.shape != ILLEGAL_CHARS){
+      run.failure = "does not parse";
+   } else if (run.peakBytes > run.bytesBudget){
+      run.failure = "peak RSS over budget";
+   }
+   return run;
+}
+
+void describe(const Run &run, std::ostream &report)
+{
+   report << run.inputBytes / 1e6 << " MB, " << run.seconds << " s (budget "
+      << run.secondsBudget << "), peak " << run.peakBytes / 1e6
+      << " MB (budget " << run.bytesBudget / 1e6 << ")";
+}
+
+} /* end anonymous namespace */
+
+int stressHarness(const StressSettings &settings, std::ostream &report)
+{
+   report << std::fixed << std::setprecision(1);
+   int failed = 0;
+   int ran = 0;
+   for (const ShapeInfo &info : SHAPES){
+      if (settings.only != nullptr && strcmp(settings.only, info.name) != 0){
+         continue;
+      }
+      ran++;
+      size_t size = std::max<size_t>(4, info.size * settings.scale);
+      report << info.name << ": " << size << " " << info.unit << std::endl;
+      Run quarter = runShape(info, size / 4);
+      report << "   quarter: ";
+      describe(quarter, report);
+      report << std::endl;
+      const char * failure = quarter.failure;
+      if (failure == nullptr){
+         Run full = runShape(info, size);
+         report << "   full:    ";
+         describe(full, report);
+         report << "\n";
+         failure = full.failure;
+         if (failure == nullptr && quarter.seconds >= 0.05
+            && full.seconds > MAX_GROWTH * quarter.seconds){
+            failure = "time grows faster than the input";
+         } else if (failure == nullptr
+            && full.peakBytes > MAX_GROWTH * quarter.peakBytes){
+            failure = "peak RSS grows faster than the input";
+         }
+      }
+      report << "   " << (failure == nullptr ? "ok" : failure) << "\n";
+      if (failure != nullptr){ failed++; }
+   }
+   if (ran == 0){
+      report << "no stress shape named " << settings.only << "\n";
+      return 1;
+   }
+   report << ran - failed << " of " << ran << " shapes within budget\n";
+   return failed;
+}
+
+} /* end namespace */
@@ -0,0 +1,29 @@
+#ifndef __LILC_STRESS_HPP__
+#define __LILC_STRESS_HPP__ 1
+
+#include <ostream>
+
+namespace LILC{
+
+struct StressSettings{
+   // Fraction of the full input sizes to run at
+   double scale = 1.0;
+   // Name of the one shape to run, or nullptr for all of them
+   const char * only = nullptr;
+};
+
+// Stress harness (--stress). Each shape of generateStress() is written to
+// a temporary file and parsed in a child process, once at full size and
+// once at a quarter of it. The child is killed if it runs past its time
+// budget or tries to grow past twice its memory budget, so a runaway
+// parse cannot take the machine down with it. Budgets are linear in the
+// input size: a fixed allowance plus a per-byte rate for each shape, set
+// near its measured cost with some margin. A crash (typically a stack
+// overflow), a timeout, a peak RSS over budget, or a time or peak RSS
+// growing faster than the size (four times the input taking more than
+// eight times as long or as much) fails the shape. Returns the number of
+// shapes that failed.
+int stressHarness(const StressSettings &settings, std::ostream &report);
+
+} /* end namespace */
+#endif /* END __LILC_STRESS_HPP__ */
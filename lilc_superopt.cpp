@@ -0,0 +1,1014 @@
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cctype>
+#include <climits>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+
+#include "lilc_superopt.hpp"
+#include "lilc_compiler.hpp"
+#include "lilc_memreport.hpp"
+#include "lilc_unparse.hpp"
+
+namespace LILC{
+
+namespace {
+
+typedef RewriteTerm Term;
+
+// Types are written 'i' and 'b'; '?' for an id not yet known, and for
+// the operands of == and != '=', either as long as both are the same.
+struct OpInfo{
+   const char * name;
+   int arity;
+   char result;
+   char operand;
+};
+
+const OpInfo OPS[Term::OP_COUNT] = {
+   { nullptr, 0, '?', 0 },      // VAR
+   { nullptr, 0, 'i', 0 },      // INT_LIT
+   { "true", 0, 'b', 0 },
+   { "false", 0, 'b', 0 },
+   { "neg", 1, 'i', 'i' },
+   { "!", 1, 'b', 'b' },
+   { "+", 2, 'i', 'i' },
+   { "-", 2, 'i', 'i' },
+   { "*", 2, 'i', 'i' },
+   { "&&", 2, 'b', 'b' },
+   { "||", 2, 'b', 'b' },
+   { "==", 2, 'b', '=' },
+   { "!=", 2, 'b', '=' },
+   { "<", 2, 'b', 'i' },
+   { ">", 2, 'b', 'i' },
+   { "<=", 2, 'b', 'i' },
+   { ">=", 2, 'b', 'i' },
+};
+
+Term term(Term::Op op, int32_t value = 0)
+{
+   Term t;
+   t.op = op;
+   t.value = value;
+   return t;
+}
+
+/* Shapes of ASTs */
+
+Term::Op opOf(NodeKind kind)
+{
+   switch (kind){
+      case UNARY_MINUS_NODE: return Term::NEG;
+      case NOT_NODE: return Term::NOT;
+      case PLUS_NODE: return Term::ADD;
+      case MINUS_NODE: return Term::SUB;
+      case TIMES_NODE: return Term::MUL;
+      case AND_NODE: return Term::AND;
+      case OR_NODE: return Term::OR;
+      case EQUALS_NODE: return Term::EQ;
+      case NOT_EQUALS_NODE: return Term::NE;
+      case LESS_NODE: return Term::LT;
+      case GREATER_NODE: return Term::GT;
+      case LESS_EQ_NODE: return Term::LE;
+      case GREATER_EQ_NODE: return Term::GE;
+      default: return Term::OP_COUNT;
+   }
+}
+
+// Appends exp in prefix form to out, and its ids in order of first
+// appearance to ids; false if exp has anything but ids, literals and
+// the operators of OPS, or more than limit nodes.
+bool shapeOf(ExpNode * exp, RewriteExpr &out, std::vector<IdNode *> &ids,
+size_t limit)
+{
+   if (out.size() >= limit){
+      return false;
+   }
+   switch (exp->kind()){
+      case ID_NODE:
+      {
+         IdNode * id = static_cast<IdNode *>(exp);
+         size_t v = 0;
+         while (v < ids.size() && ids[v]->getName() != id->getName()){
+            v++;
+         }
+         if (v == ids.size()){
+            ids.push_back(id);
+         }
+         out.push_back(term(Term::VAR, (int32_t)v));
+         return true;
+      }
+      case INT_LIT_NODE:
+         out.push_back(term(Term::INT_LIT,
+            static_cast<IntLitNode *>(exp)->getValue()));
+         return true;
+      case TRUE_NODE:
+         out.push_back(term(Term::TRUE_LIT));
+         return true;
+      case FALSE_NODE:
+         out.push_back(term(Term::FALSE_LIT));
+         return true;
+      default:
+         break;
+   }
+   Term::Op op = opOf(exp->kind());
+   if (op == Term::OP_COUNT){
+      return false;
+   }
+   out.push_back(term(op));
+   if (OPS[op].arity == 1){
+      return shapeOf(static_cast<UnaryExpNode *>(exp)->getExp(), out, ids,
+         limit);
+   }
+   BinaryExpNode * binary = static_cast<BinaryExpNode *>(exp);
+   return shapeOf(binary->getExp1(), out, ids, limit)
+      && shapeOf(binary->getExp2(), out, ids, limit);
+}
+
+struct Inference{
+   const RewriteExpr &expr;
+   std::string types;
+   bool ok = true;
+   bool changed = false;
+
+   Inference(const RewriteExpr &e, size_t vars)
+   : expr(e), types(vars, '?') { }
+
+   // The operand at index at, of type have, must be of type want
+   void expect(size_t at, char have, char want){
+      if (have == want){
+         return;
+      }
+      if (have == '?' && expr[at].op == Term::VAR){
+         types[expr[at].value] = want;
+         changed = true;
+      } else {
+         ok = false;
+      }
+   }
+
+   char infer(size_t &i){
+      const Term &t = expr[i++];
+      const OpInfo &info = OPS[t.op];
+      if (t.op == Term::VAR){
+         return types[t.value];
+      }
+      if (info.arity == 0){
+         return info.result;
+      }
+      size_t first = i;
+      char left = infer(i);
+      if (info.arity == 1){
+         expect(first, left, info.operand);
+         return info.result;
+      }
+      size_t second = i;
+      char right = infer(i);
+      char want = info.operand;
+      if (want == '='){
+         want = left != '?' ? left : right;
+         if (want == '?'){
+            return info.result;
+         }
+      }
+      expect(first, left, want);
+      expect(second, right, want);
+      return info.result;
+   }
+};
+
+// The types of expr's vars, as far as its operators tell them; empty
+// if expr would not type-check or some are left unknown.
+std::string typesOf(const RewriteExpr &expr, size_t vars)
+{
+   Inference inference(expr, vars);
+   do {
+      inference.changed = false;
+      size_t i = 0;
+      inference.infer(i);
+   } while (inference.ok && inference.changed);
+   if (!inference.ok
+      || inference.types.find('?') != std::string::npos){
+      return std::string();
+   }
+   return inference.types;
+}
+
+std::string textOf(const RewriteExpr &expr)
+{
+   std::string text;
+   for (const Term &t : expr){
+      if (!text.empty()){
+         text += ' ';
+      }
+      if (t.op == Term::VAR){
+         text += (char)('a' + t.value);
+      } else if (t.op == Term::INT_LIT){
+         text += std::to_string(t.value);
+      } else {
+         text += OPS[t.op].name;
+      }
+   }
+   return text;
+}
+
+std::string shapeText(const RewriteExpr &expr, const std::string &types)
+{
+   return textOf(expr) + " |" + types;
+}
+
+// Reads the prefix form textOf writes; false if text is not one
+bool parseExpr(const std::string &text, RewriteExpr &out)
+{
+   std::istringstream in(text);
+   std::string token;
+   int needed = 1;
+   while (in >> token){
+      if (needed == 0){
+         return false;
+      }
+      needed--;
+      if (token.size() == 1 && token[0] >= 'a' && token[0] <= 'z'){
+         out.push_back(term(Term::VAR, token[0] - 'a'));
+         continue;
+      }
+      if (isdigit((unsigned char)token[0])){
+         out.push_back(term(Term::INT_LIT, (int32_t)atol(token.c_str())));
+         continue;
+      }
+      int op = Term::TRUE_LIT;
+      while (op < Term::OP_COUNT && token != OPS[op].name){
+         op++;
+      }
+      if (op == Term::OP_COUNT){
+         return false;
+      }
+      out.push_back(term((Term::Op)op));
+      needed += OPS[op].arity;
+   }
+   return needed == 0;
+}
+
+ExpNode * build(const RewriteExpr &expr, size_t &i,
+const std::vector<IdNode *> &ids, Span span)
+{
+   const Term &t = expr[i++];
+   ExpNode * node = nullptr;
+   switch (t.op){
+      case Term::VAR:
+      {
+         IdNode * id = ids[t.value];
+         return new IdNode(new IDToken(id->getOffset(), id->getName()));
+      }
+      case Term::INT_LIT:
+         node = new IntLitNode(new IntLitToken(span.offset, t.value));
+         break;
+      case Term::TRUE_LIT: node = new TrueNode(); break;
+      case Term::FALSE_LIT: node = new FalseNode(); break;
+      case Term::NEG:
+         node = new UnaryMinusNode(build(expr, i, ids, span));
+         break;
+      case Term::NOT:
+         node = new NotNode(build(expr, i, ids, span));
+         break;
+      default:
+      {
+         ExpNode * left = build(expr, i, ids, span);
+         ExpNode * right = build(expr, i, ids, span);
+         switch (t.op){
+            case Term::ADD: node = new PlusNode(left, right); break;
+            case Term::SUB: node = new MinusNode(left, right); break;
+            case Term::MUL: node = new TimesNode(left, right); break;
+            case Term::AND: node = new AndNode(left, right); break;
+            case Term::OR: node = new OrNode(left, right); break;
+            case Term::EQ: node = new EqualsNode(left, right); break;
+            case Term::NE: node = new NotEqualsNode(left, right); break;
+            case Term::LT: node = new LessNode(left, right); break;
+            case Term::GT: node = new GreaterNode(left, right); break;
+            case Term::LE: node = new LessEqNode(left, right); break;
+            default: node = new GreaterEqNode(left, right); break;
+         }
+      }
+   }
+   node->setSpan(span);
+   return node;
+}
+
+/* The search */
+
+typedef int32_t Word;
+
+Word wrap(uint32_t value)
+{
+   return (Word)value;
+}
+
+Word applyOp(Term::Op op, Word a, Word b)
+{
+   switch (op){
+      case Term::NEG: return wrap(0u - (uint32_t)a);
+      case Term::NOT: return !a;
+      case Term::ADD: return wrap((uint32_t)a + (uint32_t)b);
+      case Term::SUB: return wrap((uint32_t)a - (uint32_t)b);
+      case Term::MUL: return wrap((uint32_t)a * (uint32_t)b);
+      case Term::AND: return a && b;
+      case Term::OR: return a || b;
+      case Term::EQ: return a == b;
+      case Term::NE: return a != b;
+      case Term::LT: return a < b;
+      case Term::GT: return a > b;
+      case Term::LE: return a <= b;
+      default: return a >= b;
+   }
+}
+
+Word evaluate(const RewriteExpr &expr, size_t &i, const Word * vars)
+{
+   const Term &t = expr[i++];
+   switch (t.op){
+      case Term::VAR: return vars[t.value];
+      case Term::INT_LIT: return t.value;
+      case Term::TRUE_LIT: return 1;
+      case Term::FALSE_LIT: return 0;
+      default: break;
+   }
+   Word a = evaluate(expr, i, vars);
+   Word b = OPS[t.op].arity == 2 ? evaluate(expr, i, vars) : 0;
+   return applyOp(t.op, a, b);
+}
+
+const Word EDGES[] = { 0, 1, -1, 2, INT_MIN, INT_MAX };
+const size_t EDGE_COUNT = sizeof(EDGES) / sizeof(EDGES[0]);
+// Values every int id is verified on. A wrapping int expression is a
+// polynomial with integer coefficients, so two of degree at most 4 that
+// agree on 0..4 for each id agree everywhere (by Newton's forward
+// differences); comparisons also need the ends of the range.
+const Word BASE[] = { -4, -3, -2, -1, 0, 1, 2, 3, 4, INT_MIN, INT_MIN + 1,
+   INT_MAX - 1, INT_MAX };
+const size_t BASE_COUNT = sizeof(BASE) / sizeof(BASE[0]);
+// Bound on the rows of a full combination of test values
+const size_t MAX_COMBINATIONS = 4096;
+
+// Adds to out the value of each subexpression of expr from i that has
+// no ids; sets value to that of the one at i and returns true if it has
+// none itself.
+bool constants(const RewriteExpr &expr, size_t &i, Word &value,
+std::vector<Word> &out)
+{
+   const Term &t = expr[i++];
+   if (t.op == Term::VAR){
+      return false;
+   }
+   const OpInfo &info = OPS[t.op];
+   if (info.arity == 0){
+      size_t at = i - 1;
+      value = evaluate(expr, at, nullptr);
+      out.push_back(value);
+      return true;
+   }
+   Word a = 0, b = 0;
+   bool constant = constants(expr, i, a, out);
+   if (info.arity == 2){
+      constant = constants(expr, i, b, out) && constant;
+   }
+   if (constant){
+      value = applyOp(t.op, a, b);
+      out.push_back(value);
+   }
+   return constant;
+}
+
+// Where k * x or x^p wraps, for the k and p of expressions of up to
+// three operations: x near j * 2^31 / k, and near the p'th roots of
+// 2^31 and 2^32
+const std::vector<Word> & wrapPoints()
+{
+   static std::vector<Word> points;
+   if (!points.empty()){
+      return points;
+   }
+   std::vector<double> near;
+   for (int k = 2; k <= 8; k++){
+      for (int j = -k; j <= k; j++){
+         near.push_back(j * 2147483648.0 / k);
+      }
+   }
+   for (int p = 2; p <= 4; p++){
+      for (double limit : { 2147483648.0, 4294967296.0 }){
+         double root = pow(limit, 1.0 / p);
+         near.push_back(root);
+         near.push_back(-root);
+      }
+   }
+   for (double x : near){
+      for (int d = -2; d <= 2; d++){
+         double v = floor(x) + d;
+         if (v >= INT_MIN && v <= INT_MAX){
+            points.push_back((Word)v);
+         }
+      }
+   }
+   return points;
+}
+
+// The base values, and around each constant c of a and b (and 0): c, -c
+// and their neighbours, each also offset by multiples of 2^30, where 2x
+// or 4x has the other solutions of 2x == 2c or 4x == 4c. Where an id
+// can be multiplied, by * or by appearing more than once, also the
+// points where that wraps.
+std::vector<Word> testValues(const RewriteExpr &a, const RewriteExpr &b)
+{
+   std::vector<Word> found(1, 0);
+   bool scaled = false;
+   for (const RewriteExpr * e : { &a, &b }){
+      size_t i = 0;
+      Word value;
+      constants(*e, i, value, found);
+      std::vector<int> vars;
+      for (const Term &t : *e){
+         scaled = scaled || t.op == Term::MUL || (t.op == Term::VAR
+            && std::find(vars.begin(), vars.end(), t.value) != vars.end());
+         if (t.op == Term::VAR){
+            vars.push_back(t.value);
+         }
+      }
+   }
+   std::vector<Word> values(BASE, BASE + BASE_COUNT);
+   if (scaled){
+      values.insert(values.end(), wrapPoints().begin(), wrapPoints().end());
+   }
+   for (Word c : found){
+      for (Word d : { c, wrap(0u - (uint32_t)c) }){
+         for (int step = -1; step <= 1; step++){
+            for (uint32_t k = 0; k < 4; k++){
+               values.push_back(wrap((uint32_t)d + (uint32_t)step
+                  + (k << 30)));
+            }
+         }
+      }
+   }
+   std::sort(values.begin(), values.end());
+   values.erase(std::unique(values.begin(), values.end()), values.end());
+   return values;
+}
+
+// Rows of inputs every expression is evaluated on to match candidates
+const size_t SAMPLES = 32;
+const size_t RANDOM_CHECKS = 256;
+
+class Search{
+public:
+   Search(const SuperoptSettings &settings)
+   : myInts(std::max(0, std::min(settings.intVars, 8))),
+     myBools(std::max(0, std::min(settings.boolVars, 8))),
+     myMaxCost(std::max(0, settings.maxOperations)),
+     myState(settings.seed),
+     myPools(myMaxCost + 1)
+   {
+      // The edge values, first the same for every id and then shifted
+      // from one id to the next; then small ints, which often coincide;
+      // then any ints
+      for (size_t row = 0; row < SAMPLES; row++){
+         for (int v = 0; v < vars(); v++){
+            Word value = row < EDGE_COUNT * 3
+               ? EDGES[(row + v * (row / EDGE_COUNT)) % EDGE_COUNT]
+               : row < SAMPLES - 8 ? (Word)(next() % 5) - 2 : (Word)next();
+            mySamples.push_back(isBool(v) ? (value & 1) : value);
+         }
+      }
+   }
+
+   void run(RewriteTable &table){
+      myTable = &table;
+      for (int v = 0; v < vars(); v++){
+         leaf(term(Term::VAR, v), isBool(v));
+      }
+      for (int value = 0; value <= 2; value++){
+         leaf(term(Term::INT_LIT, value), false);
+      }
+      leaf(term(Term::TRUE_LIT), true);
+      leaf(term(Term::FALSE_LIT), true);
+      for (int cost = 1; cost <= myMaxCost; cost++){
+         unary(Term::NEG, cost, false);
+         unary(Term::NOT, cost, true);
+         for (int left = 0; left < cost; left++){
+            int right = cost - 1 - left;
+            for (int op = Term::ADD; op < Term::OP_COUNT; op++){
+               const OpInfo &info = OPS[op];
+               if (info.operand == '='){
+                  binary((Term::Op)op, left, right, false, cost);
+                  binary((Term::Op)op, left, right, true, cost);
+               } else {
+                  binary((Term::Op)op, left, right, info.operand == 'b', cost);
+               }
+            }
+         }
+      }
+   }
+
+   size_t enumerated() const { return myEnumerated; }
+   size_t kept() const { return myKept; }
+   size_t collisions() const { return myCollisions; }
+private:
+   // Expressions of one cost and type with no rewrite, and their values
+   // on the samples
+   struct Pool{
+      std::vector<RewriteExpr> exprs;
+      std::vector<Word> values;
+   };
+   struct Best{
+      int cost;
+      bool boolean;
+      size_t index;
+   };
+
+   int vars() const { return myInts + myBools; }
+   bool isBool(int v) const { return v >= myInts; }
+
+   // splitmix64
+   uint64_t next(){
+      uint64_t z = (myState += 0x9e3779b97f4a7c15ULL);
+      z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+      z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+      return z ^ (z >> 31);
+   }
+
+   static uint64_t fingerprint(const Word * values, bool boolean){
+      uint64_t h = boolean ? 0x51 : 0x17;
+      for (size_t row = 0; row < SAMPLES; row++){
+         h = hashCombine(h, (uint32_t)values[row]);
+      }
+      return h;
+   }
+
+   void leaf(const Term &t, bool boolean){
+      std::vector<Word> values(SAMPLES);
+      for (size_t row = 0; row < SAMPLES; row++){
+         RewriteExpr expr(1, t);
+         size_t i = 0;
+         values[row] = evaluate(expr, i, &mySamples[row * vars()]);
+      }
+      consider(RewriteExpr(1, t), values.data(), boolean, 0);
+   }
+
+   void unary(Term::Op op, int cost, bool boolean){
+      const Pool &operands = myPools[cost - 1][boolean];
+      std::vector<Word> values(SAMPLES);
+      for (size_t k = 0; k < operands.exprs.size(); k++){
+         const Word * operand = &operands.values[k * SAMPLES];
+         for (size_t row = 0; row < SAMPLES; row++){
+            values[row] = applyOp(op, operand[row], 0);
+         }
+         considerBuilt(values.data(), boolean, cost, [&](){
+            RewriteExpr expr(1, term(op));
+            expr.insert(expr.end(), operands.exprs[k].begin(),
+               operands.exprs[k].end());
+            return expr;
+         });
+      }
+   }
+
+   void binary(Term::Op op, int leftCost, int rightCost, bool operandsBool,
+   int cost){
+      const Pool &lefts = myPools[leftCost][operandsBool];
+      const Pool &rights = myPools[rightCost][operandsBool];
+      bool boolean = OPS[op].result == 'b';
+      std::vector<Word> values(SAMPLES);
+      for (size_t l = 0; l < lefts.exprs.size(); l++){
+         const Word * left = &lefts.values[l * SAMPLES];
+         for (size_t r = 0; r < rights.exprs.size(); r++){
+            const Word * right = &rights.values[r * SAMPLES];
+            for (size_t row = 0; row < SAMPLES; row++){
+               values[row] = applyOp(op, left[row], right[row]);
+            }
+            considerBuilt(values.data(), boolean, cost, [&](){
+               RewriteExpr expr(1, term(op));
+               expr.insert(expr.end(), lefts.exprs[l].begin(),
+                  lefts.exprs[l].end());
+               expr.insert(expr.end(), rights.exprs[r].begin(),
+                  rights.exprs[r].end());
+               return expr;
+            });
+         }
+      }
+   }
+
+   // Builds the expression only when it is kept or rewritten. Those of
+   // the highest cost are never operands, so are only counted.
+   template <typename Make>
+   void considerBuilt(const Word * values, bool boolean, int cost, Make make){
+      myEnumerated++;
+      uint64_t fp = fingerprint(values, boolean);
+      std::vector<Best> &matches = myBest[fp];
+      bool collided = false;
+      RewriteExpr expr;
+      for (const Best &best : matches){
+         if (best.cost >= cost){
+            continue;
+         }
+         if (expr.empty()){
+            expr = make();
+         }
+         const RewriteExpr &to = myPools[best.cost][best.boolean]
+            .exprs[best.index];
+         if (equivalent(expr, to)){
+            record(expr, to);
+            return;
+         }
+         collided = true;
+      }
+      myKept++;
+      myCollisions += collided;
+      if (cost == myMaxCost){
+         return;
+      }
+      Pool &pool = myPools[cost][boolean];
+      // A second expression with the same values is only worth matching
+      // against when it is not just the same function as the first
+      if (matches.empty() || collided){
+         matches.push_back(Best{ cost, boolean, pool.exprs.size() });
+      }
+      pool.exprs.push_back(expr.empty() ? make() : std::move(expr));
+      pool.values.insert(pool.values.end(), values, values + SAMPLES);
+   }
+
+   void consider(RewriteExpr expr, const Word * values, bool boolean,
+   int cost){
+      considerBuilt(values, boolean, cost, [&](){ return expr; });
+   }
+
+   // Whether a and b agree on every combination of the test values (see
+   // testValues) of the int ids they use and both values of the bools,
+   // and on random inputs. Where there are too many combinations, the
+   // base values are combined and each int id in turn takes the rest.
+   bool equivalent(const RewriteExpr &a, const RewriteExpr &b){
+      std::vector<int> used;
+      for (const RewriteExpr * e : { &a, &b }){
+         for (const Term &t : *e){
+            if (t.op == Term::VAR
+               && std::find(used.begin(), used.end(), t.value) == used.end()){
+               used.push_back(t.value);
+            }
+         }
+      }
+      std::vector<Word> base(BASE, BASE + BASE_COUNT);
+      std::vector<Word> values = testValues(a, b);
+      std::vector<const std::vector<Word> *> domains(used.size());
+      size_t combinations = 1;
+      for (size_t k = 0; k < used.size(); k++){
+         if (!isBool(used[k])){
+            combinations *= values.size();
+         }
+      }
+      std::vector<Word> row(vars(), 0);
+      if (combinations <= MAX_COMBINATIONS){
+         for (size_t k = 0; k < used.size(); k++){
+            domains[k] = &values;
+         }
+         if (!agreeOnAll(a, b, used, domains, row)){
+            return false;
+         }
+      } else {
+         for (size_t wide = 0; wide < used.size(); wide++){
+            if (isBool(used[wide])){
+               continue;
+            }
+            for (size_t k = 0; k < used.size(); k++){
+               domains[k] = k == wide ? &values : &base;
+            }
+            if (!agreeOnAll(a, b, used, domains, row)){
+               return false;
+            }
+         }
+      }
+      for (size_t check = 0; check < RANDOM_CHECKS; check++){
+         for (int v : used){
+            row[v] = isBool(v) ? (Word)(next() & 1) : (Word)next();
+         }
+         if (!agree(a, b, row.data())){
+            return false;
+         }
+      }
+      return true;
+   }
+
+   // Whether a and b agree on every combination of values of the ids
+   // used, the k'th taken from domains[k] if an int
+   bool agreeOnAll(const RewriteExpr &a, const RewriteExpr &b,
+   const std::vector<int> &used,
+   const std::vector<const std::vector<Word> *> &domains,
+   std::vector<Word> &row){
+      std::vector<size_t> digit(used.size(), 0);
+      while (true){
+         for (size_t k = 0; k < used.size(); k++){
+            row[used[k]] = isBool(used[k]) ? (Word)digit[k]
+               : (*domains[k])[digit[k]];
+         }
+         if (!agree(a, b, row.data())){
+            return false;
+         }
+         size_t k = 0;
+         for (; k < used.size(); k++){
+            size_t count = isBool(used[k]) ? 2 : domains[k]->size();
+            if (++digit[k] < count){
+               break;
+            }
+            digit[k] = 0;
+         }
+         if (k == used.size()){
+            return true;
+         }
+      }
+   }
+
+   static bool agree(const RewriteExpr &a, const RewriteExpr &b,
+   const Word * row){
+      size_t i = 0, j = 0;
+      return evaluate(a, i, row) == evaluate(b, j, row);
+   }
+
+   // Renames from's ids in order of first appearance, and to's to match
+   void record(const RewriteExpr &from, const RewriteExpr &to){
+      std::vector<int> rename(vars(), -1);
+      std::string types;
+      RewriteExpr shape = from;
+      for (Term &t : shape){
+         if (t.op == Term::VAR){
+            if (rename[t.value] < 0){
+               rename[t.value] = (int)types.size();
+               types += isBool(t.value) ? 'b' : 'i';
+            }
+            t.value = rename[t.value];
+         }
+      }
+      RewriteExpr replacement = to;
+      for (Term &t : replacement){
+         if (t.op == Term::VAR){
+            if (rename[t.value] < 0){
+               return;
+            }
+            t.value = rename[t.value];
+         }
+      }
+      // The pass only meets shapes whose types it can tell
+      if (typesOf(shape, types.size()) != types){
+         return;
+      }
+      myTable->add(shapeText(shape, types), replacement, shape.size());
+   }
+
+   int myInts;
+   int myBools;
+   int myMaxCost;
+   uint64_t myState;
+   std::vector<Word> mySamples;
+   // By cost, then int (0) or bool (1)
+   std::vector<std::array<Pool, 2> > myPools;
+   // Expressions of different functions that share their values
+   std::unordered_map<uint64_t, std::vector<Best> > myBest;
+   RewriteTable * myTable = nullptr;
+   size_t myEnumerated = 0;
+   size_t myKept = 0;
+   size_t myCollisions = 0;
+};
+
+template <typename Fn>
+double elapsedMs(Fn run)
+{
+   auto start = std::chrono::steady_clock::now();
+   run();
+   auto end = std::chrono::steady_clock::now();
+   return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+size_t operations(ASTNode * root)
+{
+   MemoryReport counts;
+   root->measure(counts);
+   size_t total = 0;
+   for (int kind = UNARY_MINUS_NODE; kind <= GREATER_EQ_NODE; kind++){
+      total += counts.count((NodeKind)kind);
+   }
+   return total;
+}
+
+} /* end anonymous namespace */
+
+void RewriteTable::add(const std::string &shape, const RewriteExpr &to,
+size_t nodes)
+{
+   if (myRewrites.emplace(shape, to).second){
+      myMaxNodes = std::max(myMaxNodes, nodes);
+   }
+}
+
+ExpNode * RewriteTable::apply(ExpNode * exp) const
+{
+   if (myRewrites.empty()){
+      return exp;
+   }
+   RewriteExpr shape;
+   std::vector<IdNode *> ids;
+   if (!shapeOf(exp, shape, ids, myMaxNodes)){
+      return exp;
+   }
+   std::string types = typesOf(shape, ids.size());
+   if (types.size() != ids.size()){
+      return exp;
+   }
+   auto found = myRewrites.find(shapeText(shape, types));
+   if (found == myRewrites.end()){
+      return exp;
+   }
+   myApplied++;
+   size_t i = 0;
+   return build(found->second, i, ids, exp->span());
+}
+
+bool RewriteTable::load(const char * filename, std::ostream &errors)
+{
+   std::ifstream in(filename);
+   if (!in.good()){
+      errors << "cannot open rewrite table " << filename << "\n";
+      return false;
+   }
+   std::string line;
+   size_t number = 0;
+   while (std::getline(in, line)){
+      number++;
+      if (line.empty() || line[0] == '#'){
+         continue;
+      }
+      size_t tab = line.find('\t');
+      size_t bar = line.rfind(" |", tab);
+      RewriteExpr shape, to;
+      if (tab == std::string::npos || bar == std::string::npos
+         || !parseExpr(line.substr(0, bar), shape)
+         || !parseExpr(line.substr(tab + 1), to)){
+         errors << filename << ":" << number << ": not a rewrite\n";
+         return false;
+      }
+      add(line.substr(0, tab), to, shape.size());
+   }
+   return true;
+}
+
+bool RewriteTable::save(const char * filename) const
+{
+   std::vector<std::string> lines;
+   for (const auto &rewrite : myRewrites){
+      lines.push_back(rewrite.first + "\t" + textOf(rewrite.second));
+   }
+   std::sort(lines.begin(), lines.end());
+   std::ofstream out(filename);
+   out << "# Rewrites found by P3 --superopt-search; see lilc_superopt.hpp\n";
+   for (const std::string &line : lines){
+      out << line << "\n";
+   }
+   return out.good();
+}
+
+int superoptimizerSearch(const SuperoptSettings &settings,
+const char * tablefile, std::ostream &report)
+{
+   RewriteTable table;
+   Search search(settings);
+   double ms = elapsedMs([&](){ search.run(table); });
+   report << search.enumerated() << " expressions of up to "
+      << settings.maxOperations << " operations over "
+      << settings.intVars << " int and " << settings.boolVars
+      << " bool ids, " << search.kept() << " without a rewrite; "
+      << table.size() << " rewrites, " << search.collisions()
+      << " sample collisions, " << ms << " ms\n";
+   if (!table.save(tablefile)){
+      report << "cannot write " << tablefile << "\n";
+      return 1;
+   }
+   return 0;
+}
+
+int superoptimizerCheck(const char * tablefile, std::ostream &report)
+{
+   std::ifstream in(tablefile);
+   if (!in.good()){
+      report << "cannot open rewrite table " << tablefile << "\n";
+      return 1;
+   }
+   // Not the search's test values, so that a gap in those shows here
+   std::vector<Word> wide;
+   for (Word v = -32; v <= 32; v++){
+      wide.push_back(v);
+   }
+   for (uint32_t k = 1; k < 16; k++){
+      for (int d = -3; d <= 3; d++){
+         wide.push_back(wrap((k << 28) + (uint32_t)d));
+      }
+   }
+   std::sort(wide.begin(), wide.end());
+   wide.erase(std::unique(wide.begin(), wide.end()), wide.end());
+
+   std::string line;
+   size_t number = 0, checked = 0, rows = 0;
+   int wrong = 0;
+   while (std::getline(in, line)){
+      number++;
+      if (line.empty() || line[0] == '#'){
+         continue;
+      }
+      size_t tab = line.find('\t');
+      size_t bar = line.rfind(" |", tab);
+      RewriteExpr shape, to;
+      if (tab == std::string::npos || bar == std::string::npos
+         || !parseExpr(line.substr(0, bar), shape)
+         || !parseExpr(line.substr(tab + 1), to)){
+         report << tablefile << ":" << number << ": not a rewrite\n";
+         return 1;
+      }
+      std::string types = line.substr(bar + 2, tab - bar - 2);
+      checked++;
+      std::vector<Word> row(types.size(), 0);
+      std::vector<size_t> digit(types.size(), 0);
+      while (true){
+         for (size_t v = 0; v < types.size(); v++){
+            row[v] = types[v] == 'b' ? (Word)digit[v] : wide[digit[v]];
+         }
+         rows++;
+         size_t i = 0, j = 0;
+         if (evaluate(shape, i, row.data()) != evaluate(to, j, row.data())){
+            report << tablefile << ":" << number << ": " << line
+               << " is wrong at";
+            for (size_t v = 0; v < types.size(); v++){
+               report << " " << (char)('a' + v) << "=" << row[v];
+            }
+            report << "\n";
+            wrong++;
+            break;
+         }
+         size_t v = 0;
+         for (; v < types.size(); v++){
+            size_t count = types[v] == 'b' ? 2 : wide.size();
+            if (++digit[v] < count){
+               break;
+            }
+            digit[v] = 0;
+         }
+         if (v == types.size()){
+            break;
+         }
+      }
+   }
+   report << checked << " rewrites checked on " << rows << " rows of "
+      << wide.size() << " int values, " << wrong << " wrong\n";
+   return wrong == 0 ? 0 : 1;
+}
+
+int superoptimizerReport(const char * tablefile, const char * const * files,
+int count, std::ostream &report)
+{
+   RewriteTable table;
+   if (!table.load(tablefile, report)){
+      return 1;
+   }
+   size_t before = 0, after = 0;
+   double plainMs = 0, rewritingMs = 0;
+   int failed = 0;
+   for (int f = 0; f < count; f++){
+      LilC_Compiler plain, rewriting;
+      plain.setDiagnosticsStream(&report);
+      rewriting.setDiagnosticsStream(&report);
+      rewriting.setRewriteTable(&table);
+      bool parsed = true;
+      plainMs += elapsedMs([&](){ parsed = plain.buildAST(files[f]); });
+      rewritingMs += elapsedMs([&](){
+         parsed = rewriting.buildAST(files[f]) && parsed;
+      });
+      if (!parsed){
+         failed++;
+         continue;
+      }
+      before += operations(plain.getASTRoot());
+      after += operations(rewriting.getASTRoot());
+
+      // The rewritten AST must unparse to text that parses back to it
+      LilC_Compiler again;
+      again.setDiagnosticsStream(&report);
+      if (!again.buildAST(unparseExact(rewriting.getASTRoot()))
+         || !again.getASTRoot()->equals(rewriting.getASTRoot())){
+         report << files[f] << ": rewritten program does not round-trip\n";
+         failed++;
+      }
+   }
+   report << count << " files, " << table.size() << " rewrites in the table, "
+      << table.applied() << " applied\n"
+      << "operations: " << before << " before, " << after << " after ("
+      << (before == 0 ? 0 : 100.0 * (before - after) / before)
+      << "% fewer)\n"
+      << "parse: " << plainMs << " ms, " << rewritingMs
+      << " ms with the rewrites\n";
+   return failed == 0 ? 0 : 1;
+}
+
+} /* end namespace */
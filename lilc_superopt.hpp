@@ -0,0 +1,97 @@
+#ifndef __LILC_SUPEROPT_HPP__
+#define __LILC_SUPEROPT_HPP__ 1
+
+#include <string>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <unordered_map>
+
+#include "ast.hpp"
+
+namespace LILC{
+
+// Expression superoptimizer. Rewrites of side-effect-free int and bool
+// expressions (ids, int literals, true, false and every operator but /)
+// to equivalents with fewer operations, looked up by shape.
+//
+// A shape is the expression in prefix form with its ids renamed a, b,
+// c... in order of first appearance, followed by their types, e.g.
+// "+ a 0 |i" or "|| ! a a |b". The types of ids come from the
+// operators they appear under; an expression whose ids' types cannot
+// all be told, or that would not type-check, has no shape. Arithmetic
+// wraps at 32 bits, as the engine's does (see lilc_engine.hpp).
+
+struct RewriteTerm{
+   enum Op : uint8_t { VAR, INT_LIT, TRUE_LIT, FALSE_LIT, NEG, NOT, ADD,
+      SUB, MUL, AND, OR, EQ, NE, LT, GT, LE, GE, OP_COUNT };
+   Op op;
+   // The variable's index, or the int literal's value
+   int32_t value;
+};
+
+// In prefix order
+typedef std::vector<RewriteTerm> RewriteExpr;
+
+class RewriteTable{
+public:
+   // Reads a table written by superoptimizerSearch; reports why not to
+   // errors and returns false if it cannot.
+   bool load(const char * filename, std::ostream &errors);
+   bool save(const char * filename) const;
+
+   // Records that shape (see above) can be replaced by to, in which
+   // variable i is the shape's i'th id.
+   void add(const std::string &shape, const RewriteExpr &to, size_t nodes);
+   size_t size() const { return myRewrites.size(); }
+
+   // exp, or a cheaper equivalent built from new nodes if there is a
+   // rewrite for its shape. Called by the parser on each operator node
+   // as it is built, so exp's operands have been rewritten already.
+   ExpNode * apply(ExpNode * exp) const;
+   size_t applied() const { return myApplied; }
+private:
+   std::unordered_map<std::string, RewriteExpr> myRewrites;
+   // Nodes in the largest shape; larger expressions are not looked up
+   size_t myMaxNodes = 0;
+   mutable size_t myApplied = 0;
+};
+
+struct SuperoptSettings{
+   // Bound on the operations of the expressions enumerated
+   int maxOperations = 2;
+   int intVars = 3;
+   int boolVars = 2;
+   uint64_t seed = 1;
+};
+
+// Offline search (--superopt-search). Enumerates the int and bool
+// expressions over settings' ids and the literals 0, 1, 2, true and
+// false in order of their operation count, and writes to tablefile a
+// rewrite of each that has an equivalent with fewer operations to the
+// first such equivalent found. Candidates are matched by their values
+// on a fixed sample of inputs and then verified, by evaluation over
+// combinations of test values for the ints (-4..4, the ends of the
+// range and their neighbours, and each constant subexpression's value
+// and its negation, +-1 and offset by multiples of 2^30) and of both
+// values for the bools, and over random 32-bit ints. Expressions are
+// only built from operands that have no rewrite, since the table is
+// applied bottom-up and never meets the others.
+int superoptimizerSearch(const SuperoptSettings &settings,
+   const char * tablefile, std::ostream &report);
+
+// Replays every rewrite of tablefile (--superopt-check) on each
+// combination of a wide set of ints, independent of the search's own,
+// for its int ids and of both values for its bools; reports and returns
+// 1 if any rewrite changes a value.
+int superoptimizerCheck(const char * tablefile, std::ostream &report);
+
+// Parses each of files with and without the rewrites of tablefile
+// (--superopt-report) and reports the operations in their ASTs, the
+// reduction, and the parse times.
+int superoptimizerReport(const char * tablefile, const char * const * files,
+   int count, std::ostream &report);
+
+} /* end namespace */
+#endif /* END __LILC_SUPEROPT_HPP__ */
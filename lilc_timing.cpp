@@ -0,0 +1,13 @@
+#include <cstdlib>
+
+#include "lilc_timing.hpp"
+
+namespace LILC{
+
+const char * tempDir()
+{
+   const char * dir = getenv("TMPDIR");
+   return dir != nullptr && dir[0] != '\0' ? dir : "/tmp";
+}
+
+} /* end namespace */
@@ -0,0 +1,34 @@
+#ifndef __LILC_TIMING_HPP__
+#define __LILC_TIMING_HPP__ 1
+
+#include <chrono>
+#include <vector>
+#include <algorithm>
+
+namespace LILC{
+
+// Helpers shared by the benchmarks and budget checks; the performance
+// gate itself is lilc_bench.hpp.
+
+// Calls run() rounds times and returns the median wall time of a call,
+// in milliseconds.
+template <typename Fn>
+double medianMs(int rounds, Fn run)
+{
+   std::vector<double> times;
+   for (int i = 0; i < rounds; i++){
+      auto start = std::chrono::steady_clock::now();
+      run();
+      auto end = std::chrono::steady_clock::now();
+      times.push_back(
+         std::chrono::duration<double, std::milli>(end - start).count());
+   }
+   std::sort(times.begin(), times.end());
+   return times[times.size() / 2];
+}
+
+// Directory for temporary files: $TMPDIR if set, else /tmp.
+const char * tempDir();
+
+} /* end namespace */
+#endif /* END __LILC_TIMING_HPP__ */
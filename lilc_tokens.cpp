@@ -0,0 +1,154 @@
+#include <limits>
+#include <fstream>
+#include <iostream>
+
+#include "lilc_tokens.hpp"
+#include "lilc_timing.hpp"
+#include "lilc_compiler.hpp"
+
+using TokenTag = LILC::LilC_Parser::token;
+
+namespace LILC{
+
+bool TokenArray::lex(std::istream &in, Diagnostics * diagnostics,
+const LineIndex * lines)
+{
+   myTokens.clear();
+   myChars.clear();
+   LilC_Scanner scanner(&in, diagnostics, lines);
+   LilC_Parser::semantic_type lval;
+   while (true){
+      lval.symbolValue = nullptr;
+      int tag = scanner.yylex(&lval);
+      if (scanner.tokenOffset() > std::numeric_limits<uint32_t>::max()
+         || myChars.size() > std::numeric_limits<uint32_t>::max()){
+         // Leave an empty array, which still ends with END
+         delete(lval.symbolValue);
+         if (diagnostics != nullptr){
+            scanner.error("Input too large for a token array");
+         }
+         myTokens.clear();
+         myChars.clear();
+         myTokens.push_back(TokenRecord{ TokenTag::END, 0, 0, 0 });
+         return false;
+      }
+      TokenRecord tok;
+      tok.tag = tag;
+      tok.offset = tag == TokenTag::END ? scanner.tokenOffset()
+         + scanner.tokenLength() : scanner.tokenOffset();
+      tok.length = tag == TokenTag::END ? 0 : scanner.tokenLength();
+      tok.payload = 0;
+      if (tag == TokenTag::ID){
+         tok.payload = myChars.size();
+         myChars += ((IDToken *)lval.symbolValue)->value();
+      } else if (tag == TokenTag::STRINGLITERAL){
+         tok.payload = myChars.size();
+         myChars += ((StringLitToken *)lval.symbolValue)->value();
+      } else if (tag == TokenTag::INTLITERAL){
+         tok.payload = (uint32_t)((IntLitToken *)lval.symbolValue)->value();
+      }
+      delete(lval.symbolValue);
+      myTokens.push_back(tok);
+      if (tag == TokenTag::END){
+         break;
+      }
+   }
+   myTokens.shrink_to_fit();
+   return true;
+}
+
+SynSymbol * TokenArray::symbol(size_t i) const
+{
+   const TokenRecord &tok = myTokens[i];
+   switch (tok.tag){
+   case TokenTag::ID:
+      return new IDToken(tok.offset, text(i));
+   case TokenTag::STRINGLITERAL:
+      return new StringLitToken(tok.offset, text(i));
+   case TokenTag::INTLITERAL:
+      return new IntLitToken(tok.offset, intValue(i));
+   case TokenTag::END:
+      return nullptr;
+   default:
+      return new NullaryToken(tok.offset, tok.tag);
+   }
+}
+
+int TokenArrayScanner::yylex( LILC::LilC_Parser::semantic_type * const lval)
+{
+   if (myNext >= myLast){
+      // At the end of the array the END token gives the end of input;
+      // at the end of a range, input ends just after its last token.
+      if (myLast == myTokens.size() - 1){
+         offset = myTokens[myLast].offset;
+      }
+      tokenStart = offset;
+      lval->symbolValue = nullptr;
+      return TokenTag::END;
+   }
+   const TokenRecord &tok = myTokens[myNext];
+   lval->symbolValue = myTokens.symbol(myNext++);
+   tokenStart = tok.offset;
+   offset = tok.offset + tok.length;
+   return tok.tag;
+}
+
+int tokenArrayBenchmark(const char * filename, std::ostream &report)
+{
+   std::ifstream in(filename);
+   if (!in.good()){
+      report << "cannot open " << filename << "\n";
+      return 1;
+   }
+   std::string text((std::istreambuf_iterator<char>(in)),
+      std::istreambuf_iterator<char>());
+   const int rounds = 9;
+
+   TokenArray tokens;
+   Diagnostics quiet;
+   auto lex = [&](){
+      MemoryStreamBuf buf(text.data(), text.size());
+      std::istream stream(&buf);
+      quiet.clear();
+      tokens.lex(stream, &quiet);
+   };
+   {
+      MemoryStreamBuf buf(text.data(), text.size());
+      std::istream stream(&buf);
+      if (!tokens.lex(stream, &quiet)){
+         report << filename << " is too large for a token array\n";
+         return 1;
+      }
+   }
+   report << text.size() << " bytes, " << tokens.size() << " tokens, "
+      << tokens.bytes() << " bytes of token array\n";
+
+   struct Pass{
+      const char * name;
+      double median;
+   };
+   const Pass passes[] = {
+      { "interleaved parse", medianMs(rounds, [&](){
+         LilC_Compiler compiler;
+         compiler.buildAST(text);
+      }) },
+      { "lex to array", medianMs(rounds, lex) },
+      { "parse from array", medianMs(rounds, [&](){
+         LilC_Compiler compiler;
+         compiler.buildAST(tokens, nullptr);
+      }) },
+      { "lex then parse", medianMs(rounds, [&](){
+         LilC_Compiler compiler;
+         compiler.setTokenArrayMode(true);
+         compiler.buildAST(text);
+      }) },
+   };
+   for (const Pass &pass : passes){
+      report << pass.name << ": median " << pass.median << " ms, "
+         << (text.size() / 1e6) / (pass.median / 1e3) << " MB/s ("
+         << rounds << " rounds)\n";
+   }
+   return 0;
+}
+
+} /* end namespace */
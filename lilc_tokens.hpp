@@ -0,0 +1,99 @@
+#ifndef __LILC_TOKENS_HPP__
+#define __LILC_TOKENS_HPP__ 1
+
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <istream>
+#include <ostream>
+#include <cstdint>
+
+#include "lilc_scanner.hpp"
+#include "lilc_diagnostics.hpp"
+#include "lilc_source.hpp"
+#include "symbols.hpp"
+
+namespace LILC{
+
+// One token of a TokenArray in 16 bytes: the tag the scanner returned
+// and the bytes of the source it covers. payload is the value of an
+// INTLITERAL, or where the text of an ID or STRINGLITERAL (length bytes,
+// as in the source) starts in the array's character pool; other tokens
+// leave it 0. Offsets are 32 bits, as in Span.
+struct TokenRecord{
+   int32_t tag;
+   uint32_t offset;
+   uint32_t length;
+   uint32_t payload;
+};
+
+// A whole input lexed up front into one contiguous array, ending with
+// an END token. Any token can be looked at in O(1) without lexing again,
+// and the parser can be driven from it by a TokenArrayScanner.
+class TokenArray{
+public:
+   // Lexes the whole of in, replacing the current contents. Lexical
+   // errors go to diagnostics, with positions from lines if given.
+   // Returns false, leaving only the END token, if an offset in the input
+   // or the character pool does not fit in 32 bits.
+   bool lex(std::istream &in, Diagnostics * diagnostics,
+      const LineIndex * lines = nullptr);
+
+   size_t size() const { return myTokens.size(); }
+   const TokenRecord & operator[](size_t i) const { return myTokens[i]; }
+   const TokenRecord * begin() const { return myTokens.data(); }
+   const TokenRecord * end() const { return myTokens.data() + size(); }
+
+   int intValue(size_t i) const { return (int32_t)myTokens[i].payload; }
+   // Text of an ID or STRINGLITERAL token
+   std::string text(size_t i) const {
+      return myChars.substr(myTokens[i].payload, myTokens[i].length);
+   }
+   // A new semantic value for token i, the same as the scanner made
+   SynSymbol * symbol(size_t i) const;
+
+   // Heap bytes held by the array and its character pool
+   size_t bytes() const {
+      return myTokens.capacity() * sizeof(TokenRecord) + myChars.capacity();
+   }
+private:
+   std::vector<TokenRecord> myTokens;
+   std::string myChars;
+};
+
+// Feeds a TokenArray to LilC_Parser in place of the flex scanner, one
+// token per call from a cursor. Only tokens [first, last) are fed when a
+// range is given, followed by END. Positions and spans are those of the
+// original input.
+class TokenArrayScanner : public LilC_Scanner{
+public:
+   TokenArrayScanner(const TokenArray &tokens, Diagnostics * diagnostics,
+      const LineIndex * lines = nullptr, size_t first = 0,
+      size_t last = (size_t)-1)
+   : LilC_Scanner(nullptr, diagnostics, lines), myTokens(tokens)
+   {
+      // An array that lex() did not fill has no END token, and is fed
+      // as empty input
+      myLast = tokens.size() == 0 ? 0 : std::min(last, tokens.size() - 1);
+      myNext = std::min(first, myLast);
+      offset = myNext < tokens.size() ? tokens[myNext].offset : 0;
+   };
+
+   using LilC_Scanner::yylex;
+   int yylex( LILC::LilC_Parser::semantic_type * const lval) override;
+
+   // Index of the next token to be returned
+   size_t cursor() const { return myNext; }
+private:
+   const TokenArray &myTokens;
+   size_t myNext;
+   size_t myLast;
+};
+
+// Parses filename repeatedly, with the scanner interleaved with the
+// parser and from a TokenArray lexed beforehand, and reports the median
+// time and throughput of each way and of its phases.
+int tokenArrayBenchmark(const char * filename, std::ostream &report);
+
+} /* end namespace */
+#endif /* END __LILC_TOKENS_HPP__ */
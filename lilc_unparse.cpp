@@ -0,0 +1,99 @@
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "lilc_unparse.hpp"
+
+namespace LILC{
+
+void unparseCached(ASTNode * root, std::ostream &out)
+{
+   StreamSink sink(out, true);
+   root->render(sink, 0);
+}
+
+std::string unparseExact(ASTNode * root)
+{
+   CountingSink counter;
+   root->render(counter, 0);
+   std::string text(counter.count(), '\0');
+   RawSink sink(&text[0]);
+   root->render(sink, 0);
+   return text;
+}
+
+namespace {
+
+// Output up to this size is rendered on the stack and written with one
+// write(), which also works for pipes and devices; see SMALL_INPUT in
+// lilc_source.cpp.
+const size_t SMALL_OUTPUT = 64 << 10;
+
+bool writeSmall(ASTNode * root, size_t size, const char * filename)
+{
+   char text[SMALL_OUTPUT];
+   RawSink sink(text);
+   root->render(sink, 0);
+   // Not O_TRUNC: when the file is already this size, as when the same
+   // input is compiled again, truncating and regrowing it costs more than
+   // the rest of a short run.
+   int fd = open(filename, O_WRONLY | O_CREAT, 0666);
+   if (fd < 0){
+      return false;
+   }
+   struct stat info;
+   bool regular = fstat(fd, &info) == 0 && S_ISREG(info.st_mode);
+   size_t done = 0;
+   while (done < size){
+      ssize_t n = write(fd, text + done, size - done);
+      if (n < 0 && errno == EINTR){ continue; }
+      if (n <= 0){
+         close(fd);
+         return false;
+      }
+      done += n;
+   }
+   if (regular && (size_t)info.st_size != size && ftruncate(fd, size) != 0){
+      close(fd);
+      return false;
+   }
+   return close(fd) == 0;
+}
+
+} /* end anonymous namespace */
+
+bool unparseToFile(ASTNode * root, const char * filename)
+{
+   CountingSink counter;
+   root->render(counter, 0);
+   size_t size = counter.count();
+   if (size <= SMALL_OUTPUT){
+      return writeSmall(root, size, filename);
+   }
+   int fd = open(filename, O_RDWR | O_CREAT, 0666);
+   if (fd < 0){
+      return false;
+   }
+   struct stat info;
+   if (fstat(fd, &info) != 0 || !S_ISREG(info.st_mode)){
+      close(fd);
+      return false;
+   }
+   if (ftruncate(fd, size) != 0){
+      close(fd);
+      return false;
+   }
+   void * mapped = mmap(nullptr, size, PROT_WRITE, MAP_SHARED, fd, 0);
+   close(fd);
+   if (mapped == MAP_FAILED){
+      return false;
+   }
+   RawSink sink((char *)mapped);
+   root->render(sink, 0);
+   munmap(mapped, size);
+   return true;
+}
+
+} /* end namespace */
@@ -0,0 +1,127 @@
+#ifndef __LILC_UNPARSE_HPP__
+#define __LILC_UNPARSE_HPP__ 1
+
+#include <string>
+#include <cstdio>
+#include <cstring>
+#include <ostream>
+
+#include "ast.hpp"
+
+namespace LILC{
+
+// Sinks for ASTNode::render. Each takes text through operator<<, as an
+// std::ostream would; render is instantiated for these three only. Fixed
+// text is only ever a string literal, so its length is known at compile
+// time.
+
+// Decimal text of value in buf; returns its length.
+inline size_t formatInt(int value, char (&buf)[12])
+{
+   return snprintf(buf, sizeof(buf), "%d", value);
+}
+
+// With reuseRendered, FnDeclNode and StructDeclNode write the text they
+// cached the last time they were unparsed at the same indent, rendering
+// it first if they have none; see unparseCached().
+class StreamSink{
+public:
+   explicit StreamSink(std::ostream &out, bool reuseRendered = false)
+   : myOut(out), myReuse(reuseRendered) { }
+   bool reuseRendered() const { return myReuse; }
+   template <size_t N>
+   StreamSink & operator<<(const char (&text)[N]){
+      myOut.write(text, N - 1);
+      return *this;
+   }
+   StreamSink & operator<<(const std::string &text){
+      myOut << text;
+      return *this;
+   }
+   StreamSink & operator<<(int value){
+      myOut << value;
+      return *this;
+   }
+private:
+   std::ostream &myOut;
+   bool myReuse;
+};
+
+// Only counts the bytes it is given.
+class CountingSink{
+public:
+   bool reuseRendered() const { return false; }
+   template <size_t N>
+   CountingSink & operator<<(const char (&text)[N]){
+      myCount += N - 1;
+      return *this;
+   }
+   CountingSink & operator<<(const std::string &text){
+      myCount += text.size();
+      return *this;
+   }
+   CountingSink & operator<<(int value){
+      char buf[12];
+      myCount += formatInt(value, buf);
+      return *this;
+   }
+   size_t count() const { return myCount; }
+private:
+   size_t myCount = 0;
+};
+
+// Copies bytes to consecutive addresses from start, with no bounds
+// checks: the caller sized the space with a CountingSink first.
+class RawSink{
+public:
+   explicit RawSink(char * start) : myCur(start) { }
+   bool reuseRendered() const { return false; }
+   template <size_t N>
+   RawSink & operator<<(const char (&text)[N]){
+      memcpy(myCur, text, N - 1);
+      myCur += N - 1;
+      return *this;
+   }
+   RawSink & operator<<(const std::string &text){
+      memcpy(myCur, text.data(), text.size());
+      myCur += text.size();
+      return *this;
+   }
+   RawSink & operator<<(int value){
+      char buf[12];
+      size_t len = formatInt(value, buf);
+      memcpy(myCur, buf, len);
+      myCur += len;
+      return *this;
+   }
+   char * position() const { return myCur; }
+private:
+   char * myCur;
+};
+
+// Instantiated in unparse.cpp
+extern template void ASTNode::render(StreamSink& out, int indent);
+extern template void ASTNode::render(CountingSink& out, int indent);
+extern template void ASTNode::render(RawSink& out, int indent);
+
+// Unparses root to out, copying the cached text of every function and
+// struct declaration that has not been modified since it was last
+// unparsed this way; only new and modified ones are rendered. For
+// services that unparse the same program again after small edits (an
+// IncrementalDocument keeps the DeclNodes an edit does not touch).
+void unparseCached(ASTNode * root, std::ostream &out);
+
+// Unparses root in two passes, counting the bytes and then writing them
+// into a string allocated once at exactly that size.
+std::string unparseExact(ASTNode * root);
+
+// As unparseExact, but straight into filename. Up to 64 KiB of output
+// is rendered into a buffer on the stack and written with one write();
+// more, and the file is truncated to the exact size and the second pass
+// writes into its mapped pages. Returns false if the output is large and
+// filename is not a regular file that can be mapped (a pipe or a device,
+// say), for the caller to write it some other way.
+bool unparseToFile(ASTNode * root, const char * filename);
+
+} /* end namespace */
+#endif /* END __LILC_UNPARSE_HPP__ */
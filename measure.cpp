@@ -0,0 +1,210 @@
+#include "ast.hpp"
+#include "lilc_memreport.hpp"
+
+// measure tallies the heap behind each node for --mem-report, see
+// lilc_memreport.hpp. Literal tokens are counted with the other tokens,
+// not with the nodes that point at them.
+
+namespace LILC{
+
+void ProgramNode::measure(MemoryReport& report){
+	report.node(PROGRAM_NODE, sizeof(ProgramNode));
+	myDeclList->measure(report);
+}
+
+void DeclListNode::measure(MemoryReport& report){
+	report.node(DECL_LIST_NODE, sizeof(DeclListNode));
+	report.list(DECL_LIST_NODE, myDecls.size());
+	for (DeclNode * decl : myDecls){
+		decl->measure(report);
+	}
+}
+
+void ExpListNode::measure(MemoryReport& report){
+	report.node(EXP_LIST_NODE, sizeof(ExpListNode));
+	report.list(EXP_LIST_NODE, myExpList.size());
+	for (ExpNode * exp : myExpList){
+		exp->measure(report);
+	}
+}
+
+void VarDeclNode::measure(MemoryReport& report){
+	report.node(VAR_DECL_NODE, sizeof(VarDeclNode));
+	myType->measure(report);
+	myId->measure(report);
+}
+
+void StructDeclNode::measure(MemoryReport& report){
+	report.node(STRUCT_DECL_NODE, sizeof(StructDeclNode));
+	report.string(STRUCT_DECL_NODE, myRendered.text);
+	myId->measure(report);
+	myDeclList->measure(report);
+}
+
+void FormalDeclNode::measure(MemoryReport& report){
+	report.node(FORMAL_DECL_NODE, sizeof(FormalDeclNode));
+	myType->measure(report);
+	myId->measure(report);
+}
+
+void FormalsListNode::measure(MemoryReport& report){
+	report.node(FORMALS_LIST_NODE, sizeof(FormalsListNode));
+	report.list(FORMALS_LIST_NODE, myFormalDeclList.size());
+	for (FormalDeclNode * formal : myFormalDeclList){
+		formal->measure(report);
+	}
+}
+
+void FnDeclNode::measure(MemoryReport& report){
+	report.node(FN_DECL_NODE, sizeof(FnDeclNode));
+	report.string(FN_DECL_NODE, myRendered.text);
+	myType->measure(report);
+	myId->measure(report);
+	myFormalsList->measure(report);
+	myFnBody->measure(report);
+}
+
+void FnBodyNode::measure(MemoryReport& report){
+	report.node(FN_BODY_NODE, sizeof(FnBodyNode));
+	myDeclList->measure(report);
+	myStmtList->measure(report);
+}
+
+void StmtListNode::measure(MemoryReport& report){
+	report.node(STMT_LIST_NODE, sizeof(StmtListNode));
+	report.list(STMT_LIST_NODE, myStmtList.size());
+	for (StmtNode * stmt : myStmtList){
+		stmt->measure(report);
+	}
+}
+
+void IdNode::measure(MemoryReport& report){
+	report.node(ID_NODE, sizeof(IdNode));
+	report.string(ID_NODE, myStrVal);
+}
+
+void IntNode::measure(MemoryReport& report){
+	report.node(INT_NODE, sizeof(IntNode));
+}
+
+void BoolNode::measure(MemoryReport& report){
+	report.node(BOOL_NODE, sizeof(BoolNode));
+}
+
+void VoidNode::measure(MemoryReport& report){
+	report.node(VOID_NODE, sizeof(VoidNode));
+}
+
+void StructNode::measure(MemoryReport& report){
+	report.node(STRUCT_NODE, sizeof(StructNode));
+	myId->measure(report);
+}
+
+void AssignStmtNode::measure(MemoryReport& report){
+	report.node(ASSIGN_STMT_NODE, sizeof(AssignStmtNode));
+	myAssignNode->measure(report);
+}
+
+void PostIncStmtNode::measure(MemoryReport& report){
+	report.node(POST_INC_STMT_NODE, sizeof(PostIncStmtNode));
+	myExp->measure(report);
+}
+
+void PostDecStmtNode::measure(MemoryReport& report){
+	report.node(POST_DEC_STMT_NODE, sizeof(PostDecStmtNode));
+	myExp->measure(report);
+}
+
+void ReadStmtNode::measure(MemoryReport& report){
+	report.node(READ_STMT_NODE, sizeof(ReadStmtNode));
+	myExp->measure(report);
+}
+
+void WriteStmtNode::measure(MemoryReport& report){
+	report.node(WRITE_STMT_NODE, sizeof(WriteStmtNode));
+	myExp->measure(report);
+}
+
+void IfStmtNode::measure(MemoryReport& report){
+	report.node(IF_STMT_NODE, sizeof(IfStmtNode));
+	myExp->measure(report);
+	myDeclList->measure(report);
+	myStmtList->measure(report);
+}
+
+void IfElseStmtNode::measure(MemoryReport& report){
+	report.node(IF_ELSE_STMT_NODE, sizeof(IfElseStmtNode));
+	myExp->measure(report);
+	myDeclList1->measure(report);
+	myStmtList1->measure(report);
+	myDeclList2->measure(report);
+	myStmtList2->measure(report);
+}
+
+void WhileStmtNode::measure(MemoryReport& report){
+	report.node(WHILE_STMT_NODE, sizeof(WhileStmtNode));
+	myExp->measure(report);
+	myDeclList->measure(report);
+	myStmtList->measure(report);
+}
+
+void CallStmtNode::measure(MemoryReport& report){
+	report.node(CALL_STMT_NODE, sizeof(CallStmtNode));
+	myCallExpNode->measure(report);
+}
+
+void ReturnStmtNode::measure(MemoryReport& report){
+	report.node(RETURN_STMT_NODE, sizeof(ReturnStmtNode));
+	if (myExp != nullptr){
+		myExp->measure(report);
+	}
+}
+
+void AssignNode::measure(MemoryReport& report){
+	report.node(ASSIGN_NODE, sizeof(AssignNode));
+	myExpNode1->measure(report);
+	myExpNode2->measure(report);
+}
+
+void DotAccessNode::measure(MemoryReport& report){
+	report.node(DOT_ACCESS_NODE, sizeof(DotAccessNode));
+	myExp->measure(report);
+	myId->measure(report);
+}
+
+void CallExpNode::measure(MemoryReport& report){
+	report.node(CALL_EXP_NODE, sizeof(CallExpNode));
+	myId->measure(report);
+	myExpList->measure(report);
+}
+
+void IntLitNode::measure(MemoryReport& report){
+	report.node(INT_LIT_NODE, sizeof(IntLitNode));
+}
+
+void StrLitNode::measure(MemoryReport& report){
+	report.node(STR_LIT_NODE, sizeof(StrLitNode));
+}
+
+void TrueNode::measure(MemoryReport& report){
+	report.node(TRUE_NODE, sizeof(TrueNode));
+}
+
+void FalseNode::measure(MemoryReport& report){
+	report.node(FALSE_NODE, sizeof(FalseNode));
+}
+
+// The operator subclasses add no fields, so the base class size is
+// theirs too.
+void BinaryExpNode::measure(MemoryReport& report){
+	report.node(kind(), sizeof(BinaryExpNode));
+	myExp1->measure(report);
+	myExp2->measure(report);
+}
+
+void UnaryExpNode::measure(MemoryReport& report){
+	report.node(kind(), sizeof(UnaryExpNode));
+	myExp->measure(report);
+}
+
+} // End namespace LIL' C
@@ -0,0 +1,309 @@
+#include "ast.hpp"
+#include "lilc_minify.hpp"
+
+// minify writes the smallest text that parses back into the same tree,
+// see lilc_minify.hpp.
+
+namespace LILC{
+
+void ProgramNode::minify(Minifier& out){
+	myDeclList->minify(out);
+}
+
+void DeclListNode::minify(Minifier& out){
+	for (std::list<DeclNode *>::iterator it=myDecls.begin();
+		it != myDecls.end(); ++it){
+		(*it)->minify(out);
+	}
+}
+
+void VarDeclNode::minify(Minifier& out){
+	myType->minify(out);
+	out.word(out.declare(myId->getName()));
+	out.punct(";");
+}
+
+void IdNode::minify(Minifier& out){
+	out.word(out.use(myStrVal));
+}
+
+void IntNode::minify(Minifier& out){
+	out.word("int");
+}
+
+void BoolNode::minify(Minifier& out){
+	out.word("bool");
+}
+
+void VoidNode::minify(Minifier& out){
+	out.word("void");
+}
+
+void StructDeclNode::minify(Minifier& out){
+	out.word("struct");
+	out.word(myId->getName());
+	out.punct("{");
+	out.beginStruct();
+	myDeclList->minify(out);
+	out.endStruct();
+	out.punct("};");
+}
+
+void StructNode::minify(Minifier& out){
+	out.word("struct");
+	out.word(myId->getName());
+}
+
+void FnDeclNode::minify(Minifier& out){
+	myType->minify(out);
+	out.word(myId->getName());
+	out.beginFunction();
+	myFormalsList->minify(out);
+	out.punct("{");
+	myFnBody->minify(out);
+	out.punct("}");
+	out.endFunction();
+}
+
+void FormalDeclNode::minify(Minifier& out){
+	myType->minify(out);
+	out.word(out.declare(myId->getName()));
+}
+
+void FormalsListNode::minify(Minifier& out){
+	out.punct("(");
+	for (std::list<FormalDeclNode *>::iterator it=myFormalDeclList.begin();
+		it != myFormalDeclList.end(); ++it){
+		if (it != myFormalDeclList.begin()){
+			out.punct(",");
+		}
+		(*it)->minify(out);
+	}
+	out.punct(")");
+}
+
+void FnBodyNode::minify(Minifier& out){
+	myDeclList->minify(out);
+	myStmtList->minify(out);
+}
+
+void StmtListNode::minify(Minifier& out){
+	for (std::list<StmtNode *>::iterator it=myStmtList.begin();
+		it != myStmtList.end(); ++it){
+		(*it)->minify(out);
+	}
+}
+
+void ExpListNode::minify(Minifier& out){
+	for (std::list<ExpNode *>::iterator it=myExpList.begin();
+		it != myExpList.end(); ++it){
+		if (it != myExpList.begin()){
+			out.punct(",");
+		}
+		(*it)->minify(out);
+	}
+}
+
+void AssignStmtNode::minify(Minifier& out){
+	myAssignNode->minify(out);
+	out.punct(";");
+}
+
+void PostIncStmtNode::minify(Minifier& out){
+	myExp->minify(out);
+	out.punct("++;");
+}
+
+void PostDecStmtNode::minify(Minifier& out){
+	myExp->minify(out);
+	out.punct("--;");
+}
+
+void ReadStmtNode::minify(Minifier& out){
+	out.word("cin");
+	out.punct(">>");
+	myExp->minify(out);
+	out.punct(";");
+}
+
+void WriteStmtNode::minify(Minifier& out){
+	out.word("cout");
+	out.punct("<<");
+	myExp->minify(out);
+	out.punct(";");
+}
+
+void IfStmtNode::minify(Minifier& out){
+	out.word("if");
+	out.punct("(");
+	myExp->minify(out);
+	out.punct("){");
+	out.beginScope();
+	myDeclList->minify(out);
+	myStmtList->minify(out);
+	out.endScope();
+	out.punct("}");
+}
+
+void IfElseStmtNode::minify(Minifier& out){
+	out.word("if");
+	out.punct("(");
+	myExp->minify(out);
+	out.punct("){");
+	out.beginScope();
+	myDeclList1->minify(out);
+	myStmtList1->minify(out);
+	out.endScope();
+	out.punct("}");
+	out.word("else");
+	out.punct("{");
+	out.beginScope();
+	myDeclList2->minify(out);
+	myStmtList2->minify(out);
+	out.endScope();
+	out.punct("}");
+}
+
+void WhileStmtNode::minify(Minifier& out){
+	out.word("while");
+	out.punct("(");
+	myExp->minify(out);
+	out.punct("){");
+	out.beginScope();
+	myDeclList->minify(out);
+	myStmtList->minify(out);
+	out.endScope();
+	out.punct("}");
+}
+
+void ReturnStmtNode::minify(Minifier& out){
+	out.word("return");
+	if (myExp != nullptr){
+		myExp->minify(out);
+	}
+	out.punct(";");
+}
+
+void CallStmtNode::minify(Minifier& out){
+	myCallExpNode->minify(out);
+	out.punct(";");
+}
+
+void IntLitNode::minify(Minifier& out){
+	out.word(std::to_string(myIntLit->value()));
+}
+
+void StrLitNode::minify(Minifier& out){
+	out.word(myStringLit->value());
+}
+
+void TrueNode::minify(Minifier& out){
+	out.word("true");
+}
+
+void FalseNode::minify(Minifier& out){
+	out.word("false");
+}
+
+void DotAccessNode::minify(Minifier& out){
+	myExp->minify(out);
+	out.punct(".");
+	out.word(myId->getName());
+}
+
+void AssignNode::minify(Minifier& out){
+	out.operand(ASSIGN_NODE, myExpNode1, false);
+	out.punct("=");
+	out.operand(ASSIGN_NODE, myExpNode2, true);
+}
+
+void CallExpNode::minify(Minifier& out){
+	out.word(myId->getName());
+	out.punct("(");
+	myExpList->minify(out);
+	out.punct(")");
+}
+
+void UnaryMinusNode::minify(Minifier& out){
+	out.punct("-");
+	out.operand(UNARY_MINUS_NODE, myExp, true);
+}
+
+void NotNode::minify(Minifier& out){
+	out.punct("!");
+	out.operand(NOT_NODE, myExp, true);
+}
+
+void PlusNode::minify(Minifier& out){
+	out.operand(PLUS_NODE, myExp1, false);
+	out.punct(operatorText(PLUS_NODE));
+	out.operand(PLUS_NODE, myExp2, true);
+}
+
+void MinusNode::minify(Minifier& out){
+	out.operand(MINUS_NODE, myExp1, false);
+	out.punct(operatorText(MINUS_NODE));
+	out.operand(MINUS_NODE, myExp2, true);
+}
+
+void TimesNode::minify(Minifier& out){
+	out.operand(TIMES_NODE, myExp1, false);
+	out.punct(operatorText(TIMES_NODE));
+	out.operand(TIMES_NODE, myExp2, true);
+}
+
+void DivideNode::minify(Minifier& out){
+	out.operand(DIVIDE_NODE, myExp1, false);
+	out.punct(operatorText(DIVIDE_NODE));
+	out.operand(DIVIDE_NODE, myExp2, true);
+}
+
+void AndNode::minify(Minifier& out){
+	out.operand(AND_NODE, myExp1, false);
+	out.punct(operatorText(AND_NODE));
+	out.operand(AND_NODE, myExp2, true);
+}
+
+void OrNode::minify(Minifier& out){
+	out.operand(OR_NODE, myExp1, false);
+	out.punct(operatorText(OR_NODE));
+	out.operand(OR_NODE, myExp2, true);
+}
+
+void EqualsNode::minify(Minifier& out){
+	out.operand(EQUALS_NODE, myExp1, false);
+	out.punct(operatorText(EQUALS_NODE));
+	out.operand(EQUALS_NODE, myExp2, true);
+}
+
+void NotEqualsNode::minify(Minifier& out){
+	out.operand(NOT_EQUALS_NODE, myExp1, false);
+	out.punct(operatorText(NOT_EQUALS_NODE));
+	out.operand(NOT_EQUALS_NODE, myExp2, true);
+}
+
+void LessNode::minify(Minifier& out){
+	out.operand(LESS_NODE, myExp1, false);
+	out.punct(operatorText(LESS_NODE));
+	out.operand(LESS_NODE, myExp2, true);
+}
+
+void GreaterNode::minify(Minifier& out){
+	out.operand(GREATER_NODE, myExp1, false);
+	out.punct(operatorText(GREATER_NODE));
+	out.operand(GREATER_NODE, myExp2, true);
+}
+
+void LessEqNode::minify(Minifier& out){
+	out.operand(LESS_EQ_NODE, myExp1, false);
+	out.punct(operatorText(LESS_EQ_NODE));
+	out.operand(LESS_EQ_NODE, myExp2, true);
+}
+
+void GreaterEqNode::minify(Minifier& out){
+	out.operand(GREATER_EQ_NODE, myExp1, false);
+	out.punct(operatorText(GREATER_EQ_NODE));
+	out.operand(GREATER_EQ_NODE, myExp2, true);
+}
+
+} // End namespace LIL' C
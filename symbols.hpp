@@ -8,10 +8,14 @@ namespace LILC{
 class SynSymbol {
 	public:
 		std::string name;
-		SynSymbol(size_t line, size_t column, int tag){ this->_tag = tag; }
+		SynSymbol(size_t offset, int tag){
+			this->offset = offset;
+			this->_tag = tag;
+		}
+		virtual ~SynSymbol(){ }
 		int tag() { return _tag; }
-		size_t line;
-		size_t column;
+		// Byte offset of the token in the scanned buffer
+		size_t offset;
 
 	protected:
 		int _tag;
@@ -19,14 +23,14 @@ class SynSymbol {
 
 class NullaryToken : public SynSymbol {
 	public:
-		NullaryToken(size_t line, size_t col, int tag) : SynSymbol(line,col,tag) { };
+		NullaryToken(size_t offset, int tag) : SynSymbol(offset,tag) { };
 		int token() { return _tag; } 
 		
 };
 
 class IntLitToken : public SynSymbol {
 	public:
-		IntLitToken(size_t line, size_t col, int value); //Defined in lilc_lexer.l
+		IntLitToken(size_t offset, int value); //Defined in lilc_lexer.l
 		int value() { return _value; }
 	private:
 		int _value;
@@ -34,7 +38,7 @@ class IntLitToken : public SynSymbol {
 
 class IDToken : public SynSymbol {
 	public:
-		IDToken(size_t line, size_t col, std::string id); //Defined in lilc_lexer.l
+		IDToken(size_t offset, std::string id); //Defined in lilc_lexer.l
 		std::string value() { return _value; }
 	private:
 		std::string _value;
@@ -42,7 +46,7 @@ class IDToken : public SynSymbol {
 
 class StringLitToken : public SynSymbol {
 	public:
-		StringLitToken(size_t line, size_t col, std::string value); //Defined in lilc_lexer.l
+		StringLitToken(size_t offset, std::string value); //Defined in lilc_lexer.l
 		std::string value() { return _value; }
 	private:
 		std::string _value;
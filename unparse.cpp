@@ -1,75 +1,139 @@
+#include <type_traits>
+
 #include "ast.hpp"
+#include "lilc_unparse.hpp"
+#include "lilc_selfprofile.hpp"
+#include "lilc_probes.hpp"
 
 namespace LILC{
 
-void ProgramNode::unparse(std::ostream& out, int indent){
-	myDeclList->unparse(out, indent);
+// Operands are parenthesized only where precedence or associativity
+// require it, so the output parses back into the same tree.
+template <typename Sink>
+static void unparseOperand(Sink& out, NodeKind parent, ExpNode * exp,
+	bool rightOperand){
+	bool parens = needsParens(parent, exp->kind(), rightOperand);
+	if (parens) { out << "("; }
+	exp->render(out, 0);
+	if (parens) { out << ")"; }
+}
+
+// The text of node at indent, from cache if it is there; otherwise
+// rendered into it exactly sized, through sinks that do not cache.
+template <typename Sink, typename Node>
+static void renderCached(Sink& out, Node * node, RenderedText& cache,
+	int indent){
+	if (cache.indent != indent){
+		CountingSink counter;
+		node->render(counter, indent);
+		cache.text.assign(counter.count(), '\0');
+		RawSink raw(&cache.text[0]);
+		node->render(raw, indent);
+		cache.indent = indent;
+	}
+	out << cache.text;
+}
+
+void ASTNode::unparse(std::ostream& out, int indent){
+	StreamSink sink(out);
+	render(sink, indent);
+}
+
+template <typename Sink>
+void ProgramNode::render(Sink& out, int indent){
+	myDeclList->render(out, indent);
 }
 
-void DeclListNode::unparse(std::ostream& out, int indent){
+template <typename Sink>
+void DeclListNode::render(Sink& out, int indent){
 	for (std::list<DeclNode *>::iterator it=myDecls.begin();
 		it != myDecls.end(); ++it){
 	    DeclNode * elt = *it;
-	    elt->unparse(out, indent);
+	    SelfProfiler::at(elt->span().offset);
+	    elt->render(out, indent);
 	}
 }
 
-void VarDeclNode::unparse(std::ostream& out, int indent){
+template <typename Sink>
+void VarDeclNode::render(Sink& out, int indent){
 	doIndent(out, indent);
-	myType->unparse(out, 0);
+	myType->render(out, 0);
 	out << " ";
-	myId->unparse(out, 0);
+	myId->render(out, 0);
 	out << ";\n";
 }
 
-void IdNode::unparse(std::ostream& out, int indent){
+template <typename Sink>
+void IdNode::render(Sink& out, int indent){
 	out << myStrVal;
 }
 
-void IntNode::unparse(std::ostream& out, int indent){
+template <typename Sink>
+void IntNode::render(Sink& out, int indent){
 	out << "int";
 }
 
-void BoolNode::unparse(std::ostream& out, int indent) {
+template <typename Sink>
+void BoolNode::render(Sink& out, int indent) {
 	out << "bool";
 }
 
-void VoidNode::unparse(std::ostream& out, int indent) {
+template <typename Sink>
+void VoidNode::render(Sink& out, int indent) {
 	out << "void";
 }
 
-void StructDeclNode::unparse(std::ostream& out, int indent) {
+template <typename Sink>
+void StructDeclNode::render(Sink& out, int indent) {
+	if (out.reuseRendered()){
+		renderCached(out, this, myRendered, indent);
+		return;
+	}
 	doIndent(out, indent);
 	out << "struct ";
-	myId->unparse(out, 0);
+	myId->render(out, 0);
 	out << " {\n";
-	myDeclList->unparse(out, indent + 1);
+	myDeclList->render(out, indent + 1);
 	out << "};\n";
 }
 
-void StructNode::unparse(std::ostream& out, int indent) {
+template <typename Sink>
+void StructNode::render(Sink& out, int indent) {
 	out << "struct ";
-	myId->unparse(out, indent);
+	myId->render(out, indent);
 }
 
-void FnDeclNode::unparse(std::ostream& out, int indent) {
+template <typename Sink>
+void FnDeclNode::render(Sink& out, int indent) {
+	if (out.reuseRendered()){
+		renderCached(out, this, myRendered, indent);
+		return;
+	}
+	LILC_PROBE3(unparse_fn_start, myId->getName().c_str(),
+		(size_t)mySpan.offset,
+		(int)(std::is_same<Sink, CountingSink>::value));
 	doIndent(out, indent);
-	myType->unparse(out, 0);
+	myType->render(out, 0);
 	out << " ";
-	myId->unparse(out, 0);
-	myFormalsList->unparse(out, 0);
+	myId->render(out, 0);
+	myFormalsList->render(out, 0);
 	out << " {\n";
-	myFnBody->unparse(out, 0);
+	myFnBody->render(out, 0);
 	out << "}\n";
+	LILC_PROBE3(unparse_fn_end, myId->getName().c_str(),
+		(size_t)mySpan.offset,
+		(int)(std::is_same<Sink, CountingSink>::value));
 }
 
-void FormalDeclNode::unparse(std::ostream& out, int indent) {
-	myType->unparse(out, 0);
+template <typename Sink>
+void FormalDeclNode::render(Sink& out, int indent) {
+	myType->render(out, 0);
 	out << " ";
-	myId->unparse(out, 0);
+	myId->render(out, 0);
 }
 
-void FormalsListNode::unparse(std::ostream& out, int indent) {
+template <typename Sink>
+void FormalsListNode::render(Sink& out, int indent) {
 	out << "(";
 	for (std::list<FormalDeclNode *>::iterator it=myFormalDeclList.begin();
 		it != myFormalDeclList.end(); ++it){
@@ -77,259 +141,419 @@ void FormalsListNode::unparse(std::ostream& out, int indent) {
 			if (it != myFormalDeclList.begin()) {
 				out << ", ";
 			}
-	    elt->unparse(out, indent);
+	    elt->render(out, indent);
 	}
 	out << ")";
 }
 
-void FnBodyNode::unparse(std::ostream& out, int indent) {
-	myDeclList->unparse(out, indent + 1);
-	myStmtList->unparse(out, indent + 1);
+template <typename Sink>
+void FnBodyNode::render(Sink& out, int indent) {
+	myDeclList->render(out, indent + 1);
+	myStmtList->render(out, indent + 1);
 }
 
-void StmtListNode::unparse(std::ostream& out, int indent) {
+template <typename Sink>
+void StmtListNode::render(Sink& out, int indent) {
 	for (std::list<StmtNode *>::iterator it=myStmtList.begin();
 		it != myStmtList.end(); ++it){
 	    StmtNode * elt = *it;
-	    elt->unparse(out, indent);
+	    SelfProfiler::at(elt->span().offset);
+	    elt->render(out, indent);
 	}
 }
 
-void AssignStmtNode::unparse(std::ostream& out, int indent) {
+template <typename Sink>
+void AssignStmtNode::render(Sink& out, int indent) {
 	doIndent(out, indent);
-	myAssignNode->unparse(out, 0);
+	myAssignNode->render(out, 0);
 	out << ";\n";
 }
 
-void AssignNode::unparse(std::ostream& out, int indent) {
-	myExpNode1->unparse(out, indent);
+template <typename Sink>
+void AssignNode::render(Sink& out, int indent) {
+	myExpNode1->render(out, indent);
 	out << " = ";
-	myExpNode2->unparse(out, indent);
+	myExpNode2->render(out, indent);
 }
 
-void ExpListNode::unparse(std::ostream& out, int indent) {
+template <typename Sink>
+void ExpListNode::render(Sink& out, int indent) {
 	for (std::list<ExpNode *>::iterator it=myExpList.begin();
 		it != myExpList.end(); ++it){
 	    ExpNode * elt = *it;
 			if (it != myExpList.begin()) {
 				out << ", ";
 			}
-	    elt->unparse(out, indent);
+	    elt->render(out, indent);
 	}
 }
 
-void DotAccessNode::unparse(std::ostream& out, int indent) {
-	myExp->unparse(out, indent);
+template <typename Sink>
+void DotAccessNode::render(Sink& out, int indent) {
+	myExp->render(out, indent);
 	out << ".";
-	myId->unparse(out, indent);
+	myId->render(out, indent);
 }
 
-void IntLitNode::unparse(std::ostream& out, int indent) {
+template <typename Sink>
+void IntLitNode::render(Sink& out, int indent) {
 	out << myIntLit->value();
 }
 
-void StrLitNode::unparse(std::ostream& out, int indent) {
+template <typename Sink>
+void StrLitNode::render(Sink& out, int indent) {
 	out << myStringLit->value();
 }
 
-void TrueNode::unparse(std::ostream& out, int indent) {
+template <typename Sink>
+void TrueNode::render(Sink& out, int indent) {
 	out << "true";
 }
 
-void FalseNode::unparse(std::ostream& out, int indent) {
+template <typename Sink>
+void FalseNode::render(Sink& out, int indent) {
 	out << "false";
 }
-void CallExpNode::unparse(std::ostream& out, int indent) {
-	myId->unparse(out,0);
+template <typename Sink>
+void CallExpNode::render(Sink& out, int indent) {
+	myId->render(out,0);
 	out << " (";
-	myExpList->unparse(out,0);
+	myExpList->render(out,0);
 	out << ")";
 }
-void CallStmtNode::unparse(std::ostream& out, int indent) {
+template <typename Sink>
+void CallStmtNode::render(Sink& out, int indent) {
 	doIndent(out, indent);
-	myCallExpNode->unparse(out, 0);
+	myCallExpNode->render(out, 0);
 	out << ";\n";
 }
 
-void PostIncStmtNode::unparse(std::ostream& out, int indent) {
+template <typename Sink>
+void PostIncStmtNode::render(Sink& out, int indent) {
 	doIndent(out, indent);
-	myExp->unparse(out, 0);
+	myExp->render(out, 0);
 	out << "++;\n";
 }
 
-void PostDecStmtNode::unparse(std::ostream& out, int indent) {
+template <typename Sink>
+void PostDecStmtNode::render(Sink& out, int indent) {
 	doIndent(out, indent);
-	myExp->unparse(out, 0);
+	myExp->render(out, 0);
 	out << "--;\n";
 }
 
-void ReadStmtNode::unparse(std::ostream& out, int indent) {
+template <typename Sink>
+void ReadStmtNode::render(Sink& out, int indent) {
 	doIndent(out, indent);
 	out << "cin >> ";
-	myExp->unparse(out, 0);
+	myExp->render(out, 0);
 	out << ";\n";
 }
 
-void WriteStmtNode::unparse(std::ostream& out, int indent) {
+template <typename Sink>
+void WriteStmtNode::render(Sink& out, int indent) {
 	doIndent(out, indent);
 	out << "cout << ";
-	myExp->unparse(out, 0);
+	myExp->render(out, 0);
 	out << ";\n";
 }
 
-void IfStmtNode::unparse(std::ostream& out, int indent) {
+template <typename Sink>
+void IfStmtNode::render(Sink& out, int indent) {
 	doIndent(out, indent);
 	out << "if (";
-	myExp->unparse(out, 0);
+	myExp->render(out, 0);
 	out << ") {\n";
-	myDeclList->unparse(out, indent + 1);
-	myStmtList->unparse(out, indent + 1);
+	myDeclList->render(out, indent + 1);
+	myStmtList->render(out, indent + 1);
 	doIndent(out, indent);
 	out << "}\n";
 }
 
-void IfElseStmtNode::unparse(std::ostream& out, int indent) {
+template <typename Sink>
+void IfElseStmtNode::render(Sink& out, int indent) {
 	doIndent(out, indent);
 	out << "if (";
-	myExp->unparse(out, 0);
+	myExp->render(out, 0);
 	out << ") {\n";
-	myDeclList1->unparse(out, indent + 1);
-	myStmtList1->unparse(out, indent + 1);
+	myDeclList1->render(out, indent + 1);
+	myStmtList1->render(out, indent + 1);
 	doIndent(out, indent);
 	out << "} else {\n";
-	myDeclList2->unparse(out, indent + 1);
-	myStmtList2->unparse(out, indent + 1);
+	myDeclList2->render(out, indent + 1);
+	myStmtList2->render(out, indent + 1);
 	doIndent(out, indent);
 	out << "}\n";
 }
 
-void WhileStmtNode::unparse(std::ostream& out, int indent) {
+template <typename Sink>
+void WhileStmtNode::render(Sink& out, int indent) {
 	doIndent(out, indent);
 	out << "while (";
-	myExp->unparse(out, 0);
+	myExp->render(out, 0);
 	out << ") {\n";
-	myDeclList->unparse(out, indent + 1);
-	myStmtList->unparse(out, indent + 1);
+	myDeclList->render(out, indent + 1);
+	myStmtList->render(out, indent + 1);
 	doIndent(out, indent);
 	out << "}\n";
 }
 
-void ReturnStmtNode::unparse(std::ostream& out, int indent) {
+template <typename Sink>
+void ReturnStmtNode::render(Sink& out, int indent) {
 	doIndent(out, indent);
 	out << "return";
 	if (myExp != nullptr) {
 		out << " ";
-		myExp->unparse(out, 0);
+		myExp->render(out, 0);
 	}
 	out << ";\n";
 }
 
-void PlusNode::unparse(std::ostream& out, int indent) {
-	out << "(";
-	myExp1->unparse(out, 0);
+template <typename Sink>
+void PlusNode::render(Sink& out, int indent) {
+	unparseOperand(out, PLUS_NODE, myExp1, false);
 	out << " + ";
-	myExp2->unparse(out, 0);
-	out << ")";
+	unparseOperand(out, PLUS_NODE, myExp2, true);
 }
 
-void MinusNode::unparse(std::ostream& out, int indent) {
-	out << "(";
-	myExp1->unparse(out, 0);
+template <typename Sink>
+void MinusNode::render(Sink& out, int indent) {
+	unparseOperand(out, MINUS_NODE, myExp1, false);
 	out << " - ";
-	myExp2->unparse(out, 0);
-	out << ")";
+	unparseOperand(out, MINUS_NODE, myExp2, true);
 }
 
-void TimesNode::unparse(std::ostream& out, int indent) {
-	out << "(";
-	myExp1->unparse(out, 0);
+template <typename Sink>
+void TimesNode::render(Sink& out, int indent) {
+	unparseOperand(out, TIMES_NODE, myExp1, false);
 	out << " * ";
-	myExp2->unparse(out, 0);
-	out << ")";
+	unparseOperand(out, TIMES_NODE, myExp2, true);
 }
 
-void DivideNode::unparse(std::ostream& out, int indent) {
-	out << "(";
-	myExp1->unparse(out, 0);
+template <typename Sink>
+void DivideNode::render(Sink& out, int indent) {
+	unparseOperand(out, DIVIDE_NODE, myExp1, false);
 	out << " / ";
-	myExp2->unparse(out, 0);
-	out << ")";
+	unparseOperand(out, DIVIDE_NODE, myExp2, true);
 }
 
-void AndNode::unparse(std::ostream& out, int indent) {
-	out << "(";
-	myExp1->unparse(out, 0);
+template <typename Sink>
+void AndNode::render(Sink& out, int indent) {
+	unparseOperand(out, AND_NODE, myExp1, false);
 	out << " && ";
-	myExp2->unparse(out, 0);
-	out << ")";
+	unparseOperand(out, AND_NODE, myExp2, true);
 }
 
-void OrNode::unparse(std::ostream& out, int indent) {
-	out << "(";
-	myExp1->unparse(out, 0);
+template <typename Sink>
+void OrNode::render(Sink& out, int indent) {
+	unparseOperand(out, OR_NODE, myExp1, false);
 	out << " || ";
-	myExp2->unparse(out, 0);
-	out << ")";
+	unparseOperand(out, OR_NODE, myExp2, true);
 }
 
-void EqualsNode::unparse(std::ostream& out, int indent) {
-	out << "(";
-	myExp1->unparse(out, 0);
+template <typename Sink>
+void EqualsNode::render(Sink& out, int indent) {
+	unparseOperand(out, EQUALS_NODE, myExp1, false);
 	out << " == ";
-	myExp2->unparse(out, 0);
-	out << ")";
+	unparseOperand(out, EQUALS_NODE, myExp2, true);
 }
 
-void NotEqualsNode::unparse(std::ostream& out, int indent) {
-	out << "(";
-	myExp1->unparse(out, 0);
+template <typename Sink>
+void NotEqualsNode::render(Sink& out, int indent) {
+	unparseOperand(out, NOT_EQUALS_NODE, myExp1, false);
 	out << " != ";
-	myExp2->unparse(out, 0);
-	out << ")";
+	unparseOperand(out, NOT_EQUALS_NODE, myExp2, true);
 }
 
-void LessNode::unparse(std::ostream& out, int indent) {
-	out << "(";
-	myExp1->unparse(out, 0);
+template <typename Sink>
+void LessNode::render(Sink& out, int indent) {
+	unparseOperand(out, LESS_NODE, myExp1, false);
 	out << " < ";
-	myExp2->unparse(out, 0);
-	out << ")";
+	unparseOperand(out, LESS_NODE, myExp2, true);
 }
 
-void GreaterNode::unparse(std::ostream& out, int indent) {
-	out << "(";
-	myExp1->unparse(out, 0);
+template <typename Sink>
+void GreaterNode::render(Sink& out, int indent) {
+	unparseOperand(out, GREATER_NODE, myExp1, false);
 	out << " > ";
-	myExp2->unparse(out, 0);
-	out << ")";
+	unparseOperand(out, GREATER_NODE, myExp2, true);
 }
 
-void LessEqNode::unparse(std::ostream& out, int indent) {
-	out << "(";
-	myExp1->unparse(out, 0);
+template <typename Sink>
+void LessEqNode::render(Sink& out, int indent) {
+	unparseOperand(out, LESS_EQ_NODE, myExp1, false);
 	out << " <= ";
-	myExp2->unparse(out, 0);
-	out << ")";
+	unparseOperand(out, LESS_EQ_NODE, myExp2, true);
 }
 
-void GreaterEqNode::unparse(std::ostream& out, int indent) {
-	out << "(";
-	myExp1->unparse(out, 0);
+template <typename Sink>
+void GreaterEqNode::render(Sink& out, int indent) {
+	unparseOperand(out, GREATER_EQ_NODE, myExp1, false);
 	out << " >= ";
-	myExp2->unparse(out, 0);
-	out << ")";
-}
-
-void NotNode::unparse(std::ostream& out, int indent) {
-	out << "(!";
-	myExp->unparse(out, 0);
-	out << ")";
+	unparseOperand(out, GREATER_EQ_NODE, myExp2, true);
+}
+
+template <typename Sink>
+void NotNode::render(Sink& out, int indent) {
+	out << "!";
+	unparseOperand(out, NOT_NODE, myExp, true);
+}
+
+template <typename Sink>
+void UnaryMinusNode::render(Sink& out, int indent) {
+	out << "-";
+	unparseOperand(out, UNARY_MINUS_NODE, myExp, true);
+}
+
+// Children are held through their abstract bases, which have no render
+// of their own, so a call on one lands here and is sent on to the
+// concrete class.
+template <typename Sink>
+void ASTNode::render(Sink& out, int indent){
+	switch (kind()){
+		case PROGRAM_NODE:
+			static_cast<ProgramNode *>(this)->render(out, indent);
+			break;
+		case DECL_LIST_NODE:
+			static_cast<DeclListNode *>(this)->render(out, indent);
+			break;
+		case EXP_LIST_NODE:
+			static_cast<ExpListNode *>(this)->render(out, indent);
+			break;
+		case FORMALS_LIST_NODE:
+			static_cast<FormalsListNode *>(this)->render(out, indent);
+			break;
+		case STMT_LIST_NODE:
+			static_cast<StmtListNode *>(this)->render(out, indent);
+			break;
+		case FN_BODY_NODE:
+			static_cast<FnBodyNode *>(this)->render(out, indent);
+			break;
+		case VAR_DECL_NODE:
+			static_cast<VarDeclNode *>(this)->render(out, indent);
+			break;
+		case FN_DECL_NODE:
+			static_cast<FnDeclNode *>(this)->render(out, indent);
+			break;
+		case FORMAL_DECL_NODE:
+			static_cast<FormalDeclNode *>(this)->render(out, indent);
+			break;
+		case STRUCT_DECL_NODE:
+			static_cast<StructDeclNode *>(this)->render(out, indent);
+			break;
+		case INT_NODE:
+			static_cast<IntNode *>(this)->render(out, indent);
+			break;
+		case BOOL_NODE:
+			static_cast<BoolNode *>(this)->render(out, indent);
+			break;
+		case VOID_NODE:
+			static_cast<VoidNode *>(this)->render(out, indent);
+			break;
+		case STRUCT_NODE:
+			static_cast<StructNode *>(this)->render(out, indent);
+			break;
+		case ASSIGN_STMT_NODE:
+			static_cast<AssignStmtNode *>(this)->render(out, indent);
+			break;
+		case POST_INC_STMT_NODE:
+			static_cast<PostIncStmtNode *>(this)->render(out, indent);
+			break;
+		case POST_DEC_STMT_NODE:
+			static_cast<PostDecStmtNode *>(this)->render(out, indent);
+			break;
+		case READ_STMT_NODE:
+			static_cast<ReadStmtNode *>(this)->render(out, indent);
+			break;
+		case WRITE_STMT_NODE:
+			static_cast<WriteStmtNode *>(this)->render(out, indent);
+			break;
+		case IF_STMT_NODE:
+			static_cast<IfStmtNode *>(this)->render(out, indent);
+			break;
+		case IF_ELSE_STMT_NODE:
+			static_cast<IfElseStmtNode *>(this)->render(out, indent);
+			break;
+		case WHILE_STMT_NODE:
+			static_cast<WhileStmtNode *>(this)->render(out, indent);
+			break;
+		case CALL_STMT_NODE:
+			static_cast<CallStmtNode *>(this)->render(out, indent);
+			break;
+		case RETURN_STMT_NODE:
+			static_cast<ReturnStmtNode *>(this)->render(out, indent);
+			break;
+		case INT_LIT_NODE:
+			static_cast<IntLitNode *>(this)->render(out, indent);
+			break;
+		case STR_LIT_NODE:
+			static_cast<StrLitNode *>(this)->render(out, indent);
+			break;
+		case TRUE_NODE:
+			static_cast<TrueNode *>(this)->render(out, indent);
+			break;
+		case FALSE_NODE:
+			static_cast<FalseNode *>(this)->render(out, indent);
+			break;
+		case ID_NODE:
+			static_cast<IdNode *>(this)->render(out, indent);
+			break;
+		case DOT_ACCESS_NODE:
+			static_cast<DotAccessNode *>(this)->render(out, indent);
+			break;
+		case ASSIGN_NODE:
+			static_cast<AssignNode *>(this)->render(out, indent);
+			break;
+		case CALL_EXP_NODE:
+			static_cast<CallExpNode *>(this)->render(out, indent);
+			break;
+		case UNARY_MINUS_NODE:
+			static_cast<UnaryMinusNode *>(this)->render(out, indent);
+			break;
+		case NOT_NODE:
+			static_cast<NotNode *>(this)->render(out, indent);
+			break;
+		case PLUS_NODE:
+			static_cast<PlusNode *>(this)->render(out, indent);
+			break;
+		case MINUS_NODE:
+			static_cast<MinusNode *>(this)->render(out, indent);
+			break;
+		case TIMES_NODE:
+			static_cast<TimesNode *>(this)->render(out, indent);
+			break;
+		case DIVIDE_NODE:
+			static_cast<DivideNode *>(this)->render(out, indent);
+			break;
+		case AND_NODE:
+			static_cast<AndNode *>(this)->render(out, indent);
+			break;
+		case OR_NODE:
+			static_cast<OrNode *>(this)->render(out, indent);
+			break;
+		case EQUALS_NODE:
+			static_cast<EqualsNode *>(this)->render(out, indent);
+			break;
+		case NOT_EQUALS_NODE:
+			static_cast<NotEqualsNode *>(this)->render(out, indent);
+			break;
+		case LESS_NODE:
+			static_cast<LessNode *>(this)->render(out, indent);
+			break;
+		case GREATER_NODE:
+			static_cast<GreaterNode *>(this)->render(out, indent);
+			break;
+		case LESS_EQ_NODE:
+			static_cast<LessEqNode *>(this)->render(out, indent);
+			break;
+		case GREATER_EQ_NODE:
+			static_cast<GreaterEqNode *>(this)->render(out, indent);
+			break;
+	}
 }
 
-void UnaryMinusNode::unparse(std::ostream& out, int indent) {
-	out << "(-";
-	myExp->unparse(out, 0);
-	out << ")";
-}
+template void ASTNode::render(StreamSink& out, int indent);
+template void ASTNode::render(CountingSink& out, int indent);
+template void ASTNode::render(RawSink& out, int indent);
 
 } // End namespace LIL' C